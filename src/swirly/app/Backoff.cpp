@@ -16,6 +16,8 @@
  */
 #include "Backoff.hpp"
 
+#include <swirly/app/EventCount.hpp>
+
 #include <chrono>
 #include <thread>
 
@@ -43,5 +45,32 @@ void YieldBackoff::idle() noexcept
     sched_yield();
 }
 
+void ParkBackoff::idle() noexcept
+{
+    using namespace std::literals::chrono_literals;
+    if (i_ < 1000) {
+        cpu_relax();
+        ++i_;
+    } else if (!armed_) {
+        // The agent checks for work once more before the next call.
+        key_ = event_->prepare_wait();
+        armed_ = true;
+    } else {
+        // The timeout bounds the delay in observing a stop request.
+        event_->wait(key_, 250ms);
+        armed_ = false;
+        i_ = 0;
+    }
+}
+
+void ParkBackoff::reset() noexcept
+{
+    if (armed_) {
+        event_->cancel_wait();
+        armed_ = false;
+    }
+    i_ = 0;
+}
+
 } // namespace app
 } // namespace swirly
@@ -19,8 +19,11 @@
 
 #include <swirly/Config.h>
 
+#include <cstdint>
+
 namespace swirly {
 inline namespace app {
+class EventCount;
 
 struct NoBackoff {
     void idle() noexcept {}
@@ -41,6 +44,26 @@ struct SWIRLY_API YieldBackoff {
     void reset() noexcept {}
 };
 
+/**
+ * Spin for a short budget and then park on an event count until a producer notifies it. The agent
+ * re-checks for work between preparing to wait and waiting, so a notification is never missed.
+ */
+class SWIRLY_API ParkBackoff {
+  public:
+    explicit ParkBackoff(EventCount& event) noexcept
+    : event_{&event}
+    {
+    }
+    void idle() noexcept;
+    void reset() noexcept;
+
+  private:
+    EventCount* event_;
+    int i_{0};
+    bool armed_{false};
+    std::uint32_t key_{0};
+};
+
 inline void cpu_relax() noexcept
 {
 #if defined(__x86_64__) || defined(__i386__)
@@ -0,0 +1,45 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "EventCount.hpp"
+
+#include <climits>
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace swirly {
+inline namespace app {
+using namespace std;
+
+void EventCount::wait(uint32_t key, Duration timeout) noexcept
+{
+    const auto ns = chrono::duration_cast<chrono::nanoseconds>(timeout).count();
+    const timespec ts{ns / 1'000'000'000, ns % 1'000'000'000};
+    // Returns immediately if the key has changed since prepare_wait().
+    syscall(SYS_futex, &key_, FUTEX_WAIT_PRIVATE, key, &ts, nullptr, 0);
+    cancel_wait();
+}
+
+void EventCount::wake() noexcept
+{
+    __atomic_add_fetch(&key_, 1, __ATOMIC_SEQ_CST);
+    syscall(SYS_futex, &key_, FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+}
+
+} // namespace app
+} // namespace swirly
@@ -0,0 +1,80 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_APP_EVENTCOUNT_HPP
+#define SWIRLY_APP_EVENTCOUNT_HPP
+
+#include <swirly/sys/Memory.hpp>
+
+#include <swirly/util/Time.hpp>
+
+#include <cstdint>
+
+namespace swirly {
+inline namespace app {
+
+/**
+ * Event count that allows a consumer to park on a futex until a producer publishes work. Producers
+ * call notify() after publishing, which only makes a system call if a consumer is waiting.
+ *
+ * A consumer calls prepare_wait(), re-checks its condition, and then either calls cancel_wait() if
+ * work has arrived, or wait() with the key returned by prepare_wait(). A notification that arrives
+ * between the two calls is not lost, because wait() returns immediately if the key has changed.
+ */
+class SWIRLY_API EventCount {
+  public:
+    EventCount() noexcept = default;
+    ~EventCount() = default;
+
+    // Copy.
+    EventCount(const EventCount&) = delete;
+    EventCount& operator=(const EventCount&) = delete;
+
+    // Move.
+    EventCount(EventCount&&) = delete;
+    EventCount& operator=(EventCount&&) = delete;
+
+    std::uint32_t prepare_wait() noexcept
+    {
+        __atomic_add_fetch(&waiters_, 1, __ATOMIC_SEQ_CST);
+        return __atomic_load_n(&key_, __ATOMIC_SEQ_CST);
+    }
+    void cancel_wait() noexcept { __atomic_sub_fetch(&waiters_, 1, __ATOMIC_SEQ_CST); }
+    /**
+     * Wait until notified or until the timeout expires.
+     */
+    void wait(std::uint32_t key, Duration timeout) noexcept;
+
+    void notify() noexcept
+    {
+        // Order the caller's publication before the load of the waiter count.
+        __atomic_thread_fence(__ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&waiters_, __ATOMIC_RELAXED) > 0) {
+            wake();
+        }
+    }
+
+  private:
+    void wake() noexcept;
+
+    alignas(CacheLineSize) std::uint32_t key_{0};
+    std::uint32_t waiters_{0};
+};
+
+} // namespace app
+} // namespace swirly
+
+#endif // SWIRLY_APP_EVENTCOUNT_HPP
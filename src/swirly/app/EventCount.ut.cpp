@@ -0,0 +1,47 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "EventCount.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <chrono>
+
+using namespace std;
+using namespace swirly;
+
+BOOST_AUTO_TEST_SUITE(EventCountSuite)
+
+BOOST_AUTO_TEST_CASE(EventCountCase)
+{
+    using namespace std::literals::chrono_literals;
+    EventCount event;
+
+    // A notification between prepare and wait is not lost.
+    auto key = event.prepare_wait();
+    event.notify();
+    auto start = chrono::steady_clock::now();
+    event.wait(key, 10s);
+    BOOST_TEST((chrono::steady_clock::now() - start < 5s));
+
+    // Otherwise the wait times out.
+    key = event.prepare_wait();
+    start = chrono::steady_clock::now();
+    event.wait(key, 10ms);
+    BOOST_TEST((chrono::steady_clock::now() - start >= 10ms));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
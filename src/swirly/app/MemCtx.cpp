@@ -21,6 +21,9 @@
 #include <swirly/sys/File.hpp>
 #include <swirly/sys/MMap.hpp>
 
+#include <atomic>
+#include <mutex>
+
 #include <fcntl.h>
 
 namespace swirly {
@@ -28,6 +31,9 @@ inline namespace app {
 using namespace std;
 namespace {
 
+// True while the calling thread holds a HeapScope.
+thread_local bool use_heap_{false};
+
 FileHandle reserve_file(const char* path, size_t size)
 {
     FileHandle fh{os::open(path, O_RDWR | O_CREAT, 0644)};
@@ -88,6 +94,12 @@ struct MemCtx::Impl {
         }
         return addr;
     }
+    bool owns(const void* addr) const noexcept
+    {
+        const auto* const begin = static_cast<const char*>(mem_map.get().data());
+        const auto* const ptr = static_cast<const char*>(addr);
+        return ptr >= begin && ptr < begin + mem_map.get().size();
+    }
     void dealloc(void* addr, size_t size) noexcept
     {
         const auto cache_lines = size >> CacheLineBits;
@@ -124,6 +136,8 @@ struct MemCtx::Impl {
     FileHandle fh;
     MMap mem_map;
     MemPool& pool;
+    atomic<bool> concurrent{false};
+    mutex mtx;
 };
 
 MemCtx::MemCtx(size_t max_size)
@@ -150,24 +164,57 @@ size_t MemCtx::max_size() noexcept
     return impl_->max_size;
 }
 
+void MemCtx::set_concurrent(bool concurrent) noexcept
+{
+    assert(impl_);
+    impl_->concurrent.store(concurrent, memory_order_release);
+}
+
 void* MemCtx::alloc(size_t size)
 {
     assert(impl_);
+    if (use_heap_) {
+        return ::operator new(size, align_val_t{CacheLineSize});
+    }
+    if (impl_->concurrent.load(memory_order_acquire)) {
+        lock_guard<mutex> lock{impl_->mtx};
+        return impl_->alloc(size);
+    }
     return impl_->alloc(size);
 }
 
 void* MemCtx::alloc(std::size_t size, align_val_t al)
 {
-    assert(impl_);
     assert(static_cast<size_t>(al) <= CacheLineSize);
-    return impl_->alloc(size);
+    return alloc(size);
 }
 
 void MemCtx::dealloc(void* addr, size_t size) noexcept
 {
     assert(impl_);
+    if (!impl_->owns(addr)) {
+        // Allocated from the heap under a HeapScope.
+        ::operator delete(addr, align_val_t{CacheLineSize});
+        return;
+    }
+    if (impl_->concurrent.load(memory_order_acquire)) {
+        lock_guard<mutex> lock{impl_->mtx};
+        impl_->dealloc(addr, size);
+        return;
+    }
     impl_->dealloc(addr, size);
 }
 
+MemCtx::HeapScope::HeapScope() noexcept
+: prev_{use_heap_}
+{
+    use_heap_ = true;
+}
+
+MemCtx::HeapScope::~HeapScope()
+{
+    use_heap_ = prev_;
+}
+
 } // namespace app
 } // namespace swirly
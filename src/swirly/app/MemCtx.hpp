@@ -49,6 +49,35 @@ class SWIRLY_API MemCtx {
 
     std::size_t max_size() noexcept;
 
+    /**
+     * Allocations are serialised while concurrent is set, so that objects may be allocated from
+     * several threads, for example while the model is read in parallel. This method must not be
+     * called while other threads are allocating.
+     */
+    void set_concurrent(bool concurrent) noexcept;
+
+    /**
+     * Allocations made by the calling thread are served from the heap while a HeapScope is held,
+     * so that a background thread never takes blocks from the pool, which is owned by the matching
+     * thread. Heap blocks may be deallocated by any thread.
+     */
+    class SWIRLY_API HeapScope {
+      public:
+        HeapScope() noexcept;
+        ~HeapScope();
+
+        // Copy.
+        HeapScope(const HeapScope&) = delete;
+        HeapScope& operator=(const HeapScope&) = delete;
+
+        // Move.
+        HeapScope(HeapScope&&) = delete;
+        HeapScope& operator=(HeapScope&&) = delete;
+
+      private:
+        bool prev_;
+    };
+
     void* alloc(std::size_t size);
 
     // Requested alignment must not be greater than the size of a cache-line.
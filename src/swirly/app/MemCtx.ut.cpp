@@ -64,4 +64,27 @@ BOOST_AUTO_TEST_CASE(MemCtxCase)
     mem_ctx.dealloc(p2, sizeof(Foo));
 }
 
+BOOST_AUTO_TEST_CASE(MemCtxHeapScopeCase)
+{
+    MemCtx mem_ctx{4096};
+
+    char* p1{static_cast<char*>(mem_ctx.alloc(sizeof(Foo)))};
+    mem_ctx.dealloc(p1, sizeof(Foo));
+
+    char* p2;
+    {
+        MemCtx::HeapScope scope;
+        // Served from the heap, so the pool's free block is not taken.
+        p2 = static_cast<char*>(mem_ctx.alloc(sizeof(Foo)));
+        BOOST_TEST(p1 != p2);
+        strcpy(p2, "test");
+    }
+    // Returned to the heap, rather than to the pool.
+    mem_ctx.dealloc(p2, sizeof(Foo));
+
+    char* p3{static_cast<char*>(mem_ctx.alloc(sizeof(Foo)))};
+    BOOST_TEST(p1 == p3);
+    mem_ctx.dealloc(p3, sizeof(Foo));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -36,8 +36,25 @@ inline std::size_t file_size(int fd)
 }
 } // namespace detail
 
+/**
+ * Multiple producers and multiple consumers.
+ */
+struct MpmcPolicy {
+    static constexpr bool Spsc{false};
+};
+
+/**
+ * Single producer and single consumer. Neither side requires a compare-and-swap, and each side
+ * caches the opposite position, so that the shared position is only read when the queue appears to
+ * be full or empty. The element sequence numbers are not used, so a file-backed queue must always
+ * be opened with the same policy.
+ */
+struct SpscPolicy {
+    static constexpr bool Spsc{true};
+};
+
 // Thanks to Dmitry Vyukov for this algorithm.
-template <typename ValueT>
+template <typename ValueT, typename PolicyT = MpmcPolicy>
 class MemQueue {
     static_assert(std::is_trivially_copyable_v<ValueT>);
 
@@ -94,15 +111,19 @@ class MemQueue {
 
     // Move.
     MemQueue(MemQueue&& rhs) noexcept
-    : fh_{rhs.fh}
+    : fh_{std::move(rhs.fh_)}
     , capacity_{rhs.capacity_}
     , mask_{rhs.mask_}
     , mem_map_{std::move(rhs.mem_map_)}
     , impl_{rhs.impl_}
+    , rpos_cache_{rhs.rpos_cache_}
+    , wpos_cache_{rhs.wpos_cache_}
     {
         rhs.capacity_ = 0;
         rhs.mask_ = 0;
         rhs.impl_ = nullptr;
+        rhs.rpos_cache_ = 0;
+        rhs.wpos_cache_ = 0;
     }
     MemQueue& operator=(MemQueue&& rhs) noexcept
     {
@@ -138,6 +159,8 @@ class MemQueue {
     void reset(std::nullptr_t = nullptr) noexcept
     {
         // Reverse order.
+        wpos_cache_ = 0;
+        rpos_cache_ = 0;
         impl_ = nullptr;
         mem_map_.reset(nullptr);
         mask_ = 0;
@@ -151,6 +174,8 @@ class MemQueue {
         std::swap(mask_, rhs.mask_);
         mem_map_.swap(rhs.mem_map_);
         std::swap(impl_, rhs.impl_);
+        std::swap(rpos_cache_, rhs.rpos_cache_);
+        std::swap(wpos_cache_, rhs.wpos_cache_);
     }
     /**
      * Returns false if queue is empty.
@@ -159,6 +184,12 @@ class MemQueue {
     bool fetch(FnT fn) noexcept
     {
         static_assert(std::is_nothrow_invocable_v<FnT, ValueT&&>);
+        if constexpr (PolicyT::Spsc) {
+            return spsc_fetch_n([](const ValueT&) noexcept -> std::size_t { return 1; },
+                                [&fn](std::size_t, ValueT && val) noexcept {
+                                    fn(std::move(val));
+                                });
+        }
         auto rpos = __atomic_load_n(&impl_->rpos, __ATOMIC_RELAXED);
         for (;;) {
             auto& elem = impl_->elems[rpos & mask_];
@@ -188,6 +219,9 @@ class MemQueue {
     bool post(FnT fn) noexcept
     {
         static_assert(std::is_nothrow_invocable_v<FnT, ValueT&>);
+        if constexpr (PolicyT::Spsc) {
+            return spsc_post_n(1, [&fn](std::size_t, ValueT & val) noexcept { fn(val); });
+        }
         auto wpos = __atomic_load_n(&impl_->wpos, __ATOMIC_RELAXED);
         for (;;) {
             auto& elem = impl_->elems[wpos & mask_];
@@ -210,6 +244,104 @@ class MemQueue {
         }
         return true;
     }
+    /**
+     * Fetch a value that spans one or more consecutive elements. The size function is called with
+     * the first element, and returns the number of elements that make up the value. The function is
+     * then called for each of those elements in turn, along with its index.
+     *
+     * Returns false if queue is empty.
+     */
+    template <typename SizeFnT, typename FnT>
+    bool fetch_n(SizeFnT size_fn, FnT fn) noexcept
+    {
+        static_assert(std::is_nothrow_invocable_r_v<std::size_t, SizeFnT, const ValueT&>);
+        static_assert(std::is_nothrow_invocable_v<FnT, std::size_t, ValueT&&>);
+        if constexpr (PolicyT::Spsc) {
+            return spsc_fetch_n(size_fn, fn);
+        }
+        auto rpos = __atomic_load_n(&impl_->rpos, __ATOMIC_RELAXED);
+        for (;;) {
+            auto& elem = impl_->elems[rpos & mask_];
+            const auto seq = __atomic_load_n(&elem.seq, __ATOMIC_ACQUIRE);
+            const auto diff = seq - (rpos + 1);
+            if (diff == 0) {
+                // The size is only used if the claim succeeds, in which case the element cannot
+                // have been reused in the meantime. The remaining elements were committed before
+                // the first.
+                const auto n = static_cast<std::int64_t>(size_fn(elem.val));
+                assert(n > 0 && n <= static_cast<std::int64_t>(capacity_));
+                if (__atomic_compare_exchange_n(&impl_->rpos, &rpos, rpos + n, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    for (std::int64_t i{0}; i < n; ++i) {
+                        fn(i, std::move(impl_->elems[(rpos + i) & mask_].val));
+                    }
+                    // Commit.
+                    for (std::int64_t i{0}; i < n; ++i) {
+                        __atomic_store_n(&impl_->elems[(rpos + i) & mask_].seq,
+                                         rpos + i + capacity_, __ATOMIC_RELEASE);
+                    }
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                rpos = __atomic_load_n(&impl_->rpos, __ATOMIC_RELAXED);
+            }
+        }
+        return true;
+    }
+    /**
+     * Post n consecutive elements, which are claimed with a single compare-and-swap. The function
+     * is called for each of those elements in turn, along with its index. The first element is
+     * committed last, so that readers observe the elements as a whole, and the elements are never
+     * interleaved with those of other producers.
+     *
+     * Returns false if capacity is exceeded, in which case no elements are posted.
+     */
+    template <typename FnT>
+    bool post_n(std::size_t n, FnT fn) noexcept
+    {
+        static_assert(std::is_nothrow_invocable_v<FnT, std::size_t, ValueT&>);
+        assert(n > 0);
+        if (n > capacity_) {
+            return false;
+        }
+        if constexpr (PolicyT::Spsc) {
+            return spsc_post_n(n, fn);
+        }
+        const auto m = static_cast<std::int64_t>(n);
+        auto wpos = __atomic_load_n(&impl_->wpos, __ATOMIC_RELAXED);
+        for (;;) {
+            // Elements may be released out of order when there are multiple readers, so each
+            // element must be checked.
+            std::int64_t diff{0};
+            for (std::int64_t i{0}; i < m && diff == 0; ++i) {
+                const auto seq
+                    = __atomic_load_n(&impl_->elems[(wpos + i) & mask_].seq, __ATOMIC_ACQUIRE);
+                diff = seq - (wpos + i);
+            }
+            if (diff == 0) {
+                // The compare_exchange_weak function re-reads wpos on failure.
+                if (__atomic_compare_exchange_n(&impl_->wpos, &wpos, wpos + m, true,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                    for (std::int64_t i{0}; i < m; ++i) {
+                        fn(i, impl_->elems[(wpos + i) & mask_].val);
+                    }
+                    // Commit.
+                    for (auto i = m - 1; i >= 0; --i) {
+                        __atomic_store_n(&impl_->elems[(wpos + i) & mask_].seq, wpos + i + 1,
+                                         __ATOMIC_RELEASE);
+                    }
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                wpos = __atomic_load_n(&impl_->wpos, __ATOMIC_RELAXED);
+            }
+        }
+        return true;
+    }
     /**
      * Returns false if queue is empty.
      */
@@ -236,6 +368,46 @@ class MemQueue {
     }
 
   private:
+    template <typename SizeFnT, typename FnT>
+    bool spsc_fetch_n(SizeFnT size_fn, FnT fn) noexcept
+    {
+        // Only the consumer writes the read position.
+        const auto rpos = __atomic_load_n(&impl_->rpos, __ATOMIC_RELAXED);
+        if (wpos_cache_ <= rpos) {
+            wpos_cache_ = __atomic_load_n(&impl_->wpos, __ATOMIC_ACQUIRE);
+            if (wpos_cache_ <= rpos) {
+                return false;
+            }
+        }
+        const auto n = static_cast<std::int64_t>(size_fn(impl_->elems[rpos & mask_].val));
+        assert(n > 0 && rpos + n <= wpos_cache_);
+        for (std::int64_t i{0}; i < n; ++i) {
+            fn(i, std::move(impl_->elems[(rpos + i) & mask_].val));
+        }
+        // Commit.
+        __atomic_store_n(&impl_->rpos, rpos + n, __ATOMIC_RELEASE);
+        return true;
+    }
+    template <typename FnT>
+    bool spsc_post_n(std::size_t n, FnT fn) noexcept
+    {
+        const auto m = static_cast<std::int64_t>(n);
+        const auto cap = static_cast<std::int64_t>(capacity_);
+        // Only the producer writes the write position.
+        const auto wpos = __atomic_load_n(&impl_->wpos, __ATOMIC_RELAXED);
+        if (wpos + m - rpos_cache_ > cap) {
+            rpos_cache_ = __atomic_load_n(&impl_->rpos, __ATOMIC_ACQUIRE);
+            if (wpos + m - rpos_cache_ > cap) {
+                return false;
+            }
+        }
+        for (std::int64_t i{0}; i < m; ++i) {
+            fn(i, impl_->elems[(wpos + i) & mask_].val);
+        }
+        // Commit.
+        __atomic_store_n(&impl_->wpos, wpos + m, __ATOMIC_RELEASE);
+        return true;
+    }
     static constexpr std::size_t capacity(std::size_t size) noexcept
     {
         return (size - sizeof(Impl)) / sizeof(Elem);
@@ -249,6 +421,10 @@ class MemQueue {
     std::uint64_t capacity_{}, mask_{};
     MMap mem_map_{nullptr};
     Impl* impl_{nullptr};
+    // Cached positions for the single-producer and single-consumer policy. The producer caches the
+    // read position and the consumer caches the write position.
+    alignas(CacheLineSize) std::int64_t rpos_cache_{0};
+    alignas(CacheLineSize) std::int64_t wpos_cache_{0};
 };
 
 /**
@@ -273,7 +449,7 @@ void create_mem_queue(const char* path, std::size_t capacity, mode_t mode)
     memset(impl, 0, size);
     // Initialise sequence numbers.
     for (std::int64_t i{0}; i < static_cast<std::int64_t>(capacity); ++i) {
-        __atomic_store_n(impl->elems[i].seq, i, __ATOMIC_RELAXED);
+        __atomic_store_n(&impl->elems[i].seq, i, __ATOMIC_RELAXED);
     }
 }
 
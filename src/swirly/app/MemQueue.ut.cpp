@@ -0,0 +1,253 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "MemQueue.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+using namespace std;
+using namespace swirly;
+
+namespace {
+
+struct Part {
+    int producer;
+    int seq;
+    int n;
+    int i;
+};
+
+template <typename PolicyT>
+void post_parts(MemQueue<Part, PolicyT>& q, int producer, int seq, int n)
+{
+    while (!q.post_n(n, [&](size_t i, Part& part) noexcept {
+        part = {producer, seq, n, static_cast<int>(i)};
+    })) {
+        this_thread::yield();
+    }
+}
+
+/**
+ * Returns the number of elements fetched, or zero if the queue was empty. Each value must be
+ * fetched whole and in order.
+ */
+template <typename PolicyT>
+int fetch_parts(MemQueue<Part, PolicyT>& q, vector<int>& seqs)
+{
+    int n{0};
+    bool ok{true};
+    const auto size_fn = [](const Part& part) noexcept -> size_t { return part.n; };
+    q.fetch_n(size_fn, [&](size_t i, Part&& part) noexcept {
+        if (i == 0) {
+            ok = part.seq == seqs[part.producer]++;
+        }
+        ok = ok && part.i == static_cast<int>(i);
+        ++n;
+    });
+    BOOST_TEST(ok);
+    return n;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(MemQueueSuite)
+
+BOOST_AUTO_TEST_CASE(MemQueueMpmcCase)
+{
+    MemQueue<int> q{4};
+    BOOST_TEST(q.empty());
+    BOOST_TEST(q.reserve() == 4U);
+
+    for (int i{0}; i < 4; ++i) {
+        BOOST_TEST(q.push(i));
+    }
+    BOOST_TEST(!q.push(4));
+    BOOST_TEST(q.size() == 4U);
+
+    int val;
+    for (int i{0}; i < 4; ++i) {
+        BOOST_TEST(q.pop(val));
+        BOOST_TEST(val == i);
+    }
+    BOOST_TEST(!q.pop(val));
+    BOOST_TEST(q.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MemQueueSpscCase)
+{
+    MemQueue<int, SpscPolicy> q{4};
+    BOOST_TEST(q.empty());
+    BOOST_TEST(q.reserve() == 4U);
+
+    int val;
+    BOOST_TEST(!q.pop(val));
+
+    for (int i{0}; i < 4; ++i) {
+        BOOST_TEST(q.push(i));
+    }
+    // Full.
+    BOOST_TEST(!q.push(4));
+    BOOST_TEST(q.reserve() == 0U);
+
+    BOOST_TEST(q.pop(val));
+    BOOST_TEST(val == 0);
+    BOOST_TEST(q.pop(val));
+    BOOST_TEST(val == 1);
+    BOOST_TEST(q.reserve() == 2U);
+
+    // Wrap around the end of the buffer several times.
+    int next{4}, expect{2};
+    for (int j{0}; j < 10; ++j) {
+        BOOST_TEST(q.push(next++));
+        BOOST_TEST(q.push(next++));
+        BOOST_TEST(!q.push(next));
+        BOOST_TEST(q.pop(val));
+        BOOST_TEST(val == expect++);
+        BOOST_TEST(q.pop(val));
+        BOOST_TEST(val == expect++);
+    }
+    while (q.pop(val)) {
+        BOOST_TEST(val == expect++);
+    }
+    BOOST_TEST(expect == next);
+    // Empty.
+    BOOST_TEST(q.empty());
+    BOOST_TEST(q.reserve() == 4U);
+}
+
+BOOST_AUTO_TEST_CASE(MemQueueFileCase)
+{
+    char path[] = "/tmp/swirly-memq.XXXXXX";
+    const auto fd = mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    close(fd);
+    unlink(path);
+
+    create_mem_queue<int>(path, 4, 0600);
+    {
+        MemQueue<int, SpscPolicy> q{path};
+        BOOST_TEST(q.reserve() == 4U);
+        BOOST_TEST(q.push(1));
+        BOOST_TEST(q.push(2));
+        BOOST_TEST(q.push(3));
+    }
+    int val;
+    {
+        // Positions are kept in the file, and the cached positions are reloaded on reopen.
+        MemQueue<int, SpscPolicy> q{path};
+        BOOST_TEST(q.size() == 3U);
+        BOOST_TEST(q.pop(val));
+        BOOST_TEST(val == 1);
+        BOOST_TEST(q.push(4));
+        BOOST_TEST(q.push(5));
+        BOOST_TEST(!q.push(6));
+    }
+    {
+        MemQueue<int, SpscPolicy> q{path};
+        for (int i{2}; i <= 5; ++i) {
+            BOOST_TEST(q.pop(val));
+            BOOST_TEST(val == i);
+        }
+        BOOST_TEST(!q.pop(val));
+        BOOST_TEST(q.empty());
+    }
+    unlink(path);
+}
+
+BOOST_AUTO_TEST_CASE(MemQueuePostNCase)
+{
+    MemQueue<Part> q{8};
+    vector<int> seqs(1);
+
+    post_parts(q, 0, 0, 3);
+    post_parts(q, 0, 1, 4);
+    // A batch that does not fit posts nothing.
+    BOOST_TEST(!q.post_n(2, [](size_t i, Part& part) noexcept {}));
+    BOOST_TEST(q.size() == 7U);
+
+    BOOST_TEST(fetch_parts(q, seqs) == 3);
+    // Wrap around the end of the buffer.
+    post_parts(q, 0, 2, 4);
+    BOOST_TEST(fetch_parts(q, seqs) == 4);
+    BOOST_TEST(fetch_parts(q, seqs) == 4);
+    BOOST_TEST(fetch_parts(q, seqs) == 0);
+    BOOST_TEST(q.empty());
+    BOOST_TEST(seqs[0] == 3);
+    // A batch larger than the queue is rejected.
+    BOOST_TEST(!q.post_n(9, [](size_t i, Part& part) noexcept {}));
+    BOOST_TEST(q.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MemQueueSpscPostNCase)
+{
+    MemQueue<Part, SpscPolicy> q{8};
+    vector<int> seqs(1);
+
+    post_parts(q, 0, 0, 5);
+    BOOST_TEST(!q.post_n(4, [](size_t i, Part& part) noexcept {}));
+    post_parts(q, 0, 1, 3);
+    BOOST_TEST(q.reserve() == 0U);
+
+    BOOST_TEST(fetch_parts(q, seqs) == 5);
+    post_parts(q, 0, 2, 5);
+    BOOST_TEST(fetch_parts(q, seqs) == 3);
+    BOOST_TEST(fetch_parts(q, seqs) == 5);
+    BOOST_TEST(fetch_parts(q, seqs) == 0);
+    BOOST_TEST(q.empty());
+    BOOST_TEST(!q.post_n(9, [](size_t i, Part& part) noexcept {}));
+    BOOST_TEST(q.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MemQueueProducersCase)
+{
+    constexpr int Producers{4}, Batches{2000};
+    MemQueue<Part> q{64};
+
+    // Batches of one to four elements must never be interleaved with those of other producers.
+    vector<thread> threads;
+    int total{0};
+    for (int p{0}; p < Producers; ++p) {
+        for (int seq{0}; seq < Batches; ++seq) {
+            total += seq % 4 + 1;
+        }
+        threads.emplace_back([&q, p]() {
+            for (int seq{0}; seq < Batches; ++seq) {
+                post_parts(q, p, seq, seq % 4 + 1);
+            }
+        });
+    }
+    vector<int> seqs(Producers);
+    for (int n{0}; n < total;) {
+        const auto m = fetch_parts(q, seqs);
+        if (m == 0) {
+            this_thread::yield();
+        }
+        n += m;
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    BOOST_TEST(q.empty());
+    for (int p{0}; p < Producers; ++p) {
+        BOOST_TEST(seqs[p] == Batches);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
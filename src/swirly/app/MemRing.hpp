@@ -0,0 +1,375 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_APP_MEMRING_HPP
+#define SWIRLY_APP_MEMRING_HPP
+
+#include <swirly/app/MemQueue.hpp>
+
+#include <algorithm>
+
+namespace swirly {
+inline namespace app {
+
+/**
+ * Broadcast ring with a single writer and a fixed number of readers, each of which sees every
+ * element. Each reader tracks its own cursor, and the writer is gated by the slowest reader, so a
+ * reader that falls behind applies backpressure to the writer rather than losing elements. The
+ * ring may be backed by a shared file, so that readers can run in separate processes.
+ */
+template <typename ValueT>
+class MemRing {
+    static_assert(std::is_trivially_copyable_v<ValueT>);
+
+  public:
+    static constexpr std::size_t MaxReaders{8};
+
+    struct alignas(CacheLineSize) Cursor {
+        std::int64_t pos;
+    };
+    struct alignas(CacheLineSize) Impl {
+        std::int64_t wpos;
+        std::int64_t readers;
+        // Ensure that each reader's cursor is in a different cache-line.
+        Cursor cursors[MaxReaders];
+        alignas(CacheLineSize) ValueT elems[];
+    };
+    static_assert(std::is_trivially_copyable_v<Impl>);
+    static_assert(sizeof(Impl) == (1 + MaxReaders) * CacheLineSize);
+    static_assert(offsetof(Impl, cursors) == 1 * CacheLineSize);
+    static_assert(offsetof(Impl, elems) == (1 + MaxReaders) * CacheLineSize);
+
+    constexpr MemRing(std::nullptr_t = nullptr) noexcept {}
+    MemRing(std::size_t capacity, std::size_t readers)
+    : capacity_{next_pow2(capacity)}
+    , mask_{capacity_ - 1}
+    , mem_map_{os::mmap(nullptr, size(capacity_), PROT_READ | PROT_WRITE, MAP_ANON | MAP_PRIVATE,
+                        -1, 0)}
+    , impl_{static_cast<Impl*>(mem_map_.get().data())}
+    {
+        assert(capacity >= 2);
+        assert(readers > 0 && readers <= MaxReaders);
+
+        memset(impl_, 0, size(capacity_));
+        impl_->readers = readers;
+    }
+    explicit MemRing(const char* path)
+    : fh_{os::open(path, O_RDWR)}
+    , capacity_{capacity(detail::file_size(fh_.get()))}
+    , mask_{capacity_ - 1}
+    , mem_map_{os::mmap(nullptr, size(capacity_), PROT_READ | PROT_WRITE, MAP_SHARED, fh_.get(), 0)}
+    , impl_{static_cast<Impl*>(mem_map_.get().data())}
+    {
+        if (!is_pow2(capacity_)) {
+            throw std::runtime_error{"capacity not a power of two"};
+        }
+        if (impl_->readers <= 0 || impl_->readers > static_cast<std::int64_t>(MaxReaders)) {
+            throw std::runtime_error{"invalid number of readers"};
+        }
+        // The file may have been left behind by a process that crashed, so reject cursors that
+        // could not have been produced by a well-behaved reader.
+        const auto wpos = impl_->wpos;
+        const auto cap = static_cast<std::int64_t>(capacity_);
+        for (std::int64_t i{0}; i < impl_->readers; ++i) {
+            const auto rpos = impl_->cursors[i].pos;
+            if (rpos < 0 || rpos > wpos || wpos - rpos > cap) {
+                throw std::runtime_error{"invalid reader position"};
+            }
+        }
+    }
+    ~MemRing() = default;
+
+    // Copy.
+    MemRing(const MemRing& rhs) = delete;
+    MemRing& operator=(const MemRing& rhs) = delete;
+
+    // Move.
+    MemRing(MemRing&& rhs) noexcept
+    : fh_{std::move(rhs.fh_)}
+    , capacity_{rhs.capacity_}
+    , mask_{rhs.mask_}
+    , mem_map_{std::move(rhs.mem_map_)}
+    , impl_{rhs.impl_}
+    , min_cache_{rhs.min_cache_}
+    {
+        rhs.capacity_ = 0;
+        rhs.mask_ = 0;
+        rhs.impl_ = nullptr;
+        rhs.min_cache_ = 0;
+    }
+    MemRing& operator=(MemRing&& rhs) noexcept
+    {
+        reset();
+        swap(rhs);
+        return *this;
+    }
+
+    /**
+     * Returns the number of readers.
+     */
+    std::size_t readers() const noexcept { return impl_->readers; }
+    /**
+     * Returns the position following the last element that was published.
+     */
+    std::int64_t wpos() const noexcept { return __atomic_load_n(&impl_->wpos, __ATOMIC_ACQUIRE); }
+    /**
+     * Returns the position following the last element that was consumed by the reader.
+     */
+    std::int64_t rpos(std::size_t reader) const noexcept
+    {
+        assert(reader < readers());
+        return __atomic_load_n(&impl_->cursors[reader].pos, __ATOMIC_ACQUIRE);
+    }
+    /**
+     * Returns true if the reader has consumed all elements.
+     */
+    bool empty(std::size_t reader) const noexcept
+    {
+        assert(reader < readers());
+        const auto rpos = __atomic_load_n(&impl_->cursors[reader].pos, __ATOMIC_ACQUIRE);
+        const auto wpos = __atomic_load_n(&impl_->wpos, __ATOMIC_ACQUIRE);
+        return rpos == wpos;
+    }
+    /**
+     * Returns the number of unused elements.
+     */
+    std::size_t reserve() const noexcept { return capacity_ - size(); }
+    /**
+     * Returns the number of elements that have yet to be consumed by the slowest reader.
+     */
+    std::size_t size() const noexcept
+    {
+        const auto wpos = __atomic_load_n(&impl_->wpos, __ATOMIC_ACQUIRE);
+        return wpos - min_pos(wpos);
+    }
+    void reset(std::nullptr_t = nullptr) noexcept
+    {
+        // Reverse order.
+        min_cache_ = 0;
+        impl_ = nullptr;
+        mem_map_.reset(nullptr);
+        mask_ = 0;
+        capacity_ = 0;
+        fh_.reset(nullptr);
+    }
+    void swap(MemRing& rhs) noexcept
+    {
+        fh_.swap(rhs.fh_);
+        std::swap(capacity_, rhs.capacity_);
+        std::swap(mask_, rhs.mask_);
+        mem_map_.swap(rhs.mem_map_);
+        std::swap(impl_, rhs.impl_);
+        std::swap(min_cache_, rhs.min_cache_);
+    }
+    /**
+     * Fetch a value that spans one or more consecutive elements on behalf of the reader. The size
+     * function is called with the first element, and returns the number of elements that make up
+     * the value. The function is then called for each of those elements in turn, along with its
+     * index. Each reader must be used by a single thread.
+     *
+     * Returns false if the reader has consumed all elements.
+     */
+    template <typename SizeFnT, typename FnT>
+    bool fetch_n(std::size_t reader, SizeFnT size_fn, FnT fn) noexcept
+    {
+        assert(reader < readers());
+        // Only the reader writes its own cursor.
+        auto pos = __atomic_load_n(&impl_->cursors[reader].pos, __ATOMIC_RELAXED);
+        if (!read_n(pos, size_fn, fn)) {
+            return false;
+        }
+        release(reader, pos);
+        return true;
+    }
+    /**
+     * Read a value that spans one or more consecutive elements at the specified position, and
+     * advance the position past the value. Unlike fetch_n(), the elements are not released to the
+     * writer, so a reader can hold on to elements until it has finished with them, and then
+     * release them all at once. The position must lie between the reader's cursor and the write
+     * position.
+     *
+     * Returns false if the position has reached the write position.
+     */
+    template <typename SizeFnT, typename FnT>
+    bool read_n(std::int64_t& pos, SizeFnT size_fn, FnT fn) const noexcept
+    {
+        static_assert(std::is_nothrow_invocable_r_v<std::size_t, SizeFnT, const ValueT&>);
+        static_assert(std::is_nothrow_invocable_v<FnT, std::size_t, ValueT&&>);
+        const auto wpos = __atomic_load_n(&impl_->wpos, __ATOMIC_ACQUIRE);
+        assert(pos <= wpos);
+        if (pos == wpos) {
+            return false;
+        }
+        const auto n = static_cast<std::int64_t>(size_fn(impl_->elems[pos & mask_]));
+        assert(n > 0 && pos + n <= wpos);
+        for (std::int64_t i{0}; i < n; ++i) {
+            // Copy so that other readers see the original value.
+            ValueT val{impl_->elems[(pos + i) & mask_]};
+            fn(i, std::move(val));
+        }
+        pos += n;
+        return true;
+    }
+    /**
+     * Release the elements before the specified position on behalf of the reader, so that the
+     * writer may reuse them. Each reader must be used by a single thread.
+     */
+    void release(std::size_t reader, std::int64_t pos) noexcept
+    {
+        assert(reader < readers());
+        auto& cursor = impl_->cursors[reader];
+        assert(pos >= cursor.pos && pos <= wpos());
+        __atomic_store_n(&cursor.pos, pos, __ATOMIC_RELEASE);
+    }
+    /**
+     * Discard published elements from the specified position onwards. Readers that have already
+     * moved past the position are moved back to it. This function is intended for recovery of a
+     * file-based ring before the writer or any of the readers are started.
+     */
+    void truncate(std::int64_t pos) noexcept
+    {
+        assert(pos >= 0 && pos <= wpos());
+        for (std::int64_t i{0}; i < impl_->readers; ++i) {
+            auto& cursor = impl_->cursors[i];
+            cursor.pos = std::min(cursor.pos, pos);
+        }
+        __atomic_store_n(&impl_->wpos, pos, __ATOMIC_RELEASE);
+        min_cache_ = std::min(min_cache_, pos);
+    }
+    /**
+     * Post n consecutive elements. The function is called for each of those elements in turn,
+     * along with its index. The elements are published to all readers together. There must be a
+     * single writer.
+     *
+     * Returns false if capacity is exceeded, in which case no elements are posted.
+     */
+    template <typename FnT>
+    bool post_n(std::size_t n, FnT fn) noexcept
+    {
+        static_assert(std::is_nothrow_invocable_v<FnT, std::size_t, ValueT&>);
+        assert(n > 0);
+        if (n > capacity_) {
+            return false;
+        }
+        const auto m = static_cast<std::int64_t>(n);
+        const auto cap = static_cast<std::int64_t>(capacity_);
+        // Only the writer writes the write position.
+        const auto wpos = __atomic_load_n(&impl_->wpos, __ATOMIC_RELAXED);
+        if (wpos + m - min_cache_ > cap) {
+            min_cache_ = min_pos(wpos);
+            if (wpos + m - min_cache_ > cap) {
+                return false;
+            }
+        }
+        for (std::int64_t i{0}; i < m; ++i) {
+            fn(i, impl_->elems[(wpos + i) & mask_]);
+        }
+        // Commit.
+        __atomic_store_n(&impl_->wpos, wpos + m, __ATOMIC_RELEASE);
+        return true;
+    }
+    /**
+     * Returns false if the reader has consumed all elements.
+     */
+    bool pop(std::size_t reader, ValueT& val) noexcept
+    {
+        return fetch_n(reader, [](const ValueT&) noexcept -> std::size_t { return 1; },
+                       [&val](std::size_t, ValueT && ref) noexcept { val = std::move(ref); });
+    }
+    /**
+     * Returns false if capacity is exceeded.
+     */
+    bool push(const ValueT& val) noexcept
+    {
+        return post_n(1, [&val](std::size_t, ValueT & ref) noexcept { ref = val; });
+    }
+
+  private:
+    /**
+     * Returns the position of the slowest reader.
+     */
+    std::int64_t min_pos(std::int64_t wpos) const noexcept
+    {
+        // Acquire ensures that readers have finished with the elements before they are reused.
+        auto pos = wpos;
+        for (std::int64_t i{0}; i < impl_->readers; ++i) {
+            pos = std::min(pos, __atomic_load_n(&impl_->cursors[i].pos, __ATOMIC_ACQUIRE));
+        }
+        return pos;
+    }
+    static constexpr std::size_t capacity(std::size_t size) noexcept
+    {
+        return (size - sizeof(Impl)) / sizeof(ValueT);
+    }
+    static constexpr std::size_t size(std::size_t capacity) noexcept
+    {
+        return sizeof(Impl) + capacity * sizeof(ValueT);
+    }
+
+    FileHandle fh_{nullptr};
+    std::uint64_t capacity_{}, mask_{};
+    MMap mem_map_{nullptr};
+    Impl* impl_{nullptr};
+    // Position of the slowest reader, as last seen by the writer.
+    std::int64_t min_cache_{0};
+};
+
+/**
+ * Initialise file-based MemRing.
+ */
+template <typename ValueT>
+void create_mem_ring(const char* path, std::size_t capacity, std::size_t readers, mode_t mode)
+{
+    using Impl = typename MemRing<ValueT>::Impl;
+
+    assert(capacity >= 2);
+    assert(readers > 0 && readers <= MemRing<ValueT>::MaxReaders);
+
+    capacity = next_pow2(capacity);
+    const auto size = sizeof(Impl) + capacity * sizeof(ValueT);
+
+    FileHandle fh{os::open(path, O_RDWR | O_CREAT | O_EXCL, mode)};
+    os::ftruncate(fh.get(), size);
+    MMap mem_map{os::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fh.get(), 0)};
+    auto* const impl = static_cast<Impl*>(mem_map.get().data());
+
+    memset(impl, 0, size);
+    impl->readers = readers;
+}
+
+/**
+ * Initialise file-based MemRing if the file does not already exist. An existing file is left as it
+ * is, so that elements that were published but not consumed before a restart can be recovered.
+ *
+ * Returns true if the file was created.
+ */
+template <typename ValueT>
+bool open_mem_ring(const char* path, std::size_t capacity, std::size_t readers, mode_t mode)
+{
+    try {
+        create_mem_ring<ValueT>(path, capacity, readers, mode);
+    } catch (const std::system_error& e) {
+        if (e.code() != std::errc::file_exists) {
+            throw;
+        }
+        return false;
+    }
+    return true;
+}
+} // namespace app
+} // namespace swirly
+
+#endif // SWIRLY_APP_MEMRING_HPP
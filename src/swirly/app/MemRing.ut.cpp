@@ -0,0 +1,87 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "MemRing.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace swirly;
+
+BOOST_AUTO_TEST_SUITE(MemRingSuite)
+
+BOOST_AUTO_TEST_CASE(MemRingBroadcastCase)
+{
+    MemRing<int> r{4, 2};
+    BOOST_TEST(r.readers() == 2U);
+    BOOST_TEST(r.reserve() == 4U);
+
+    for (int i{0}; i < 4; ++i) {
+        BOOST_TEST(r.push(i));
+    }
+    BOOST_TEST(!r.push(4));
+
+    // Each reader sees every element.
+    int val;
+    for (int i{0}; i < 4; ++i) {
+        BOOST_TEST(r.pop(0, val));
+        BOOST_TEST(val == i);
+    }
+    BOOST_TEST(!r.pop(0, val));
+    BOOST_TEST(r.empty(0));
+
+    // The slowest reader gates the writer.
+    BOOST_TEST(r.reserve() == 0U);
+    BOOST_TEST(!r.push(4));
+
+    BOOST_TEST(r.pop(1, val));
+    BOOST_TEST(val == 0);
+    BOOST_TEST(r.reserve() == 1U);
+    BOOST_TEST(r.push(4));
+    BOOST_TEST(!r.push(5));
+
+    BOOST_TEST(r.pop(0, val));
+    BOOST_TEST(val == 4);
+    for (int i{1}; i < 5; ++i) {
+        BOOST_TEST(r.pop(1, val));
+        BOOST_TEST(val == i);
+    }
+    BOOST_TEST(r.empty(1));
+    BOOST_TEST(r.reserve() == 4U);
+}
+
+BOOST_AUTO_TEST_CASE(MemRingWrapCase)
+{
+    MemRing<int> r{4, 1};
+    const auto size_fn = [](const int& val) noexcept -> size_t { return val; };
+
+    // Values spanning several elements wrap around the end of the ring.
+    for (int i{0}; i < 5; ++i) {
+        BOOST_TEST(r.post_n(3, [](size_t j, int& val) noexcept { val = 3 + j; }));
+        BOOST_TEST(!r.post_n(2, [](size_t j, int& val) noexcept { val = 0; }));
+
+        int sum{0};
+        BOOST_TEST(r.fetch_n(0, size_fn, [&sum](size_t j, int&& val) noexcept { sum += val; }));
+        BOOST_TEST(sum == 3 + 4 + 5);
+        BOOST_TEST(r.empty(0));
+    }
+    // Values larger than the ring are rejected rather than posted.
+    BOOST_TEST(!r.post_n(5, [](size_t j, int& val) noexcept { val = 0; }));
+    BOOST_TEST(r.empty(0));
+    BOOST_TEST(r.reserve() == 4U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
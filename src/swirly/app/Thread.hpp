@@ -18,12 +18,14 @@
 #define SWIRLY_APP_THREAD_HPP
 
 #include <swirly/app/Backoff.hpp>
+#include <swirly/app/EventCount.hpp>
 
 #include <swirly/sys/Signal.hpp>
 
 #include <swirly/util/Log.hpp>
 
 #include <atomic>
+#include <cassert>
 #include <thread>
 
 #include <unistd.h>
@@ -34,15 +36,39 @@ class Reactor;
 } // namespace sys
 inline namespace app {
 
+/**
+ * Strategy used by an agent thread when it is idle.
+ */
+enum class WaitStrategy {
+    /**
+     * Busy-spin, for the lowest latency at the cost of a dedicated core.
+     */
+    Spin,
+    /**
+     * Spin, then yield, then sleep for progressively longer periods.
+     */
+    Phased,
+    /**
+     * Spin for a short budget, then park until the event is notified by a producer.
+     */
+    Park
+};
+
 struct ThreadConfig {
     std::string name;
+    WaitStrategy wait{WaitStrategy::Spin};
+    /**
+     * Event notified by producers, which is required by the Park strategy.
+     */
+    EventCount* event{nullptr};
 };
 
 class AgentThread {
   public:
     template <typename AgentT>
     AgentThread(AgentT& agent, ThreadConfig config)
-    : thread_{run<AgentT, NoBackoff>, std::ref(agent), NoBackoff{}, config, std::cref(stop_)}
+    : event_{config.event}
+    , thread_{start(agent, config)}
     {
     }
     template <typename AgentT, typename BackoffT>
@@ -53,6 +79,9 @@ class AgentThread {
     ~AgentThread()
     {
         stop_.store(true, std::memory_order_relaxed);
+        if (event_) {
+            event_->notify();
+        }
         thread_.join();
     }
 
@@ -65,6 +94,23 @@ class AgentThread {
     AgentThread& operator=(AgentThread&&) noexcept = delete;
 
   private:
+    template <typename AgentT>
+    std::thread start(AgentT& agent, const ThreadConfig& config)
+    {
+        switch (config.wait) {
+        case WaitStrategy::Spin:
+            break;
+        case WaitStrategy::Phased:
+            return std::thread{run<AgentT, PhasedBackoff>, std::ref(agent), PhasedBackoff{}, config,
+                               std::cref(stop_)};
+        case WaitStrategy::Park:
+            assert(config.event);
+            return std::thread{run<AgentT, ParkBackoff>, std::ref(agent),
+                               ParkBackoff{*config.event}, config, std::cref(stop_)};
+        }
+        return std::thread{run<AgentT, NoBackoff>, std::ref(agent), NoBackoff{}, config,
+                           std::cref(stop_)};
+    }
     template <typename AgentT, typename BackoffT>
     static void run(AgentT& agent, BackoffT backoff, ThreadConfig config,
                     const std::atomic<bool>& stop)
@@ -77,13 +123,15 @@ class AgentThread {
         try {
             while (!stop.load(std::memory_order_relaxed)) {
                 if (agent() == 0) {
-                    backoff.reset();
                     do {
                         backoff.idle();
                         if (stop.load(std::memory_order_relaxed)) {
                             break;
                         }
                     } while (agent() == 0);
+                    // Reset once work arrives, so that a parked agent withdraws its interest in
+                    // notifications while it is busy.
+                    backoff.reset();
                 }
             }
         } catch (const std::exception& e) {
@@ -93,6 +141,7 @@ class AgentThread {
         SWIRLY_NOTICE << "stopping " << config.name << " thread";
     }
     std::atomic<bool> stop_{false};
+    EventCount* const event_{nullptr};
     std::thread thread_;
 };
 
@@ -0,0 +1,146 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "Bin.hxx"
+
+#include <swirly/fin/Exception.hpp>
+#include <swirly/fin/Msg.hpp>
+
+#include <swirly/sys/File.hpp>
+#include <swirly/sys/MMap.hpp>
+
+#include <swirly/util/Crc.hpp>
+
+#include <algorithm>
+#include <cstring>
+
+#include <dirent.h>
+
+namespace swirly {
+inline namespace db {
+namespace bin {
+using namespace std;
+namespace {
+
+constexpr char SegSuffix[] = ".seg";
+constexpr size_t SeqDigits{16};
+
+uint32_t get_uint32(const char* buf) noexcept
+{
+    uint32_t val;
+    memcpy(&val, buf, sizeof(val));
+    return val;
+}
+
+void put_uint32(char* buf, uint32_t val) noexcept
+{
+    memcpy(buf, &val, sizeof(val));
+}
+
+} // namespace
+
+string seg_path(const string& dir, uint64_t seq)
+{
+    char name[SeqDigits + sizeof(SegSuffix)];
+    snprintf(name, sizeof(name), "%016llx%s", static_cast<unsigned long long>(seq), SegSuffix);
+    return dir + '/' + name;
+}
+
+vector<uint64_t> seg_list(const string& dir)
+{
+    unique_ptr<DIR, int (*)(DIR*)> dp{opendir(dir.c_str()), closedir};
+    if (!dp) {
+        throw system_error{os::make_error(errno), "opendir"};
+    }
+    vector<uint64_t> seqs;
+    while (const auto* const ent = readdir(dp.get())) {
+        const string_view name{ent->d_name};
+        if (name.size() != SeqDigits + sizeof(SegSuffix) - 1
+            || name.substr(SeqDigits) != SegSuffix) {
+            continue;
+        }
+        char* end;
+        const auto seq = strtoull(name.data(), &end, 16);
+        if (end == name.data() + SeqDigits) {
+            seqs.push_back(seq);
+        }
+    }
+    sort(seqs.begin(), seqs.end());
+    return seqs;
+}
+
+size_t put_record(char* buf, const char* msg, size_t size, bool end) noexcept
+{
+    memcpy(buf + RecordHeaderSize, msg, size);
+    put_uint32(buf + sizeof(uint32_t), crc32c(msg, size));
+    // The size is written last, because a non-zero size is what makes the record visible.
+    put_uint32(buf, size | (end ? EndTrans : 0));
+    return RecordHeaderSize + size;
+}
+
+void set_end_trans(char* buf) noexcept
+{
+    put_uint32(buf, get_uint32(buf) | EndTrans);
+}
+
+Position scan(const string& dir, const vector<uint64_t>& seqs, const ScanCallback& cb)
+{
+    Position pos;
+    // Messages of the current transaction, which are only delivered once it is complete.
+    vector<char> pending;
+    for (const auto seq : seqs) {
+        FileHandle fh{os::open(seg_path(dir, seq).c_str(), O_RDONLY)};
+        const auto size = file_size(fh.get());
+        if (size == 0) {
+            continue;
+        }
+        const MMap mem_map{os::mmap(nullptr, size, PROT_READ, MAP_SHARED, fh.get(), 0)};
+        const auto* const base = static_cast<const char*>(mem_map.get().data());
+
+        size_t offset{0};
+        while (offset + RecordHeaderSize <= size) {
+            const auto* const rec = base + offset;
+            const auto hdr = get_uint32(rec);
+            if (hdr == 0) {
+                // End of segment.
+                break;
+            }
+            const size_t len{hdr & ~EndTrans};
+            const auto* const msg = rec + RecordHeaderSize;
+            if (len < 3 || len > MaxMsgSize || offset + RecordHeaderSize + len > size
+                || msg_size(msg) != len || crc32c(msg, len) != get_uint32(rec + sizeof(uint32_t))) {
+                // Torn or corrupt record: nothing that follows can be trusted.
+                return pos;
+            }
+            pending.insert(pending.end(), msg, msg + len);
+            offset += RecordHeaderSize + len;
+            if (hdr & EndTrans) {
+                if (cb) {
+                    for (size_t i{0}; i < pending.size(); i += msg_size(&pending[i])) {
+                        cb(&pending[i]);
+                    }
+                }
+                pending.clear();
+                pos = {seq, offset};
+            }
+        }
+    }
+    return pos;
+}
+
+} // namespace bin
+} // namespace db
+} // namespace swirly
@@ -0,0 +1,86 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_DB_BIN_HXX
+#define SWIRLY_DB_BIN_HXX
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace swirly {
+inline namespace db {
+namespace bin {
+
+/**
+ * A binary journal is a directory of segment files, each of which holds a sequence of records.
+ * Every record starts with a header holding the size of the encoded message that follows it and a
+ * CRC-32C of that message. The top bit of the size marks the last record of a transaction.
+ * Segments are preallocated and zero-filled, so a zero size marks the end of the records in a
+ * segment.
+ */
+constexpr std::size_t RecordHeaderSize{2 * sizeof(std::uint32_t)};
+constexpr std::uint32_t EndTrans{1U << 31};
+
+/**
+ * Position within a binary journal.
+ */
+struct Position {
+    std::uint64_t seq{0};
+    std::size_t offset{0};
+};
+
+using ScanCallback = std::function<void(const char*)>;
+
+/**
+ * Segment files are named after their sequence number, so that they sort in write order.
+ */
+std::string seg_path(const std::string& dir, std::uint64_t seq);
+
+/**
+ * Returns the sequence numbers of the segments in a directory, in ascending order.
+ */
+std::vector<std::uint64_t> seg_list(const std::string& dir);
+
+/**
+ * Write a record at the specified address.
+ *
+ * @return the size of the record.
+ */
+std::size_t put_record(char* buf, const char* msg, std::size_t size, bool end) noexcept;
+
+/**
+ * Mark the record at the specified address as the last record of a transaction.
+ */
+void set_end_trans(char* buf) noexcept;
+
+/**
+ * Scan segments in order, and invoke the callback with each encoded message of each complete
+ * transaction. Records that follow the last complete transaction, or a record that is torn or
+ * corrupt, are ignored.
+ *
+ * @return the position following the last complete transaction, or a zero sequence number if there
+ * is none.
+ */
+Position scan(const std::string& dir, const std::vector<std::uint64_t>& seqs,
+              const ScanCallback& cb);
+
+} // namespace bin
+} // namespace db
+} // namespace swirly
+
+#endif // SWIRLY_DB_BIN_HXX
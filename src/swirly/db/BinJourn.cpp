@@ -0,0 +1,211 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "BinJourn.hpp"
+
+#include "Bin.hxx"
+
+#include <swirly/fin/Msg.hpp>
+
+#include <swirly/util/Config.hpp>
+#include <swirly/util/Log.hpp>
+
+#include <algorithm>
+#include <map>
+
+namespace swirly {
+inline namespace db {
+using namespace bin;
+using namespace std;
+namespace {
+
+constexpr size_t MinSegSize{RecordHeaderSize + MaxMsgSize};
+constexpr mode_t SegMode{S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH};
+
+void make_dir(const string& dir)
+{
+    if (mkdir(dir.c_str(), 0777) < 0 && errno != EEXIST) {
+        throw system_error{os::make_error(errno), "mkdir"};
+    }
+}
+
+void unlink_seg(const string& dir, uint64_t seq)
+{
+    if (unlink(seg_path(dir, seq).c_str()) < 0 && errno != ENOENT) {
+        throw system_error{os::make_error(errno), "unlink"};
+    }
+}
+
+} // namespace
+
+BinJourn::BinJourn(const char* dir, size_t seg_size)
+: dir_{dir}
+, seg_size_{max(seg_size, MinSegSize)}
+{
+    make_dir(dir_);
+    const auto seqs = seg_list(dir_);
+    uint64_t next{1};
+    if (!seqs.empty()) {
+        // Discard everything that follows the last complete transaction, so that a transaction left
+        // incomplete by a crash cannot be completed by the records of a later one.
+        const auto pos = scan(dir_, seqs, nullptr);
+        for (auto it = seqs.rbegin(); it != seqs.rend() && *it > pos.seq; ++it) {
+            SWIRLY_WARNING << "discarding incomplete segment " << *it;
+            unlink_seg(dir_, *it);
+        }
+        if (pos.seq != 0) {
+            truncate_seg(pos.seq, pos.offset);
+        }
+        sync_dir();
+        next = seqs.back() + 1;
+    }
+    open_seg(next);
+}
+
+BinJourn::BinJourn(const Config& config)
+: BinJourn{config.get("journ_dir", "journ"), config.get<size_t>("journ_seg_size", 64 << 20)}
+{
+}
+
+BinJourn::~BinJourn() = default;
+
+BinJourn::BinJourn(BinJourn&&) = default;
+
+BinJourn& BinJourn::operator=(BinJourn&&) = default;
+
+void BinJourn::do_begin()
+{
+    trans_ = true;
+    begin_seq_ = seq_;
+    begin_offset_ = offset_;
+}
+
+void BinJourn::do_commit()
+{
+    trans_ = false;
+    if (dirty_) {
+        set_end_trans(base_ + last_);
+        // Writes to a shared mapping are written back by fdatasync, just like writes to the file.
+        os::fdatasync(fh_.get());
+        dirty_ = false;
+    }
+}
+
+void BinJourn::do_rollback() noexcept
+{
+    trans_ = false;
+    try {
+        if (seq_ == begin_seq_) {
+            memset(base_ + begin_offset_, 0, offset_ - begin_offset_);
+            offset_ = begin_offset_;
+        } else {
+            // The transaction spans segments, so cut the first back and discard the others.
+            const auto seq = seq_;
+            mem_map_.reset();
+            fh_.reset();
+            for (auto s = seq; s > begin_seq_; --s) {
+                unlink_seg(dir_, s);
+            }
+            truncate_seg(begin_seq_, begin_offset_);
+            sync_dir();
+            open_seg(seq + 1);
+        }
+        dirty_ = false;
+    } catch (const std::exception& e) {
+        SWIRLY_ERROR << "failed to rollback transaction: " << e.what();
+    }
+}
+
+void BinJourn::do_write(const Msg& msg)
+{
+    char buf[MaxMsgSize];
+    const auto size = encode_msg(buf, msg);
+    if (offset_ + RecordHeaderSize + size > seg_size_) {
+        roll();
+    }
+    last_ = offset_;
+    offset_ += put_record(base_ + offset_, buf, size, !trans_);
+    dirty_ = true;
+    if (!trans_) {
+        os::fdatasync(fh_.get());
+        dirty_ = false;
+    }
+}
+
+void BinJourn::do_read_max_id(const function<void(Id64, Id64)>& cb) const
+{
+    map<Id64, Id64> max_ids;
+    scan(dir_, seg_list(dir_), [&max_ids](const char* buf) {
+        Msg msg;
+        decode_msg(buf, msg);
+        if (msg.type == MsgType::CreateMarket) {
+            max_ids.emplace(msg.create_market.id, 0_id64);
+        } else if (msg.type == MsgType::CreateExec) {
+            const Id64 id{msg.create_exec.id};
+            auto& max_id = max_ids[msg.create_exec.market_id];
+            max_id = max(max_id, id);
+        }
+    });
+    for (const auto& [market_id, max_id] : max_ids) {
+        cb(market_id, max_id);
+    }
+}
+
+void BinJourn::open_seg(uint64_t seq)
+{
+    const auto path = seg_path(dir_, seq);
+    FileHandle fh{os::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL, SegMode)};
+    os::ftruncate(fh.get(), seg_size_);
+    // Allocate the blocks up front where the file system allows it, so that syncing a record never
+    // has to update file metadata as well.
+    posix_fallocate(fh.get(), 0, seg_size_);
+    MMap mem_map{
+        os::mmap(nullptr, seg_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fh.get(), 0)};
+    sync_dir();
+
+    seq_ = seq;
+    fh_ = std::move(fh);
+    mem_map_ = std::move(mem_map);
+    base_ = static_cast<char*>(mem_map_.get().data());
+    offset_ = 0;
+}
+
+void BinJourn::roll()
+{
+    // Records of an open transaction may remain in the current segment, and they must be durable
+    // before the transaction can be committed in the next one.
+    if (dirty_) {
+        os::fdatasync(fh_.get());
+        dirty_ = false;
+    }
+    open_seg(seq_ + 1);
+}
+
+void BinJourn::truncate_seg(uint64_t seq, size_t offset)
+{
+    FileHandle fh{os::open(seg_path(dir_, seq).c_str(), O_RDWR)};
+    os::ftruncate(fh.get(), offset);
+    os::fsync(fh.get());
+}
+
+void BinJourn::sync_dir()
+{
+    FileHandle fh{os::open(dir_.c_str(), O_RDONLY | O_DIRECTORY)};
+    os::fsync(fh.get());
+}
+
+} // namespace db
+} // namespace swirly
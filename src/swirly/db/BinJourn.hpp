@@ -0,0 +1,98 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_DB_BINJOURN_HPP
+#define SWIRLY_DB_BINJOURN_HPP
+
+#include <swirly/fin/Journ.hpp>
+
+#include <swirly/sys/File.hpp>
+#include <swirly/sys/MMap.hpp>
+
+#include <string>
+
+namespace swirly {
+inline namespace util {
+class Config;
+} // namespace util
+inline namespace db {
+
+/**
+ * Native append-only journal. Messages are appended in their compact encoding to memory-mapped
+ * segment files, which are preallocated so that appending a record never changes the size of a
+ * file. Each record is checksummed, and a transaction becomes durable with a single fdatasync on
+ * commit, so the cost of the sync is shared by every message in a group commit. A new segment is
+ * started when the current one is full, and whenever the journal is opened, after any incomplete
+ * transaction left by a crash has been discarded.
+ */
+class SWIRLY_API BinJourn : public Journ {
+  public:
+    BinJourn(const char* dir, std::size_t seg_size);
+    explicit BinJourn(const Config& config);
+    ~BinJourn() override;
+
+    // Copy.
+    BinJourn(const BinJourn&) = delete;
+    BinJourn& operator=(const BinJourn&) = delete;
+
+    // Move.
+    BinJourn(BinJourn&&);
+    BinJourn& operator=(BinJourn&&);
+
+    /**
+     * Returns the sequence number of the current segment.
+     */
+    std::uint64_t seq() const noexcept { return seq_; }
+
+  protected:
+    void do_begin() override;
+
+    void do_commit() override;
+
+    void do_rollback() noexcept override;
+
+    void do_write(const Msg& msg) override;
+
+    /**
+     * The segments are scanned in full, so this should only be called on recovery.
+     */
+    void do_read_max_id(const std::function<void(Id64, Id64)>& cb) const override;
+
+  private:
+    void open_seg(std::uint64_t seq);
+    void roll();
+    void truncate_seg(std::uint64_t seq, std::size_t offset);
+    void sync_dir();
+
+    std::string dir_;
+    std::size_t seg_size_;
+    std::uint64_t seq_{0};
+    FileHandle fh_;
+    MMap mem_map_;
+    char* base_{nullptr};
+    std::size_t offset_{0};
+    // Offset of the last record written by the current transaction, if any.
+    std::size_t last_{0};
+    bool dirty_{false};
+    bool trans_{false};
+    std::uint64_t begin_seq_{0};
+    std::size_t begin_offset_{0};
+};
+
+} // namespace db
+} // namespace swirly
+
+#endif // SWIRLY_DB_BINJOURN_HPP
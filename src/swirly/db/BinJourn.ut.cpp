@@ -0,0 +1,313 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "BinJourn.hpp"
+
+#include "Bin.hxx"
+#include "BinModel.hpp"
+
+#include <swirly/fin/Exec.hpp>
+#include <swirly/fin/Market.hpp>
+#include <swirly/fin/MarketId.hpp>
+#include <swirly/fin/Msg.hpp>
+#include <swirly/fin/Order.hpp>
+#include <swirly/fin/Posn.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+
+using namespace std;
+using namespace swirly;
+
+namespace {
+
+constexpr auto Today = ymd_to_jd(2014, 3, 11);
+constexpr auto SettlDay = Today + 2_jd;
+constexpr auto MarketId = to_market_id(1_id32, SettlDay);
+
+constexpr auto Now = jd_to_time(Today);
+constexpr size_t MaxExecs{1 << 4};
+
+struct RefModel : Model {
+  protected:
+    void do_read_asset(const ModelCallback<AssetPtr>& cb) const override {}
+    void do_read_instr(const ModelCallback<InstrPtr>& cb) const override {}
+    void do_read_market(const ModelCallback<MarketPtr>& cb) const override {}
+    void do_read_order(const ModelCallback<OrderPtr>& cb) const override {}
+    void do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const override {}
+    void do_read_trade(const ModelCallback<ExecPtr>& cb) const override {}
+    void do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const override {}
+};
+
+struct TempDir {
+    TempDir()
+    {
+        char tmpl[] = "/tmp/swirly-journ.XXXXXX";
+        BOOST_REQUIRE(mkdtemp(tmpl));
+        path = tmpl;
+    }
+    ~TempDir()
+    {
+        for (const auto seq : bin::seg_list(path)) {
+            unlink(bin::seg_path(path, seq).c_str());
+        }
+        rmdir(path.c_str());
+    }
+    string path;
+};
+
+Msg create_market_msg()
+{
+    char buf[MaxMsgSize];
+    encode_create_market(buf, MarketId, "EURUSD"sv, SettlDay, 0);
+    Msg msg;
+    decode_msg(buf, msg);
+    return msg;
+}
+
+Msg create_exec_msg(Id64 id, Id64 order_id, State state, Lots resd_lots, Lots last_lots)
+{
+    const auto exec = make_intrusive<Exec>(
+        "MARAYL"sv, MarketId, "EURUSD"sv, SettlDay, id, order_id, "apple"sv, state, Side::Buy,
+        10_lts, 12345_tks, resd_lots, 10_lts - resd_lots, 0_cst, last_lots,
+        last_lots > 0_lts ? 12345_tks : 0_tks, 1_lts, 0_id64, 0_lts, 0_cst, LiqInd::None,
+        Symbol{}, Now);
+    char buf[MaxMsgSize];
+    encode_create_exec(buf, *exec);
+    Msg msg;
+    decode_msg(buf, msg);
+    return msg;
+}
+
+template <typename ValueT>
+vector<ValueT> read_all(const Model& model, void (Model::*fn)(const ModelCallback<ValueT>&) const)
+{
+    vector<ValueT> v;
+    (model.*fn)([&v](ValueT ptr) { v.push_back(std::move(ptr)); });
+    return v;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(BinJournSuite)
+
+BOOST_AUTO_TEST_CASE(BinJournModelCase)
+{
+    TempDir dir;
+    {
+        BinJourn journ{dir.path.c_str(), 1 << 20};
+        journ.write(create_market_msg());
+        Journ::Transaction trans{journ};
+        journ.write(create_exec_msg(1_id64, 1_id64, State::New, 10_lts, 0_lts));
+        journ.write(create_exec_msg(2_id64, 1_id64, State::Trade, 3_lts, 7_lts));
+        trans.commit();
+    }
+    const RefModel ref_model;
+    const BinModel model{dir.path.c_str(), ref_model, MaxExecs};
+
+    const auto markets = read_all(model, &Model::read_market);
+    BOOST_TEST(markets.size() == 1U);
+    BOOST_TEST(markets[0]->id() == MarketId);
+    BOOST_TEST(markets[0]->last_lots() == 7_lts);
+    BOOST_TEST(markets[0]->max_id() == 2_id64);
+
+    const auto orders = read_all(model, &Model::read_order);
+    BOOST_TEST(orders.size() == 1U);
+    BOOST_TEST(orders[0]->id() == 1_id64);
+    BOOST_TEST(orders[0]->resd_lots() == 3_lts);
+    BOOST_TEST(orders[0]->ref() == "apple"sv);
+
+    vector<ExecPtr> execs;
+    model.read_exec(Now - 1ms, [&execs](auto ptr) { execs.push_back(ptr); });
+    BOOST_TEST(execs.size() == 2U);
+    // Most recent first.
+    BOOST_TEST(execs[0]->id() == 2_id64);
+
+    execs.clear();
+    model.read_accnt_exec("MARAYL"sv, Now - 1ms, 1, [&execs](auto ptr) { execs.push_back(ptr); });
+    BOOST_TEST(execs.size() == 1U);
+    BOOST_TEST(execs[0]->id() == 2_id64);
+    model.read_accnt_exec("GOSAYL"sv, Now - 1ms, 1, [&execs](auto ptr) { execs.push_back(ptr); });
+    BOOST_TEST(execs.size() == 1U);
+
+    const auto trades = read_all(model, &Model::read_trade);
+    BOOST_TEST(trades.size() == 1U);
+
+    vector<PosnPtr> posns;
+    model.read_posn(Today, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->buy_lots() == 7_lts);
+
+    // Still open on the settlement-day.
+    posns.clear();
+    model.read_posn(SettlDay, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->market_id() == MarketId);
+
+    posns.clear();
+    model.read_posn(SettlDay + 1_jd, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->market_id() == to_rolled_id(MarketId));
+    BOOST_TEST(posns[0]->buy_lots() == 7_lts);
+}
+
+BOOST_AUTO_TEST_CASE(BinJournMaxIdCase)
+{
+    TempDir dir;
+    BinJourn journ{dir.path.c_str(), 1 << 20};
+
+    map<Id64, Id64> max_ids;
+    const auto fn = [&max_ids](Id64 market_id, Id64 max_id) { max_ids[market_id] = max_id; };
+    journ.read_max_id(fn);
+    BOOST_TEST(max_ids.empty());
+
+    // Zero for a market without execs.
+    journ.write(create_market_msg());
+    journ.read_max_id(fn);
+    BOOST_TEST(max_ids.size() == 1U);
+    BOOST_TEST(max_ids[MarketId] == 0_id64);
+    {
+        Journ::Transaction trans{journ};
+        journ.write(create_exec_msg(2_id64, 1_id64, State::New, 10_lts, 0_lts));
+        journ.write(create_exec_msg(1_id64, 1_id64, State::New, 10_lts, 0_lts));
+        trans.commit();
+    }
+    {
+        Journ::Transaction trans{journ};
+        journ.write(create_exec_msg(3_id64, 3_id64, State::New, 10_lts, 0_lts));
+        // Rolled back.
+    }
+    journ.read_max_id(fn);
+    BOOST_TEST(max_ids.size() == 1U);
+    BOOST_TEST(max_ids[MarketId] == 2_id64);
+}
+
+BOOST_AUTO_TEST_CASE(BinJournRollbackCase)
+{
+    TempDir dir;
+    {
+        BinJourn journ{dir.path.c_str(), 1 << 20};
+        {
+            Journ::Transaction trans{journ};
+            journ.write(create_exec_msg(1_id64, 1_id64, State::New, 10_lts, 0_lts));
+            // Rolled back.
+        }
+        {
+            Journ::Transaction trans{journ};
+            journ.write(create_exec_msg(2_id64, 2_id64, State::New, 10_lts, 0_lts));
+            trans.commit();
+        }
+        // Left incomplete, as if by a crash.
+        journ.begin();
+        journ.write(create_exec_msg(3_id64, 3_id64, State::New, 10_lts, 0_lts));
+    }
+    {
+        // Reopening the journal discards the incomplete transaction, so that it cannot be completed
+        // by the next commit.
+        BinJourn journ{dir.path.c_str(), 1 << 20};
+        BOOST_TEST(journ.seq() == 2U);
+        Journ::Transaction trans{journ};
+        journ.write(create_exec_msg(4_id64, 4_id64, State::New, 10_lts, 0_lts));
+        trans.commit();
+    }
+    const RefModel ref_model;
+    const BinModel model{dir.path.c_str(), ref_model, MaxExecs};
+
+    const auto orders = read_all(model, &Model::read_order);
+    BOOST_TEST(orders.size() == 2U);
+    BOOST_TEST(orders[0]->id() == 2_id64);
+    BOOST_TEST(orders[1]->id() == 4_id64);
+}
+
+BOOST_AUTO_TEST_CASE(BinJournRollCase)
+{
+    TempDir dir;
+    constexpr int N{100};
+    {
+        // Segments of the minimum size hold only a few records each.
+        BinJourn journ{dir.path.c_str(), 0};
+        Journ::Transaction trans{journ};
+        for (int i{1}; i <= N; ++i) {
+            journ.write(create_exec_msg(Id64{i}, Id64{i}, State::New, 10_lts, 0_lts));
+        }
+        trans.commit();
+        BOOST_TEST(journ.seq() > 1U);
+    }
+    const RefModel ref_model;
+    const BinModel model{dir.path.c_str(), ref_model, MaxExecs};
+
+    const auto orders = read_all(model, &Model::read_order);
+    BOOST_TEST(orders.size() == size_t(N));
+}
+
+BOOST_AUTO_TEST_CASE(BinJournExecCapCase)
+{
+    TempDir dir;
+    {
+        BinJourn journ{dir.path.c_str(), 1 << 20};
+        Journ::Transaction trans{journ};
+        for (int i{1}; i <= 3; ++i) {
+            journ.write(create_exec_msg(Id64{i}, Id64{i}, State::New, 10_lts, 0_lts));
+        }
+        trans.commit();
+    }
+    const RefModel ref_model;
+    const BinModel model{dir.path.c_str(), ref_model, 2};
+
+    // Only the most recent execs of the account are retained.
+    vector<ExecPtr> execs;
+    model.read_accnt_exec("MARAYL"sv, Now - 1ms, MaxExecs,
+                          [&execs](auto ptr) { execs.push_back(ptr); });
+    BOOST_TEST(execs.size() == 2U);
+    BOOST_TEST(execs[0]->id() == 3_id64);
+    BOOST_TEST(execs[1]->id() == 2_id64);
+
+    // All execs are read from the segments.
+    execs.clear();
+    model.read_exec(Now - 1ms, [&execs](auto ptr) { execs.push_back(ptr); });
+    BOOST_TEST(execs.size() == 3U);
+    BOOST_TEST(execs[0]->id() == 3_id64);
+    BOOST_TEST(execs[2]->id() == 1_id64);
+}
+
+BOOST_AUTO_TEST_CASE(BinJournCorruptCase)
+{
+    TempDir dir;
+    {
+        BinJourn journ{dir.path.c_str(), 1 << 20};
+        journ.write(create_exec_msg(1_id64, 1_id64, State::New, 10_lts, 0_lts));
+        journ.write(create_exec_msg(2_id64, 2_id64, State::New, 10_lts, 0_lts));
+    }
+    {
+        // Flip a byte in the payload of the second record.
+        const auto path = bin::seg_path(dir.path, 1);
+        FileHandle fh{os::open(path.c_str(), O_RDWR)};
+        MMap mem_map{os::mmap(nullptr, 1 << 20, PROT_READ | PROT_WRITE, MAP_SHARED, fh.get(), 0)};
+        auto* const base = static_cast<char*>(mem_map.get().data());
+        uint32_t size;
+        memcpy(&size, base, sizeof(size));
+        base[bin::RecordHeaderSize + (size & ~bin::EndTrans) + bin::RecordHeaderSize + 4] ^= 1;
+    }
+    const RefModel ref_model;
+    const BinModel model{dir.path.c_str(), ref_model, MaxExecs};
+
+    const auto orders = read_all(model, &Model::read_order);
+    BOOST_TEST(orders.size() == 1U);
+    BOOST_TEST(orders[0]->id() == 1_id64);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,318 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "BinModel.hpp"
+
+#include "Bin.hxx"
+
+#include <swirly/fin/Exec.hpp>
+#include <swirly/fin/Market.hpp>
+#include <swirly/fin/MarketId.hpp>
+#include <swirly/fin/MsgHandler.hpp>
+#include <swirly/fin/Order.hpp>
+#include <swirly/fin/Posn.hpp>
+
+#include <swirly/util/String.hpp>
+
+#include <deque>
+#include <map>
+#include <mutex>
+
+namespace swirly {
+inline namespace db {
+using namespace std;
+namespace {
+
+using Key = pair<Id64, Id64>;
+
+struct MarketRec {
+    Symbol instr;
+    JDay settl_day;
+    MarketState state;
+    Lots last_lots;
+    Ticks last_ticks;
+    int64_t last_time;
+    Id64 max_id;
+};
+
+struct OrderRec {
+    // The most recent exec of the order.
+    CreateExec exec;
+    int64_t created;
+};
+
+struct PosnRec {
+    Symbol instr;
+    JDay settl_day;
+    Lots buy_lots;
+    Cost buy_cost;
+    Lots sell_lots;
+    Cost sell_cost;
+};
+
+Time ms_to_time(int64_t ms) noexcept
+{
+    return to_time(Millis{ms});
+}
+
+ExecPtr make_exec(const CreateExec& body)
+{
+    return Exec::make(Symbol{to_string_view(body.accnt)}, body.market_id,
+                      Symbol{to_string_view(body.instr)}, body.settl_day, body.id, body.order_id,
+                      to_string_view(body.ref), body.state, body.side, body.lots, body.ticks,
+                      body.resd_lots, body.exec_lots, body.exec_cost, body.last_lots,
+                      body.last_ticks, body.min_lots, body.match_id, body.posn_lots,
+                      body.posn_cost, body.liq_ind, Symbol{to_string_view(body.cpty)},
+                      ms_to_time(body.created));
+}
+
+} // namespace
+
+/**
+ * Applies journalled messages with the same effect as the triggers of the SQL schema.
+ */
+struct BinModel::Impl : BasicMsgHandler<Impl> {
+    Impl(const char* dir, size_t max_execs)
+    : dir{dir}
+    , max_execs{max_execs}
+    {
+    }
+    void on_create_market(const CreateMarket& body)
+    {
+        markets.emplace(body.id, MarketRec{Symbol{to_string_view(body.instr)}, body.settl_day,
+                                           body.state, 0_lts, 0_tks, 0, 0_id64});
+    }
+    void on_update_market(const UpdateMarket& body)
+    {
+        const auto it = markets.find(body.id);
+        if (it != markets.end()) {
+            it->second.state = body.state;
+        }
+    }
+    void on_create_exec(const CreateExec& body)
+    {
+        const Symbol accnt{to_string_view(body.accnt)};
+        auto& execs = accnt_execs[accnt];
+        execs.push_back(body);
+        if (execs.size() > max_execs) {
+            execs.pop_front();
+        }
+        const auto it = markets.find(body.market_id);
+        if (it != markets.end()) {
+            auto& market = it->second;
+            market.max_id = max<Id64>(market.max_id, body.id);
+            if (body.state == State::Trade) {
+                market.last_lots = body.last_lots;
+                market.last_ticks = body.last_ticks;
+                market.last_time = body.created;
+            }
+        }
+        if (body.order_id != 0_id64) {
+            const Key key{body.market_id, body.order_id};
+            if (body.state == State::New) {
+                orders[key] = OrderRec{body, body.created};
+            } else {
+                const auto it = orders.find(key);
+                if (it != orders.end()) {
+                    it->second.exec = body;
+                }
+            }
+        }
+        if (body.state == State::Trade) {
+            trades[{body.market_id, body.id}] = body;
+            // Positions are summed by side, as in the posn_v view of the SQL schema.
+            const pair<Symbol, Id64> key{accnt, body.market_id};
+            auto posn_it = posns.find(key);
+            if (posn_it == posns.end()) {
+                const PosnRec rec{Symbol{to_string_view(body.instr)}, body.settl_day, 0_lts, 0_cst,
+                                  0_lts, 0_cst};
+                posn_it = posns.emplace(key, rec).first;
+            }
+            auto& posn = posn_it->second;
+            if (body.side == Side::Buy) {
+                posn.buy_lots += body.last_lots;
+                posn.buy_cost += cost(body.last_lots, body.last_ticks);
+            } else {
+                posn.sell_lots += body.last_lots;
+                posn.sell_cost += cost(body.last_lots, body.last_ticks);
+            }
+        }
+    }
+    void on_archive_trade(const ArchiveTrade& body)
+    {
+        for (size_t i{0}; i < MaxIds; ++i) {
+            const auto id = body.ids[i];
+            if (id == 0_id64) {
+                break;
+            }
+            trades.erase({body.market_id, id});
+        }
+    }
+    map<Id64, MarketRec> markets;
+    map<Key, OrderRec> orders;
+    // The most recent execs of each account, oldest first.
+    map<Symbol, deque<CreateExec>> accnt_execs;
+    // Trades that have not been archived.
+    map<Key, CreateExec> trades;
+    map<pair<Symbol, Id64>, PosnRec> posns;
+    string dir;
+    size_t max_execs;
+    once_flag loaded;
+};
+
+BinModel::BinModel(const char* dir, const Model& ref_model, size_t max_execs)
+: ref_model_{&ref_model}
+, impl_{make_unique<Impl>(dir, max_execs)}
+{
+}
+
+BinModel::~BinModel() = default;
+
+BinModel::BinModel(BinModel&&) = default;
+
+BinModel& BinModel::operator=(BinModel&&) = default;
+
+const BinModel::Impl& BinModel::impl() const
+{
+    // The segments are scanned on first read, rather than on construction, so that the model also
+    // reflects anything journalled in between, such as messages recovered from the queue.
+    // The scan is guarded, so that concurrent reads wait for the first to complete it.
+    auto& impl = *impl_;
+    call_once(impl.loaded, [&impl]() {
+        const auto* const dir = impl.dir.c_str();
+        bin::scan(dir, bin::seg_list(dir), [&impl](const char* buf) {
+            Msg msg;
+            decode_msg(buf, msg);
+            impl.dispatch(msg);
+        });
+    });
+    return impl;
+}
+
+bool BinModel::do_concurrent() const noexcept
+{
+    // Each read makes its own objects from the scanned records.
+    return true;
+}
+
+void BinModel::do_read_asset(const ModelCallback<AssetPtr>& cb) const
+{
+    ref_model_->read_asset(cb);
+}
+
+void BinModel::do_read_instr(const ModelCallback<InstrPtr>& cb) const
+{
+    ref_model_->read_instr(cb);
+}
+
+void BinModel::do_read_market(const ModelCallback<MarketPtr>& cb) const
+{
+    for (const auto& [id, rec] : impl().markets) {
+        cb(Market::make(id, rec.instr, rec.settl_day, rec.state, rec.last_lots, rec.last_ticks,
+                        ms_to_time(rec.last_time), rec.max_id));
+    }
+}
+
+void BinModel::do_read_order(const ModelCallback<OrderPtr>& cb) const
+{
+    for (const auto& [key, rec] : impl().orders) {
+        const auto& body = rec.exec;
+        if (body.resd_lots > 0_lts) {
+            cb(Order::make(Symbol{to_string_view(body.accnt)}, body.market_id,
+                           Symbol{to_string_view(body.instr)}, body.settl_day, body.order_id,
+                           to_string_view(body.ref), body.state, body.side, body.lots,
+                           body.ticks, body.resd_lots, body.exec_lots, body.exec_cost,
+                           body.last_lots, body.last_ticks, body.min_lots, ms_to_time(rec.created),
+                           ms_to_time(body.created)));
+        }
+    }
+}
+
+void BinModel::do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const
+{
+    // Only the most recent execs of each account are retained, so the segments are scanned again.
+    const auto& dir = impl().dir;
+    vector<CreateExec> execs;
+    bin::scan(dir, bin::seg_list(dir), [since, &execs](const char* buf) {
+        Msg msg;
+        decode_msg(buf, msg);
+        if (msg.type == MsgType::CreateExec && ms_to_time(msg.create_exec.created) > since) {
+            execs.push_back(msg.create_exec);
+        }
+    });
+    // Most recent first.
+    for (auto it = execs.rbegin(); it != execs.rend(); ++it) {
+        cb(make_exec(*it));
+    }
+}
+
+void BinModel::do_read_accnt_exec(Symbol accnt, Time since, size_t limit,
+                                  const ModelCallback<ExecPtr>& cb) const
+{
+    const auto& accnt_execs = impl().accnt_execs;
+    const auto it = accnt_execs.find(accnt);
+    if (it == accnt_execs.end()) {
+        return;
+    }
+    // Most recent first.
+    const auto& execs = it->second;
+    for (auto jt = execs.rbegin(); jt != execs.rend() && limit > 0; ++jt) {
+        if (ms_to_time(jt->created) > since) {
+            cb(make_exec(*jt));
+            --limit;
+        }
+    }
+}
+
+void BinModel::do_read_trade(const ModelCallback<ExecPtr>& cb) const
+{
+    for (const auto& [key, body] : impl().trades) {
+        cb(make_exec(body));
+    }
+}
+
+void BinModel::do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const
+{
+    PosnSet ps;
+    PosnSet::Iterator it;
+
+    for (const auto& [key, rec] : impl().posns) {
+        const auto accnt = key.first;
+        auto market_id = key.second;
+        auto settl_day = rec.settl_day;
+
+        // Rolled with the same cutoff as end of day.
+        if (is_settled(settl_day, bus_day)) {
+            market_id = to_rolled_id(market_id);
+            settl_day = 0_jd;
+        }
+
+        bool found;
+        tie(it, found) = ps.find_hint(accnt, market_id);
+        if (!found) {
+            it = ps.insert_hint(it, Posn::make(accnt, market_id, rec.instr, settl_day));
+        }
+        it->add_buy(rec.buy_lots, rec.buy_cost);
+        it->add_sell(rec.sell_lots, rec.sell_cost);
+    }
+
+    for (it = ps.begin(); it != ps.end();) {
+        cb(ps.remove(it++));
+    }
+}
+
+} // namespace db
+} // namespace swirly
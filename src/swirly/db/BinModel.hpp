@@ -0,0 +1,84 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_DB_BINMODEL_HPP
+#define SWIRLY_DB_BINMODEL_HPP
+
+#include <swirly/fin/Model.hpp>
+
+#include <memory>
+
+namespace swirly {
+inline namespace db {
+
+/**
+ * Model that rebuilds state by scanning the segments of a binary journal. Reference data is not
+ * journalled, so assets and instruments are read from a separate model. Only the most recent execs
+ * of each account are retained from the scan, so reading all execs scans the segments again.
+ */
+class SWIRLY_API BinModel : public Model {
+  public:
+    /**
+     * @param dir
+     *            The journal directory.
+     * @param ref_model
+     *            The model from which reference data is read.
+     * @param max_execs
+     *            The number of execs retained for each account.
+     */
+    BinModel(const char* dir, const Model& ref_model, std::size_t max_execs);
+    ~BinModel() override;
+
+    // Copy.
+    BinModel(const BinModel&) = delete;
+    BinModel& operator=(const BinModel&) = delete;
+
+    // Move.
+    BinModel(BinModel&&);
+    BinModel& operator=(BinModel&&);
+
+  protected:
+    bool do_concurrent() const noexcept override;
+
+    void do_read_asset(const ModelCallback<AssetPtr>& cb) const override;
+
+    void do_read_instr(const ModelCallback<InstrPtr>& cb) const override;
+
+    void do_read_market(const ModelCallback<MarketPtr>& cb) const override;
+
+    void do_read_order(const ModelCallback<OrderPtr>& cb) const override;
+
+    void do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const override;
+
+    void do_read_accnt_exec(Symbol accnt, Time since, std::size_t limit,
+                            const ModelCallback<ExecPtr>& cb) const override;
+
+    void do_read_trade(const ModelCallback<ExecPtr>& cb) const override;
+
+    void do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const override;
+
+  private:
+    struct Impl;
+    const Impl& impl() const;
+
+    const Model* ref_model_;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace db
+} // namespace swirly
+
+#endif // SWIRLY_DB_BINMODEL_HPP
@@ -16,6 +16,9 @@
  */
 #include "DbCtx.hpp"
 
+#include "BinJourn.hpp"
+#include "BinModel.hpp"
+#include "ReplayModel.hpp"
 #include "Sqlite.hxx"
 #include "SqliteJourn.hpp"
 #include "SqliteModel.hpp"
@@ -35,9 +38,9 @@ namespace swirly {
 inline namespace db {
 namespace {
 struct SqliteImpl : DbCtx::Impl {
-    explicit SqliteImpl(const sqlite::DbPtr& db)
-    : model_{db}
-    , journ_{db}
+    SqliteImpl(const sqlite::DbPtr& model_db, const sqlite::DbPtr& journ_db)
+    : model_{model_db}
+    , journ_{journ_db}
     {
     }
     ~SqliteImpl() override = default;
@@ -49,11 +52,40 @@ struct SqliteImpl : DbCtx::Impl {
     SqliteJourn journ_;
 };
 
+/**
+ * Binary journal, with reference data from a read-only Sqlite database.
+ */
+struct BinImpl : DbCtx::Impl {
+    BinImpl(const sqlite::DbPtr& ref_db, const char* dir, std::size_t seg_size,
+            std::size_t max_execs)
+    : dir_{dir}
+    , ref_model_{ref_db}
+    , journ_{dir, seg_size}
+    , model_{dir, ref_model_, max_execs}
+    {
+    }
+    ~BinImpl() override = default;
+    Model& do_model() override { return model_; }
+    Journ& do_journ() override { return journ_; }
+    std::unique_ptr<Model> do_replay_model(const Model& snap_model) override
+    {
+        return std::make_unique<ReplayModel>(dir_.c_str(), ref_model_, snap_model);
+    }
+
+  private:
+    const std::string dir_;
+    SqliteModel ref_model_;
+    // The journal is opened first, so that any incomplete transaction is discarded before the model
+    // scans the segments.
+    BinJourn journ_;
+    BinModel model_;
+};
+
 #if SWIRLY_HAVE_MYSQL
 struct MySqlImpl : DbCtx::Impl {
-    explicit MySqlImpl(const mysql::DbPtr& db)
-    : model_{db}
-    , journ_{db}
+    MySqlImpl(const mysql::DbPtr& model_db, const mysql::DbPtr& journ_db, std::size_t batch_size)
+    : model_{model_db}
+    , journ_{journ_db, batch_size}
     {
     }
     ~MySqlImpl() override = default;
@@ -76,8 +108,26 @@ std::unique_ptr<DbCtx::Impl> make_impl(const Config& config)
 
         const char* const db_name{config.get("db_name", "swirly.db")};
         SWIRLY_INFO << "db_name:    " << db_name;
-        impl
-            = std::make_unique<SqliteImpl>(sqlite::open_db(db_name, SQLITE_OPEN_READWRITE, config));
+        // Exec history may be read from the model on its own thread while the journal writes on
+        // another, so each has its own connection.
+        impl = std::make_unique<SqliteImpl>(
+            sqlite::open_db(db_name, SQLITE_OPEN_READONLY, config),
+            sqlite::open_db(db_name, SQLITE_OPEN_READWRITE, config));
+
+    } else if (std::strcmp(db_type, "bin") == 0) {
+
+        const char* const db_name{config.get("db_name", "swirly.db")};
+        const char* const journ_dir{config.get("journ_dir", "journ")};
+        const auto journ_seg_size{config.get<std::size_t>("journ_seg_size", 64 << 20)};
+        // The model retains the same number of execs per account as each session.
+        const auto max_execs{config.get<std::size_t>("max_execs", 1 << 4)};
+
+        SWIRLY_INFO << "db_name:    " << db_name;
+        SWIRLY_INFO << "journ_dir:  " << journ_dir;
+        SWIRLY_INFO << "journ_seg_size: " << journ_seg_size;
+
+        impl = std::make_unique<BinImpl>(sqlite::open_db(db_name, SQLITE_OPEN_READONLY, config),
+                                         journ_dir, journ_seg_size, max_execs);
 
 #if SWIRLY_HAVE_MYSQL
     } else if (std::strcmp(db_type, "mariadb") == 0 || std::strcmp(db_type, "mysql") == 0) {
@@ -87,14 +137,20 @@ std::unique_ptr<DbCtx::Impl> make_impl(const Config& config)
         const char* const db_pass{config.get("db_pass", "")};
         const char* const db_name{config.get("db_name", "swirlydb")};
         const auto db_port{config.get<unsigned>("db_port", 3306)};
+        const auto journ_batch_size{
+            config.get<std::size_t>("journ_batch_size", MySqlJourn::DefaultBatchSize)};
 
         SWIRLY_INFO << "db_host:    " << db_host;
         SWIRLY_INFO << "db_user:    " << db_user;
         SWIRLY_INFO << "db_name:    " << db_name;
         SWIRLY_INFO << "db_port:    " << db_port;
+        SWIRLY_INFO << "journ_batch_size: " << journ_batch_size;
 
+        // The model may be read on the matching thread while the journal writes on its own thread,
+        // so each has its own connection.
         impl = std::make_unique<MySqlImpl>(
-            mysql::open_db(db_host, db_user, db_pass, db_name, db_port, config));
+            mysql::open_db(db_host, db_user, db_pass, db_name, db_port, config),
+            mysql::open_db(db_host, db_user, db_pass, db_name, db_port, config), journ_batch_size);
 #endif
     } else {
         throw DatabaseException{err_msg() << "db_type '" << db_type << "' not supported"};
@@ -105,6 +161,11 @@ std::unique_ptr<DbCtx::Impl> make_impl(const Config& config)
 
 DbCtx::Impl::~Impl() = default;
 
+std::unique_ptr<Model> DbCtx::Impl::do_replay_model(const Model& snap_model)
+{
+    return {};
+}
+
 DbCtx::DbCtx(const Config& config)
 : impl_{make_impl(config)}
 {
@@ -37,6 +37,7 @@ class SWIRLY_API DbCtx {
         virtual ~Impl();
         virtual Model& do_model() = 0;
         virtual Journ& do_journ() = 0;
+        virtual std::unique_ptr<Model> do_replay_model(const Model& snap_model);
     };
     DbCtx(const Config& config);
     ~DbCtx();
@@ -51,6 +52,14 @@ class SWIRLY_API DbCtx {
 
     Model& model() const { return impl_->do_model(); }
     Journ& journ() const { return impl_->do_journ(); }
+    /**
+     * Returns a model that replays the tail of the journal over a snapshot, or null if the journal
+     * cannot be replayed. The snapshot model must outlive the returned model.
+     */
+    std::unique_ptr<Model> replay_model(const Model& snap_model) const
+    {
+        return impl_->do_replay_model(snap_model);
+    }
 
   private:
     std::unique_ptr<Impl> impl_;
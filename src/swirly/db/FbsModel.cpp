@@ -0,0 +1,206 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "FbsModel.hpp"
+
+#include <swirly/fin/Asset.hpp>
+#include <swirly/fin/Exception.hpp>
+#include <swirly/fin/Exec.hpp>
+#include <swirly/fin/Instr.hpp>
+#include <swirly/fin/Market.hpp>
+#include <swirly/fin/MarketId.hpp>
+#include <swirly/fin/Order.hpp>
+#include <swirly/fin/Posn.hpp>
+
+#include <swirly/fbs/Snapshot_generated.h>
+
+#include <swirly/sys/File.hpp>
+
+#include <limits>
+
+namespace swirly {
+inline namespace db {
+using namespace std;
+namespace {
+
+string_view to_string_view(const flatbuffers::String* str) noexcept
+{
+    return str ? string_view{str->c_str(), str->size()} : string_view{};
+}
+
+Symbol to_symbol(const flatbuffers::String* str) noexcept
+{
+    return Symbol{to_string_view(str)};
+}
+
+Time ms_to_time(int64_t ms) noexcept
+{
+    return to_time(Millis{ms});
+}
+
+ExecPtr make_exec(const fbs::Exec& exec)
+{
+    return Exec::make(to_symbol(exec.accnt()), Id64{exec.market_id()}, to_symbol(exec.instr()),
+                      JDay{exec.settl_day()}, Id64{exec.id()}, Id64{exec.order_id()},
+                      to_string_view(exec.ref()), exec.state(), exec.side(), Lots{exec.lots()},
+                      Ticks{exec.ticks()}, Lots{exec.resd_lots()}, Lots{exec.exec_lots()},
+                      Cost{exec.exec_cost()}, Lots{exec.last_lots()}, Ticks{exec.last_ticks()},
+                      Lots{exec.min_lots()}, Id64{exec.match_id()}, Lots{exec.posn_lots()},
+                      Cost{exec.posn_cost()}, exec.liq_ind(), to_symbol(exec.cpty()),
+                      ms_to_time(exec.created()));
+}
+
+// Vectors are omitted from the snapshot when empty.
+template <typename ValueT, typename FnT>
+void for_each(const flatbuffers::Vector<flatbuffers::Offset<ValueT>>* vec, FnT fn)
+{
+    if (vec) {
+        for (const auto* val : *vec) {
+            fn(*val);
+        }
+    }
+}
+
+} // namespace
+
+FbsModel::FbsModel(const char* path)
+{
+    const FileHandle fh{os::open(path, O_RDONLY)};
+    const auto size = file_size(fh.get());
+    if (size > 0) {
+        mem_map_ = os::mmap(nullptr, size, PROT_READ, MAP_SHARED, fh.get(), 0);
+    }
+    const auto* const buf = static_cast<const uint8_t*>(mem_map_.get().data());
+    // The default limit on the number of tables is too low for a large book.
+    flatbuffers::Verifier verifier{buf, size, 64, numeric_limits<flatbuffers::uoffset_t>::max()};
+    if (!buf || !fbs::VerifySnapshotBuffer(verifier)) {
+        throw DatabaseException{err_msg() << "invalid snapshot '" << path << "'"};
+    }
+    snapshot_ = fbs::GetSnapshot(buf);
+}
+
+FbsModel::~FbsModel() = default;
+
+FbsModel::FbsModel(FbsModel&&) = default;
+
+FbsModel& FbsModel::operator=(FbsModel&&) = default;
+
+Time FbsModel::created() const noexcept
+{
+    return ms_to_time(snapshot_->created());
+}
+
+bool FbsModel::clean() const noexcept
+{
+    return snapshot_->clean();
+}
+
+bool FbsModel::do_concurrent() const noexcept
+{
+    // The snapshot is read-only once mapped.
+    return true;
+}
+
+void FbsModel::do_read_asset(const ModelCallback<AssetPtr>& cb) const
+{
+    for_each(snapshot_->assets(), [&cb](const fbs::Asset& asset) {
+        cb(Asset::make(Id32{asset.id()}, to_symbol(asset.symbol()),
+                       to_string_view(asset.display()), asset.type()));
+    });
+}
+
+void FbsModel::do_read_instr(const ModelCallback<InstrPtr>& cb) const
+{
+    for_each(snapshot_->instrs(), [&cb](const fbs::Instr& instr) {
+        cb(Instr::make(Id32{instr.id()}, to_symbol(instr.symbol()),
+                       to_string_view(instr.display()), to_symbol(instr.base_asset()),
+                       to_symbol(instr.term_ccy()), instr.lot_numer(), instr.lot_denom(),
+                       instr.tick_numer(), instr.tick_denom(), instr.pip_dp(),
+                       Lots{instr.min_lots()}, Lots{instr.max_lots()}));
+    });
+}
+
+void FbsModel::do_read_market(const ModelCallback<MarketPtr>& cb) const
+{
+    for_each(snapshot_->markets(), [&cb](const fbs::Market& market) {
+        cb(Market::make(Id64{market.id()}, to_symbol(market.instr()), JDay{market.settl_day()},
+                        market.state(), Lots{market.last_lots()}, Ticks{market.last_ticks()},
+                        ms_to_time(market.last_time()), Id64{market.max_id()}));
+    });
+}
+
+void FbsModel::do_read_order(const ModelCallback<OrderPtr>& cb) const
+{
+    for_each(snapshot_->orders(), [&cb](const fbs::Order& order) {
+        cb(Order::make(to_symbol(order.accnt()), Id64{order.market_id()},
+                       to_symbol(order.instr()), JDay{order.settl_day()}, Id64{order.id()},
+                       to_string_view(order.ref()), order.state(), order.side(),
+                       Lots{order.lots()}, Ticks{order.ticks()}, Lots{order.resd_lots()},
+                       Lots{order.exec_lots()}, Cost{order.exec_cost()}, Lots{order.last_lots()},
+                       Ticks{order.last_ticks()}, Lots{order.min_lots()},
+                       ms_to_time(order.created()), ms_to_time(order.modified())));
+    });
+}
+
+void FbsModel::do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const
+{
+    const auto since_ms = ms_since_epoch(since);
+    for_each(snapshot_->execs(), [&cb, since_ms](const fbs::Exec& exec) {
+        if (exec.created() > since_ms) {
+            cb(make_exec(exec));
+        }
+    });
+}
+
+void FbsModel::do_read_trade(const ModelCallback<ExecPtr>& cb) const
+{
+    for_each(snapshot_->trades(), [&cb](const fbs::Exec& trade) { cb(make_exec(trade)); });
+}
+
+void FbsModel::do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const
+{
+    PosnSet ps;
+    PosnSet::Iterator it;
+
+    // The snapshot may have been taken before end of day, so positions in markets that have since
+    // settled are rolled with the same cutoff as end of day.
+    for_each(snapshot_->posns(), [&](const fbs::Posn& posn) {
+        const auto accnt = to_symbol(posn.accnt());
+        auto market_id = Id64{posn.market_id()};
+        const auto instr = to_symbol(posn.instr());
+        auto settl_day = JDay{posn.settl_day()};
+
+        if (is_settled(settl_day, bus_day)) {
+            market_id = to_rolled_id(market_id);
+            settl_day = 0_jd;
+        }
+
+        bool found;
+        tie(it, found) = ps.find_hint(accnt, market_id);
+        if (!found) {
+            it = ps.insert_hint(it, Posn::make(accnt, market_id, instr, settl_day));
+        }
+        it->add_buy(Lots{posn.buy_lots()}, Cost{posn.buy_cost()});
+        it->add_sell(Lots{posn.sell_lots()}, Cost{posn.sell_cost()});
+    });
+
+    for (it = ps.begin(); it != ps.end();) {
+        cb(ps.remove(it++));
+    }
+}
+
+} // namespace db
+} // namespace swirly
@@ -0,0 +1,82 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_DB_FBSMODEL_HPP
+#define SWIRLY_DB_FBSMODEL_HPP
+
+#include <swirly/fin/Model.hpp>
+
+#include <swirly/sys/MMap.hpp>
+
+namespace swirly {
+namespace fbs {
+struct Snapshot;
+} // namespace fbs
+inline namespace db {
+
+/**
+ * Model that is read from a snapshot written by FbsSnapshot. The snapshot file is memory-mapped,
+ * and objects are constructed directly from its flatbuffer tables, so that nothing needs to be
+ * parsed or queried.
+ */
+class SWIRLY_API FbsModel : public Model {
+  public:
+    explicit FbsModel(const char* path);
+    ~FbsModel() override;
+
+    // Copy.
+    FbsModel(const FbsModel&) = delete;
+    FbsModel& operator=(const FbsModel&) = delete;
+
+    // Move.
+    FbsModel(FbsModel&&);
+    FbsModel& operator=(FbsModel&&);
+
+    /**
+     * Returns the time at which the snapshot was taken.
+     */
+    Time created() const noexcept;
+    /**
+     * Returns true if the snapshot was taken during a clean shutdown.
+     */
+    bool clean() const noexcept;
+
+  protected:
+    bool do_concurrent() const noexcept override;
+
+    void do_read_asset(const ModelCallback<AssetPtr>& cb) const override;
+
+    void do_read_instr(const ModelCallback<InstrPtr>& cb) const override;
+
+    void do_read_market(const ModelCallback<MarketPtr>& cb) const override;
+
+    void do_read_order(const ModelCallback<OrderPtr>& cb) const override;
+
+    void do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const override;
+
+    void do_read_trade(const ModelCallback<ExecPtr>& cb) const override;
+
+    void do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const override;
+
+  private:
+    MMap mem_map_;
+    const fbs::Snapshot* snapshot_;
+};
+
+} // namespace db
+} // namespace swirly
+
+#endif // SWIRLY_DB_FBSMODEL_HPP
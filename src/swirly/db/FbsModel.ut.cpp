@@ -0,0 +1,194 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "FbsModel.hpp"
+
+#include "FbsSnapshot.hpp"
+
+#include <swirly/fin/Asset.hpp>
+#include <swirly/fin/Exception.hpp>
+#include <swirly/fin/Exec.hpp>
+#include <swirly/fin/Instr.hpp>
+#include <swirly/fin/Market.hpp>
+#include <swirly/fin/MarketId.hpp>
+#include <swirly/fin/Order.hpp>
+#include <swirly/fin/Posn.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace swirly;
+
+namespace {
+
+constexpr auto Today = ymd_to_jd(2014, 3, 11);
+constexpr auto SettlDay = Today + 2_jd;
+constexpr auto MarketId = to_market_id(1_id32, SettlDay);
+
+constexpr auto Now = jd_to_time(Today);
+
+struct TempFile {
+    TempFile()
+    {
+        char tmpl[] = "/tmp/swirly-snap.XXXXXX";
+        const int fd{mkstemp(tmpl)};
+        BOOST_REQUIRE(fd >= 0);
+        close(fd);
+        path = tmpl;
+    }
+    ~TempFile() { unlink(path.c_str()); }
+    string path;
+};
+
+ExecPtr make_exec(Id64 id, State state, Lots resd_lots, Lots last_lots, Time created)
+{
+    return make_intrusive<Exec>("MARAYL"sv, MarketId, "EURUSD"sv, SettlDay, id, 1_id64, "apple"sv,
+                                state, Side::Buy, 10_lts, 12345_tks, resd_lots,
+                                10_lts - resd_lots, 0_cst, last_lots,
+                                last_lots > 0_lts ? 12345_tks : 0_tks, 1_lts, 0_id64, 0_lts,
+                                0_cst, LiqInd::None, Symbol{}, created);
+}
+
+template <typename ValueT>
+vector<ValueT> read_all(const Model& model, void (Model::*fn)(const ModelCallback<ValueT>&) const)
+{
+    vector<ValueT> v;
+    (model.*fn)([&v](ValueT ptr) { v.push_back(std::move(ptr)); });
+    return v;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(FbsModelSuite)
+
+BOOST_AUTO_TEST_CASE(FbsModelRoundTripCase)
+{
+    TempFile file;
+    {
+        FbsSnapshot snap;
+        snap.add_asset(Asset{1_id32, "EUR"sv, "Euro Member Countries, Euro"sv, AssetType::Ccy});
+        snap.add_instr(Instr{1_id32, "EURUSD"sv, "EURUSD"sv, "EUR"sv, "USD"sv, 1000000, 1, 1,
+                             10000, 4, 1_lts, 10_lts});
+        snap.add_market(Market{MarketId, "EURUSD"sv, SettlDay, 0x1, 7_lts, 12345_tks, Now, 3_id64});
+        snap.add_order(Order{"MARAYL"sv, MarketId, "EURUSD"sv, SettlDay, 1_id64, "apple"sv,
+                             State::Trade, Side::Buy, 10_lts, 12345_tks, 3_lts, 7_lts, 86415_cst,
+                             7_lts, 12345_tks, 1_lts, Now, Now + 2ms});
+        // Most recent first.
+        const auto trade = make_exec(2_id64, State::Trade, 3_lts, 7_lts, Now + 2ms);
+        snap.add_exec(*trade);
+        snap.add_exec(*make_exec(1_id64, State::New, 10_lts, 0_lts, Now));
+        snap.add_trade(*trade);
+        snap.add_posn(Posn{"MARAYL"sv, MarketId, "EURUSD"sv, SettlDay, 7_lts, 86415_cst, 0_lts,
+                           0_cst});
+        snap.finish(Now + 3ms, true);
+        snap.write(file.path.c_str());
+    }
+    const FbsModel model{file.path.c_str()};
+    BOOST_TEST(model.created() == Now + 3ms);
+    BOOST_TEST(model.clean());
+
+    const auto assets = read_all(model, &Model::read_asset);
+    BOOST_TEST(assets.size() == 1U);
+    BOOST_TEST(assets[0]->symbol() == "EUR"sv);
+    BOOST_TEST(assets[0]->display() == "Euro Member Countries, Euro"sv);
+    BOOST_TEST(assets[0]->type() == AssetType::Ccy);
+
+    const auto instrs = read_all(model, &Model::read_instr);
+    BOOST_TEST(instrs.size() == 1U);
+    BOOST_TEST(instrs[0]->term_ccy() == "USD"sv);
+    BOOST_TEST(instrs[0]->tick_denom() == 10000);
+    BOOST_TEST(instrs[0]->max_lots() == 10_lts);
+
+    const auto markets = read_all(model, &Model::read_market);
+    BOOST_TEST(markets.size() == 1U);
+    BOOST_TEST(markets[0]->id() == MarketId);
+    BOOST_TEST(markets[0]->instr() == "EURUSD"sv);
+    BOOST_TEST(markets[0]->last_time() == Now);
+    BOOST_TEST(markets[0]->max_id() == 3_id64);
+
+    const auto orders = read_all(model, &Model::read_order);
+    BOOST_TEST(orders.size() == 1U);
+    BOOST_TEST(orders[0]->ref() == "apple"sv);
+    BOOST_TEST(orders[0]->resd_lots() == 3_lts);
+    BOOST_TEST(orders[0]->exec_cost() == 86415_cst);
+    BOOST_TEST(orders[0]->modified() == Now + 2ms);
+
+    vector<ExecPtr> execs;
+    model.read_exec(Now, [&execs](auto ptr) { execs.push_back(ptr); });
+    // Only execs created after the cut-off are read.
+    BOOST_TEST(execs.size() == 1U);
+    BOOST_TEST(execs[0]->id() == 2_id64);
+
+    const auto trades = read_all(model, &Model::read_trade);
+    BOOST_TEST(trades.size() == 1U);
+    BOOST_TEST(trades[0]->last_lots() == 7_lts);
+    BOOST_TEST(trades[0]->cpty().empty());
+
+    vector<PosnPtr> posns;
+    model.read_posn(Today, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->market_id() == MarketId);
+    BOOST_TEST(posns[0]->buy_cost() == 86415_cst);
+
+    // Still open on the settlement-day.
+    posns.clear();
+    model.read_posn(SettlDay, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->market_id() == MarketId);
+
+    // Rolled after the settlement-day, as at end of day.
+    posns.clear();
+    model.read_posn(SettlDay + 1_jd, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->market_id() == to_rolled_id(MarketId));
+    BOOST_TEST(posns[0]->settl_day() == 0_jd);
+    BOOST_TEST(posns[0]->buy_cost() == 86415_cst);
+}
+
+BOOST_AUTO_TEST_CASE(FbsModelWideIdCase)
+{
+    // Market ids are 64-bit, so must not be truncated by the snapshot.
+    constexpr auto WideId = Id64{(int64_t{1} << 40) | MarketId.count()};
+    TempFile file;
+    {
+        FbsSnapshot snap;
+        snap.add_market(Market{WideId, "EURUSD"sv, SettlDay, 0x1, 0_lts, 0_tks, {}, 0_id64});
+        snap.add_posn(Posn{"MARAYL"sv, WideId, "EURUSD"sv, SettlDay, 7_lts, 86415_cst, 0_lts,
+                           0_cst});
+        snap.finish(Now);
+        snap.write(file.path.c_str());
+    }
+    const FbsModel model{file.path.c_str()};
+
+    const auto markets = read_all(model, &Model::read_market);
+    BOOST_TEST(markets.size() == 1U);
+    BOOST_TEST(markets[0]->id() == WideId);
+
+    vector<PosnPtr> posns;
+    model.read_posn(Today, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->market_id() == WideId);
+}
+
+BOOST_AUTO_TEST_CASE(FbsModelInvalidCase)
+{
+    TempFile file;
+    BOOST_CHECK_THROW(FbsModel{file.path.c_str()}, DatabaseException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,200 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "FbsSnapshot.hpp"
+
+#include <swirly/fin/Asset.hpp>
+#include <swirly/fin/Exec.hpp>
+#include <swirly/fin/Instr.hpp>
+#include <swirly/fin/Market.hpp>
+#include <swirly/fin/Order.hpp>
+#include <swirly/fin/Posn.hpp>
+
+#include <swirly/fbs/Snapshot_generated.h>
+
+#include <swirly/sys/File.hpp>
+
+#include <libgen.h>
+
+namespace swirly {
+inline namespace db {
+using namespace std;
+namespace {
+
+using flatbuffers::FlatBufferBuilder;
+using flatbuffers::Offset;
+using flatbuffers::String;
+
+// Initial capacity of the builder.
+constexpr size_t InitialSize{1 << 20};
+
+void sync_parent_dir(const char* path)
+{
+    string buf{path};
+    FileHandle fh{os::open(dirname(&buf[0]), O_RDONLY | O_DIRECTORY)};
+    os::fsync(fh.get());
+}
+
+} // namespace
+
+struct FbsSnapshot::Impl {
+    Offset<String> create_string(string_view val)
+    {
+        return fbb.CreateString(val.data(), val.size());
+    }
+    // Optional strings are omitted when empty.
+    Offset<String> create_opt_string(string_view val)
+    {
+        return val.empty() ? Offset<String>{} : create_string(val);
+    }
+    Offset<fbs::Exec> create_exec(const Exec& exec)
+    {
+        return fbs::CreateExec(
+            fbb, create_string(+exec.accnt()), exec.market_id().count(),
+            create_string(+exec.instr()), exec.settl_day().count(), exec.id().count(),
+            exec.order_id().count(), create_opt_string(exec.ref()), exec.state(), exec.side(),
+            exec.lots().count(), exec.ticks().count(), exec.resd_lots().count(),
+            exec.exec_lots().count(), exec.exec_cost().count(), exec.last_lots().count(),
+            exec.last_ticks().count(), exec.min_lots().count(), exec.match_id().count(),
+            exec.posn_lots().count(), exec.posn_cost().count(), exec.liq_ind(),
+            create_opt_string(+exec.cpty()), ms_since_epoch(exec.created()));
+    }
+    FlatBufferBuilder fbb{InitialSize};
+    vector<Offset<fbs::Asset>> assets;
+    vector<Offset<fbs::Instr>> instrs;
+    vector<Offset<fbs::Market>> markets;
+    vector<Offset<fbs::Order>> orders;
+    vector<Offset<fbs::Exec>> execs;
+    vector<Offset<fbs::Exec>> trades;
+    vector<Offset<fbs::Posn>> posns;
+};
+
+FbsSnapshot::FbsSnapshot()
+: impl_{make_unique<Impl>()}
+{
+}
+
+FbsSnapshot::~FbsSnapshot() = default;
+
+FbsSnapshot::FbsSnapshot(FbsSnapshot&&) = default;
+
+FbsSnapshot& FbsSnapshot::operator=(FbsSnapshot&&) = default;
+
+void FbsSnapshot::add_asset(const Asset& asset)
+{
+    auto& impl = *impl_;
+    impl.assets.push_back(fbs::CreateAsset(impl.fbb, asset.id().count(),
+                                           impl.create_string(+asset.symbol()),
+                                           impl.create_string(asset.display()), asset.type()));
+}
+
+void FbsSnapshot::add_instr(const Instr& instr)
+{
+    auto& impl = *impl_;
+    impl.instrs.push_back(fbs::CreateInstr(
+        impl.fbb, instr.id().count(), impl.create_string(+instr.symbol()),
+        impl.create_string(instr.display()), impl.create_string(+instr.base_asset()),
+        impl.create_string(+instr.term_ccy()), instr.lot_numer(), instr.lot_denom(),
+        instr.tick_numer(), instr.tick_denom(), instr.pip_dp(), instr.min_lots().count(),
+        instr.max_lots().count()));
+}
+
+void FbsSnapshot::add_market(const Market& market)
+{
+    auto& impl = *impl_;
+    impl.markets.push_back(fbs::CreateMarket(
+        impl.fbb, market.id().count(), impl.create_string(+market.instr()),
+        market.settl_day().count(), market.state(), market.last_lots().count(),
+        market.last_ticks().count(), ms_since_epoch(market.last_time()),
+        market.max_id().count()));
+}
+
+void FbsSnapshot::add_order(const Order& order)
+{
+    auto& impl = *impl_;
+    impl.orders.push_back(fbs::CreateOrder(
+        impl.fbb, impl.create_string(+order.accnt()), order.market_id().count(),
+        impl.create_string(+order.instr()), order.settl_day().count(), order.id().count(),
+        impl.create_opt_string(order.ref()), order.state(), order.side(), order.lots().count(),
+        order.ticks().count(), order.resd_lots().count(), order.exec_lots().count(),
+        order.exec_cost().count(), order.last_lots().count(), order.last_ticks().count(),
+        order.min_lots().count(), ms_since_epoch(order.created()),
+        ms_since_epoch(order.modified())));
+}
+
+void FbsSnapshot::add_exec(const Exec& exec)
+{
+    impl_->execs.push_back(impl_->create_exec(exec));
+}
+
+void FbsSnapshot::add_trade(const Exec& trade)
+{
+    impl_->trades.push_back(impl_->create_exec(trade));
+}
+
+void FbsSnapshot::add_posn(const Posn& posn)
+{
+    auto& impl = *impl_;
+    impl.posns.push_back(fbs::CreatePosn(
+        impl.fbb, impl.create_string(+posn.accnt()), posn.market_id().count(),
+        impl.create_string(+posn.instr()), posn.settl_day().count(), posn.buy_lots().count(),
+        posn.buy_cost().count(), posn.sell_lots().count(), posn.sell_cost().count()));
+}
+
+void FbsSnapshot::finish(Time created, bool clean)
+{
+    auto& impl = *impl_;
+    auto& fbb = impl.fbb;
+    const auto root = fbs::CreateSnapshot(
+        fbb, ms_since_epoch(created), clean, fbb.CreateVector(impl.assets),
+        fbb.CreateVector(impl.instrs), fbb.CreateVector(impl.markets),
+        fbb.CreateVector(impl.orders), fbb.CreateVector(impl.execs), fbb.CreateVector(impl.trades),
+        fbb.CreateVector(impl.posns));
+    fbs::FinishSnapshotBuffer(fbb, root);
+}
+
+const void* FbsSnapshot::data() const noexcept
+{
+    return impl_->fbb.GetBufferPointer();
+}
+
+size_t FbsSnapshot::size() const noexcept
+{
+    return impl_->fbb.GetSize();
+}
+
+void FbsSnapshot::write(const char* path) const
+{
+    const string tmp_path{string{path} + ".tmp"};
+    {
+        FileHandle fh{os::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+        const auto* buf = static_cast<const char*>(data());
+        auto len = size();
+        while (len > 0) {
+            const auto n = os::write(fh.get(), buf, len);
+            buf += n;
+            len -= n;
+        }
+        os::fsync(fh.get());
+    }
+    if (rename(tmp_path.c_str(), path) < 0) {
+        throw system_error{os::make_error(errno), "rename"};
+    }
+    sync_parent_dir(path);
+}
+
+} // namespace db
+} // namespace swirly
@@ -0,0 +1,106 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_DB_FBSSNAPSHOT_HPP
+#define SWIRLY_DB_FBSSNAPSHOT_HPP
+
+#include <swirly/util/Time.hpp>
+
+#include <swirly/Config.h>
+
+#include <memory>
+
+namespace swirly {
+inline namespace fin {
+class Asset;
+class Exec;
+class Instr;
+class Market;
+class Order;
+class Posn;
+} // namespace fin
+inline namespace db {
+
+/**
+ * Builder for a snapshot of the engine's state. The snapshot is encoded as a flatbuffer, so that
+ * FbsModel can read it in place from a memory-mapped file.
+ */
+class SWIRLY_API FbsSnapshot {
+  public:
+    FbsSnapshot();
+    ~FbsSnapshot();
+
+    // Copy.
+    FbsSnapshot(const FbsSnapshot&) = delete;
+    FbsSnapshot& operator=(const FbsSnapshot&) = delete;
+
+    // Move.
+    FbsSnapshot(FbsSnapshot&&);
+    FbsSnapshot& operator=(FbsSnapshot&&);
+
+    void add_asset(const Asset& asset);
+
+    void add_instr(const Instr& instr);
+
+    void add_market(const Market& market);
+
+    void add_order(const Order& order);
+
+    /**
+     * Add a recent exec. Execs should be added most recent first.
+     */
+    void add_exec(const Exec& exec);
+
+    /**
+     * Add a trade that has yet to be archived.
+     */
+    void add_trade(const Exec& trade);
+
+    void add_posn(const Posn& posn);
+
+    /**
+     * Finish the snapshot, after which no further objects may be added.
+     *
+     * @param created
+     *            The time at which the snapshot was taken.
+     * @param clean
+     *            True if the snapshot was taken during a clean shutdown.
+     */
+    void finish(Time created, bool clean = false);
+
+    /**
+     * Returns the encoded snapshot, which is only valid once the snapshot has been finished.
+     */
+    const void* data() const noexcept;
+
+    std::size_t size() const noexcept;
+
+    /**
+     * Write the finished snapshot to a file. The snapshot is written to a temporary file, which
+     * is synced and then renamed, so that the file is always either the previous snapshot or the
+     * new one.
+     */
+    void write(const char* path) const;
+
+  private:
+    struct Impl;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace db
+} // namespace swirly
+
+#endif // SWIRLY_DB_FBSSNAPSHOT_HPP
@@ -24,6 +24,8 @@
 #include <swirly/util/Log.hpp>
 #include <swirly/util/String.hpp>
 
+#include <deque>
+
 namespace swirly {
 inline namespace db {
 using namespace mysql;
@@ -32,15 +34,78 @@ namespace {
 constexpr auto BeginSql = "START TRANSACTION"sv;
 constexpr auto CommitSql = "COMMIT"sv;
 constexpr auto RollbackSql = "ROLLBACK"sv;
+
+// Number of parameters in each row of the exec insert statement.
+constexpr size_t ExecCols{exec::Created + 1};
+
+/**
+ * Parameters for a single row of the exec insert statement.
+ */
+struct ExecRow {
+    ExecRow(MYSQL_BIND* bind, const CreateExec& body) noexcept
+    : market_id{bind[exec::MarketId], body.market_id}
+    , settl_day{bind[exec::SettlDay], body.settl_day, MaybeNull}
+    , id{bind[exec::Id], body.id}
+    , order_id{bind[exec::OrderId], body.order_id, MaybeNull}
+    , state{bind[exec::State], unbox(body.state)}
+    , side{bind[exec::Side], unbox(body.side)}
+    , lots{bind[exec::Lots], body.lots}
+    , ticks{bind[exec::Ticks], body.ticks}
+    , resd_lots{bind[exec::ResdLots], body.resd_lots}
+    , exec_lots{bind[exec::ExecLots], body.exec_lots}
+    , exec_cost{bind[exec::ExecCost], body.exec_cost}
+    , last_lots{bind[exec::LastLots], body.last_lots}
+    , last_ticks{bind[exec::LastTicks], body.last_ticks}
+    , min_lots{bind[exec::MinLots], body.min_lots}
+    , match_id{bind[exec::MatchId], body.match_id, MaybeNull}
+    , posn_lots{bind[exec::PosnLots], body.posn_lots}
+    , posn_cost{bind[exec::PosnCost], body.posn_cost}
+    , liq_ind{bind[exec::LiqInd], unbox(body.liq_ind), MaybeNull}
+    , created{bind[exec::Created], body.created}
+    {
+        field::Symbol::bind(bind[exec::Accnt], body.accnt);
+        field::Symbol::bind(bind[exec::Instr], body.instr);
+        field::Symbol::bind(bind[exec::Ref], body.ref, MaybeNull);
+        field::Symbol::bind(bind[exec::Cpty], body.cpty, MaybeNull);
+        if (body.last_lots == 0_lts) {
+            last_lots.set_null();
+            last_ticks.set_null();
+        }
+    }
+    field::Id64 market_id;
+    field::JDay settl_day;
+    field::Id64 id;
+    field::Id64 order_id;
+    field::State state;
+    field::Side side;
+    field::Lots lots;
+    field::Ticks ticks;
+    field::Lots resd_lots;
+    field::Lots exec_lots;
+    field::Cost exec_cost;
+    field::Lots last_lots;
+    field::Ticks last_ticks;
+    field::Lots min_lots;
+    field::MatchId match_id;
+    field::Lots posn_lots;
+    field::Cost posn_cost;
+    field::LiqInd liq_ind;
+    field::Time created;
+};
 } // namespace
 
-MySqlJourn::MySqlJourn(const DbPtr& db)
+MySqlJourn::MySqlJourn(const DbPtr& db, size_t batch_size)
 : db_{db}
+, batch_size_{clamp_batch_size(batch_size, ExecCols)}
 , insert_market_stmt_{prepare(*db, market::InsertSql)}
 , update_market_stmt_{prepare(*db, market::UpdateSql)}
-, insert_exec_stmt_{prepare(*db, exec::InsertSql)}
-, update_exec_stmt_{prepare(*db, exec::UpdateSql)}
+, update_exec_stmt_{prepare(*db, string{exec::UpdateInSql} + param_list(MaxIds))}
 {
+    insert_exec_stmts_.reserve(batch_size_);
+    for (size_t i{0}; i < batch_size_; ++i) {
+        insert_exec_stmts_.emplace_back(nullptr, mysql_stmt_close);
+    }
+    execs_.reserve(batch_size_);
 }
 
 MySqlJourn::MySqlJourn(const Config& config)
@@ -49,7 +114,8 @@ MySqlJourn::MySqlJourn(const Config& config)
                      config.get("db_pass", ""),             //
                      config.get("db_name", "swirlydb"),     //
                      config.get<unsigned>("db_port", 3306), //
-                     config)}
+                     config),
+             config.get<size_t>("journ_batch_size", DefaultBatchSize)}
 {
 }
 
@@ -65,11 +131,13 @@ void MySqlJourn::do_begin()
 
 void MySqlJourn::do_commit()
 {
+    flush();
     query(*db_, CommitSql);
 }
 
 void MySqlJourn::do_rollback() noexcept
 {
+    execs_.clear();
     try {
         query(*db_, RollbackSql);
     } catch (const std::exception& e) {
@@ -82,8 +150,28 @@ void MySqlJourn::do_write(const Msg& msg)
     dispatch(msg);
 }
 
+void MySqlJourn::do_read_max_id(const function<void(Id64, Id64)>& cb) const
+{
+    using namespace max_id;
+
+    auto stmt = prepare(*db_, SelectSql);
+    execute(*stmt);
+    auto res = result_metadata(*stmt);
+
+    BindArray<2> result;
+    field::Id64 market_id{result[MarketId]};
+    field::Id64 max_id{result[MaxId]};
+
+    bind_result(*stmt, &result[0]);
+    while (fetch(*stmt)) {
+        cb(Id64{market_id.value()}, Id64{max_id.value()});
+    }
+}
+
 void MySqlJourn::on_create_market(const CreateMarket& body)
 {
+    // Buffered execs are inserted first, so that statements are executed in message order.
+    flush();
     auto& stmt = *insert_market_stmt_;
 
     BindArray<4> param;
@@ -99,6 +187,7 @@ void MySqlJourn::on_create_market(const CreateMarket& body)
 
 void MySqlJourn::on_update_market(const UpdateMarket& body)
 {
+    flush();
     auto& stmt = *update_market_stmt_;
 
     BindArray<2> param;
@@ -112,65 +201,59 @@ void MySqlJourn::on_update_market(const UpdateMarket& body)
 
 void MySqlJourn::on_create_exec(const CreateExec& body)
 {
-    auto& stmt = *insert_exec_stmt_;
-
-    BindArray<23> param;
-    auto pit = param.begin();
-    field::Symbol::bind(*pit++, body.accnt);
-    field::Id64 market_id{*pit++, body.market_id};
-    field::Symbol::bind(*pit++, body.instr);
-    field::JDay settl_day{*pit++, body.settl_day, MaybeNull};
-    field::Id64 id{*pit++, body.id};
-    field::Id64 order_id{*pit++, body.order_id, MaybeNull};
-    field::Symbol::bind(*pit++, body.ref, MaybeNull);
-    field::State state{*pit++, unbox(body.state)};
-    field::Side side{*pit++, unbox(body.side)};
-    field::Lots lots{*pit++, body.lots};
-    field::Ticks ticks{*pit++, body.ticks};
-    field::Lots resd_lots{*pit++, body.resd_lots};
-    field::Lots exec_lots{*pit++, body.exec_lots};
-    field::Cost exec_cost{*pit++, body.exec_cost};
-    field::Lots last_lots{*pit++, body.last_lots};
-    field::Ticks last_ticks{*pit++, body.last_ticks};
-    if (body.last_lots == 0_lts) {
-        last_lots.set_null();
-        last_ticks.set_null();
+    execs_.push_back(body);
+    if (execs_.size() >= batch_size_) {
+        flush();
     }
-    field::Lots min_lots{*pit++, body.min_lots};
-    field::MatchId match_id{*pit++, body.match_id, MaybeNull};
-    field::Lots posn_lots{*pit++, body.posn_lots};
-    field::Cost posn_cost{*pit++, body.posn_cost};
-    field::LiqInd liq_ind{*pit++, unbox(body.liq_ind), MaybeNull};
-    field::Symbol::bind(*pit++, body.cpty, MaybeNull);
-    field::Time created{*pit++, body.created};
-    bind_param(stmt, &param[0]);
-
-    execute(stmt);
-    SWIRLY_DEBUG << "affected rows: " << affected_rows(stmt);
 }
 
 void MySqlJourn::on_archive_trade(const ArchiveTrade& body)
 {
-    Transaction trans{*this};
+    // A single statement serves any number of ids, because unused slots repeat the first id.
+    Id64 vals[MaxIds];
+    if (pad_ids(body.ids, vals) == 0) {
+        return;
+    }
+    // The trades may still be buffered.
+    flush();
     auto& stmt = *update_exec_stmt_;
 
-    BindArray<3> param;
+    BindArray<2 + MaxIds> param;
     auto pit = param.begin();
     field::Time archive{*pit++, body.modified};
     field::Id64 market_id{*pit++, body.market_id};
-    field::Id64 id{*pit++};
+    deque<field::Id64> ids;
+    for (const auto val : vals) {
+        ids.emplace_back(*pit++, val);
+    }
     bind_param(stmt, &param[0]);
 
-    for (size_t i{0}; i < MaxIds; ++i) {
-        const auto val = body.ids[i];
-        if (val == 0_id64) {
-            break;
-        }
+    execute(stmt);
+    SWIRLY_DEBUG << "affected rows: " << affected_rows(stmt);
+}
 
-        id.set_value(val);
-        execute(stmt);
+void MySqlJourn::flush()
+{
+    const auto n = execs_.size();
+    if (n == 0) {
+        return;
     }
-    trans.commit();
+    auto& stmt_ptr = insert_exec_stmts_[n - 1];
+    if (!stmt_ptr) {
+        stmt_ptr = prepare(*db_, multi_row_sql(exec::InsertSql, n));
+    }
+    auto& stmt = *stmt_ptr;
+
+    vector<MYSQL_BIND> param(n * ExecCols);
+    deque<ExecRow> rows;
+    for (size_t i{0}; i < n; ++i) {
+        rows.emplace_back(&param[i * ExecCols], execs_[i]);
+    }
+    bind_param(stmt, param.data());
+
+    execute(stmt);
+    SWIRLY_DEBUG << "affected rows: " << affected_rows(stmt);
+    execs_.clear();
 }
 
 } // namespace db
@@ -20,8 +20,11 @@
 #include <swirly/db/Types.hpp>
 
 #include <swirly/fin/Journ.hpp>
+#include <swirly/fin/Msg.hpp>
 #include <swirly/fin/MsgHandler.hpp>
 
+#include <vector>
+
 namespace swirly {
 inline namespace db {
 
@@ -32,7 +35,13 @@ class SWIRLY_API MySqlJourn
     friend struct BasicMsgHandler<MySqlJourn>;
 
   public:
-    explicit MySqlJourn(const mysql::DbPtr& db);
+    /**
+     * Execs are buffered within a transaction, and inserted batch_size rows at a time with a
+     * single multi-row INSERT statement.
+     */
+    static constexpr std::size_t DefaultBatchSize{64};
+
+    explicit MySqlJourn(const mysql::DbPtr& db, std::size_t batch_size = DefaultBatchSize);
     explicit MySqlJourn(const Config& config);
     ~MySqlJourn() override;
 
@@ -53,6 +62,8 @@ class SWIRLY_API MySqlJourn
 
     void do_write(const Msg& msg) override;
 
+    void do_read_max_id(const std::function<void(Id64, Id64)>& cb) const override;
+
   private:
     void on_create_market(const CreateMarket& body);
 
@@ -62,11 +73,20 @@ class SWIRLY_API MySqlJourn
 
     void on_archive_trade(const ArchiveTrade& body);
 
+    /**
+     * Insert the buffered execs.
+     */
+    void flush();
+
     mysql::DbPtr db_;
+    std::size_t batch_size_;
     mysql::StmtPtr insert_market_stmt_;
     mysql::StmtPtr update_market_stmt_;
-    mysql::StmtPtr insert_exec_stmt_;
+    // Multi-row insert statements, indexed by the number of rows less one, which are prepared on
+    // first use.
+    std::vector<mysql::StmtPtr> insert_exec_stmts_;
     mysql::StmtPtr update_exec_stmt_;
+    std::vector<CreateExec> execs_;
 };
 
 } // namespace db
@@ -23,6 +23,7 @@
 #include <swirly/fin/Exec.hpp>
 #include <swirly/fin/Instr.hpp>
 #include <swirly/fin/Market.hpp>
+#include <swirly/fin/MarketId.hpp>
 
 #include <swirly/fin/Order.hpp>
 #include <swirly/fin/Posn.hpp>
@@ -32,6 +33,70 @@ inline namespace db {
 using namespace mysql;
 using namespace std;
 
+namespace {
+
+void fetch_exec(MYSQL_STMT& stmt, const ModelCallback<ExecPtr>& cb)
+{
+    using namespace exec;
+
+    execute(stmt);
+    auto res = result_metadata(stmt);
+
+    BindArray<23> result;
+    field::Symbol accnt{result[Accnt]};
+    field::Id64 market_id{result[MarketId]};
+    field::Symbol instr{result[Instr]};
+    field::JDay settl_day{result[SettlDay]};
+    field::Id64 id{result[Id]};
+    field::Id64 order_id{result[OrderId]};
+    field::Ref ref{result[Ref]};
+    field::State state{result[State]};
+    field::Side side{result[Side]};
+    field::Lots lots{result[Lots]};
+    field::Ticks ticks{result[Ticks]};
+    field::Lots resd_lots{result[ResdLots]};
+    field::Lots exec_lots{result[ExecLots]};
+    field::Cost exec_cost{result[ExecCost]};
+    field::Lots last_lots{result[LastLots]};
+    field::Ticks last_ticks{result[LastTicks]};
+    field::Lots min_lots{result[MinLots]};
+    field::Id64 match_id{result[MatchId]};
+    field::Lots posn_lots{result[PosnLots]};
+    field::Cost posn_cost{result[PosnCost]};
+    field::LiqInd liq_ind{result[LiqInd]};
+    field::Symbol cpty{result[Cpty]};
+    field::Time created{result[Created]};
+
+    bind_result(stmt, &result[0]);
+    while (fetch(stmt)) {
+        cb(Exec::make(accnt.value(),                     //
+                      Id64{market_id.value()},           //
+                      instr.value(),                     //
+                      JDay{settl_day.value()},           //
+                      Id64{id.value()},                  //
+                      Id64{order_id.value()},            //
+                      ref.value(),                       //
+                      swirly::State{state.value()},      //
+                      swirly::Side{side.value()},        //
+                      swirly::Lots{lots.value()},        //
+                      swirly::Ticks{ticks.value()},      //
+                      swirly::Lots{resd_lots.value()},   //
+                      swirly::Lots{exec_lots.value()},   //
+                      swirly::Cost{exec_cost.value()},   //
+                      swirly::Lots{last_lots.value()},   //
+                      swirly::Ticks{last_ticks.value()}, //
+                      swirly::Lots{min_lots.value()},    //
+                      Id64{match_id.value()},            //
+                      swirly::Lots{posn_lots.value()},   //
+                      swirly::Cost{posn_cost.value()},   //
+                      swirly::LiqInd{liq_ind.value()},   //
+                      cpty.value(),                      //
+                      to_time(Millis{created.value()})));
+    }
+}
+
+} // namespace
+
 MySqlModel::MySqlModel(const DbPtr& db)
 : db_{db}
 {
@@ -202,60 +267,24 @@ void MySqlModel::do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) cons
     field::Time created_param{*pit++, ms_since_epoch(since)};
     bind_param(*stmt, &param[0]);
 
-    execute(*stmt);
-    auto res = result_metadata(*stmt);
+    fetch_exec(*stmt, cb);
+}
 
-    BindArray<23> result;
-    field::Symbol accnt{result[Accnt]};
-    field::Id64 market_id{result[MarketId]};
-    field::Symbol instr{result[Instr]};
-    field::JDay settl_day{result[SettlDay]};
-    field::Id64 id{result[Id]};
-    field::Id64 order_id{result[OrderId]};
-    field::Ref ref{result[Ref]};
-    field::State state{result[State]};
-    field::Side side{result[Side]};
-    field::Lots lots{result[Lots]};
-    field::Ticks ticks{result[Ticks]};
-    field::Lots resd_lots{result[ResdLots]};
-    field::Lots exec_lots{result[ExecLots]};
-    field::Cost exec_cost{result[ExecCost]};
-    field::Lots last_lots{result[LastLots]};
-    field::Ticks last_ticks{result[LastTicks]};
-    field::Lots min_lots{result[MinLots]};
-    field::Id64 match_id{result[MatchId]};
-    field::Lots posn_lots{result[PosnLots]};
-    field::Cost posn_cost{result[PosnCost]};
-    field::LiqInd liq_ind{result[LiqInd]};
-    field::Symbol cpty{result[Cpty]};
-    field::Time created{result[Created]};
+void MySqlModel::do_read_accnt_exec(Symbol accnt, Time since, size_t limit,
+                                    const ModelCallback<ExecPtr>& cb) const
+{
+    using namespace exec;
 
-    bind_result(*stmt, &result[0]);
-    while (fetch(*stmt)) {
-        cb(Exec::make(accnt.value(),                     //
-                      Id64{market_id.value()},           //
-                      instr.value(),                     //
-                      JDay{settl_day.value()},           //
-                      Id64{id.value()},                  //
-                      Id64{order_id.value()},            //
-                      ref.value(),                       //
-                      swirly::State{state.value()},      //
-                      swirly::Side{side.value()},        //
-                      swirly::Lots{lots.value()},        //
-                      swirly::Ticks{ticks.value()},      //
-                      swirly::Lots{resd_lots.value()},   //
-                      swirly::Lots{exec_lots.value()},   //
-                      swirly::Cost{exec_cost.value()},   //
-                      swirly::Lots{last_lots.value()},   //
-                      swirly::Ticks{last_ticks.value()}, //
-                      swirly::Lots{min_lots.value()},    //
-                      Id64{match_id.value()},            //
-                      swirly::Lots{posn_lots.value()},   //
-                      swirly::Cost{posn_cost.value()},   //
-                      swirly::LiqInd{liq_ind.value()},   //
-                      cpty.value(),                      //
-                      to_time(Millis{created.value()})));
-    }
+    auto stmt = prepare(*db_, SelectAccntSql);
+
+    BindArray<3> param;
+    auto pit = param.begin();
+    field::Symbol::bind(*pit++, string_view{accnt.data(), accnt.size()});
+    field::Time created_param{*pit++, ms_since_epoch(since)};
+    DbField<DbType::BigInt> limit_param{*pit++, static_cast<int64_t>(limit)};
+    bind_param(*stmt, &param[0]);
+
+    fetch_exec(*stmt, cb);
 }
 
 void MySqlModel::do_read_trade(const ModelCallback<ExecPtr>& cb) const
@@ -345,9 +374,9 @@ void MySqlModel::do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) co
         const auto instr = instr_field.value();
         auto settl_day = JDay{settl_day_field.value()};
 
-        // FIXME: review when end of day is implemented.
-        if (settl_day != 0_jd && settl_day <= bus_day) {
-            market_id &= Id64{~0xffff};
+        // Rolled with the same cutoff as end of day.
+        if (is_settled(settl_day, bus_day)) {
+            market_id = to_rolled_id(market_id);
             settl_day = 0_jd;
         }
 
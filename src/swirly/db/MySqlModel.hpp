@@ -49,6 +49,9 @@ class SWIRLY_API MySqlModel : public Model {
 
     void do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const override;
 
+    void do_read_accnt_exec(Symbol accnt, Time since, std::size_t limit,
+                            const ModelCallback<ExecPtr>& cb) const override;
+
     void do_read_trade(const ModelCallback<ExecPtr>& cb) const override;
 
     void do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const override;
@@ -0,0 +1,327 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "ReplayModel.hpp"
+
+#include "Bin.hxx"
+
+#include <swirly/fin/Exec.hpp>
+#include <swirly/fin/Market.hpp>
+#include <swirly/fin/MarketId.hpp>
+#include <swirly/fin/MsgHandler.hpp>
+#include <swirly/fin/Order.hpp>
+#include <swirly/fin/Posn.hpp>
+
+#include <swirly/util/Log.hpp>
+#include <swirly/util/String.hpp>
+
+#include <map>
+#include <mutex>
+
+namespace swirly {
+inline namespace db {
+using namespace std;
+namespace {
+
+using Key = pair<Id64, Id64>;
+
+struct MarketRec {
+    Symbol instr;
+    JDay settl_day;
+    MarketState state;
+    Lots last_lots;
+    Ticks last_ticks;
+    Time last_time;
+    // Highest id applied so far, either from the snapshot or from the tail.
+    Id64 max_id;
+    // Execs up to and including this id are reflected in the snapshot.
+    Id64 snap_id;
+};
+
+Time ms_to_time(int64_t ms) noexcept
+{
+    return to_time(Millis{ms});
+}
+
+ExecPtr make_exec(const CreateExec& body)
+{
+    return Exec::make(Symbol{to_string_view(body.accnt)}, body.market_id,
+                      Symbol{to_string_view(body.instr)}, body.settl_day, body.id, body.order_id,
+                      to_string_view(body.ref), body.state, body.side, body.lots, body.ticks,
+                      body.resd_lots, body.exec_lots, body.exec_cost, body.last_lots,
+                      body.last_ticks, body.min_lots, body.match_id, body.posn_lots,
+                      body.posn_cost, body.liq_ind, Symbol{to_string_view(body.cpty)},
+                      ms_to_time(body.created));
+}
+
+OrderPtr make_order(const CreateExec& body, Time created)
+{
+    return Order::make(Symbol{to_string_view(body.accnt)}, body.market_id,
+                       Symbol{to_string_view(body.instr)}, body.settl_day, body.order_id,
+                       to_string_view(body.ref), body.state, body.side, body.lots, body.ticks,
+                       body.resd_lots, body.exec_lots, body.exec_cost, body.last_lots,
+                       body.last_ticks, body.min_lots, created, ms_to_time(body.created));
+}
+
+} // namespace
+
+/**
+ * Applies journalled messages to the state restored from the snapshot.
+ */
+struct ReplayModel::Impl : BasicMsgHandler<Impl> {
+    explicit Impl(const char* dir)
+    : dir{dir}
+    {
+    }
+    void load(const Model& snap_model)
+    {
+        snap_model.read_market([this](MarketPtr ptr) {
+            markets.emplace(ptr->id(),
+                            MarketRec{ptr->instr(), ptr->settl_day(), ptr->state(),
+                                      ptr->last_lots(), ptr->last_ticks(), ptr->last_time(),
+                                      ptr->max_id(), ptr->max_id()});
+        });
+        snap_model.read_order(
+            [this](OrderPtr ptr) { orders.emplace(Key{ptr->market_id(), ptr->id()}, ptr); });
+        // Most recent first.
+        snap_model.read_exec(Time{}, [this](ExecPtr ptr) { execs.push_back(ptr); });
+        reverse(execs.begin(), execs.end());
+        snap_model.read_trade(
+            [this](ExecPtr ptr) { trades.emplace(Key{ptr->market_id(), ptr->id()}, ptr); });
+
+        const auto seqs = bin::seg_list(dir);
+        auto first = seqs.size();
+        while (first > 0) {
+            --first;
+            bool found{false};
+            bin::scan(dir, {seqs[first]}, [this, &found](const char* buf) {
+                Msg msg;
+                decode_msg(buf, msg);
+                if (msg.type == MsgType::CreateExec && reflected(msg.create_exec)) {
+                    found = true;
+                }
+            });
+            if (found) {
+                break;
+            }
+        }
+        bin::scan(dir, {seqs.begin() + first, seqs.end()}, [this](const char* buf) {
+            Msg msg;
+            decode_msg(buf, msg);
+            dispatch(msg);
+        });
+        SWIRLY_INFO << "replayed " << replayed << " of " << replayed + skipped << " execs from "
+                    << seqs.size() - first << " of " << seqs.size() << " segments";
+    }
+    bool reflected(const CreateExec& body) const noexcept
+    {
+        const auto it = markets.find(body.market_id);
+        return it != markets.end() && body.id <= it->second.snap_id;
+    }
+    /**
+     * Returns true if the exec is reflected in the snapshot, or has already been applied from the
+     * tail. Ids increase within a market in journal order, so any exec that is journalled more than
+     * once, for example when unjournalled messages are recovered after a crash, is skipped.
+     */
+    bool applied(const CreateExec& body) const noexcept
+    {
+        const auto it = markets.find(body.market_id);
+        return it != markets.end() && body.id <= it->second.max_id;
+    }
+    void on_create_market(const CreateMarket& body)
+    {
+        markets.emplace(body.id, MarketRec{Symbol{to_string_view(body.instr)}, body.settl_day,
+                                           body.state, 0_lts, 0_tks, Time{}, 0_id64, 0_id64});
+    }
+    void on_update_market(const UpdateMarket& body)
+    {
+        // Market updates are not sequenced, but the last update in the tail is also the most
+        // recent, so re-applying earlier updates is harmless.
+        const auto it = markets.find(body.id);
+        if (it != markets.end()) {
+            it->second.state = body.state;
+        }
+    }
+    void on_create_exec(const CreateExec& body)
+    {
+        if (applied(body)) {
+            ++skipped;
+            return;
+        }
+        ++replayed;
+        const auto exec = make_exec(body);
+        execs.push_back(exec);
+        const auto it = markets.find(body.market_id);
+        if (it != markets.end()) {
+            auto& market = it->second;
+            market.max_id = max<Id64>(market.max_id, body.id);
+            if (body.state == State::Trade) {
+                market.last_lots = body.last_lots;
+                market.last_ticks = body.last_ticks;
+                market.last_time = exec->created();
+            }
+        }
+        if (body.order_id != 0_id64) {
+            const Key key{body.market_id, body.order_id};
+            if (body.state == State::New) {
+                orders[key] = make_order(body, exec->created());
+            } else {
+                const auto it = orders.find(key);
+                if (it != orders.end()) {
+                    if (body.resd_lots > 0_lts) {
+                        it->second = make_order(body, it->second->created());
+                    } else {
+                        orders.erase(it);
+                    }
+                }
+            }
+        }
+        if (body.state == State::Trade) {
+            // Reference counts are not atomic, so trades are separate from execs.
+            const auto trade = make_exec(body);
+            trades.emplace(Key{body.market_id, body.id}, trade);
+            tail_trades.push_back(trade);
+        }
+    }
+    void on_archive_trade(const ArchiveTrade& body)
+    {
+        for (size_t i{0}; i < MaxIds; ++i) {
+            const auto id = body.ids[i];
+            if (id == 0_id64) {
+                break;
+            }
+            trades.erase(Key{body.market_id, id});
+        }
+    }
+    string dir;
+    map<Id64, MarketRec> markets;
+    map<Key, OrderPtr> orders;
+    // Oldest first.
+    vector<ExecPtr> execs;
+    map<Key, ExecPtr> trades;
+    // Trades that are not reflected in the snapshot's positions.
+    vector<ExecPtr> tail_trades;
+    size_t replayed{0};
+    size_t skipped{0};
+    once_flag loaded;
+};
+
+ReplayModel::ReplayModel(const char* dir, const Model& ref_model, const Model& snap_model)
+: ref_model_{&ref_model}
+, snap_model_{&snap_model}
+, impl_{make_unique<Impl>(dir)}
+{
+}
+
+ReplayModel::~ReplayModel() = default;
+
+ReplayModel::ReplayModel(ReplayModel&&) = default;
+
+ReplayModel& ReplayModel::operator=(ReplayModel&&) = default;
+
+const ReplayModel::Impl& ReplayModel::impl() const
+{
+    // As with BinModel, the journal is replayed on first read, so that the model also reflects
+    // anything journalled in between, such as messages recovered from the queue.
+    auto& impl = *impl_;
+    call_once(impl.loaded, [this, &impl]() { impl.load(*snap_model_); });
+    return impl;
+}
+
+bool ReplayModel::do_concurrent() const noexcept
+{
+    // Other than for positions, the snapshot is only read during the guarded replay.
+    return true;
+}
+
+void ReplayModel::do_read_asset(const ModelCallback<AssetPtr>& cb) const
+{
+    ref_model_->read_asset(cb);
+}
+
+void ReplayModel::do_read_instr(const ModelCallback<InstrPtr>& cb) const
+{
+    ref_model_->read_instr(cb);
+}
+
+void ReplayModel::do_read_market(const ModelCallback<MarketPtr>& cb) const
+{
+    for (const auto& [id, rec] : impl().markets) {
+        cb(Market::make(id, rec.instr, rec.settl_day, rec.state, rec.last_lots, rec.last_ticks,
+                        rec.last_time, rec.max_id));
+    }
+}
+
+void ReplayModel::do_read_order(const ModelCallback<OrderPtr>& cb) const
+{
+    // Order-id order is also priority order within each market.
+    for (const auto& [key, order] : impl().orders) {
+        cb(order);
+    }
+}
+
+void ReplayModel::do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const
+{
+    // Most recent first.
+    const auto& execs = impl().execs;
+    for (auto it = execs.rbegin(); it != execs.rend(); ++it) {
+        if ((*it)->created() > since) {
+            cb(*it);
+        }
+    }
+}
+
+void ReplayModel::do_read_trade(const ModelCallback<ExecPtr>& cb) const
+{
+    for (const auto& [key, trade] : impl().trades) {
+        cb(trade);
+    }
+}
+
+void ReplayModel::do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const
+{
+    const auto& impl = this->impl();
+
+    PosnSet ps;
+    PosnSet::Iterator it;
+
+    snap_model_->read_posn(bus_day, [&ps](PosnPtr ptr) { ps.insert(ptr); });
+    for (const auto& trade : impl.tail_trades) {
+        auto market_id = trade->market_id();
+        auto settl_day = trade->settl_day();
+
+        // Rolled with the same cutoff as end of day.
+        if (is_settled(settl_day, bus_day)) {
+            market_id = to_rolled_id(market_id);
+            settl_day = 0_jd;
+        }
+
+        bool found;
+        tie(it, found) = ps.find_hint(trade->accnt(), market_id);
+        if (!found) {
+            it = ps.insert_hint(it, Posn::make(trade->accnt(), market_id, trade->instr(),
+                                               settl_day));
+        }
+        it->add_trade(trade->side(), trade->last_lots(), trade->last_ticks());
+    }
+
+    for (it = ps.begin(); it != ps.end();) {
+        cb(ps.remove(it++));
+    }
+}
+
+} // namespace db
+} // namespace swirly
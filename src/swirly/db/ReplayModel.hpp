@@ -0,0 +1,87 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_DB_REPLAYMODEL_HPP
+#define SWIRLY_DB_REPLAYMODEL_HPP
+
+#include <swirly/fin/Model.hpp>
+
+#include <memory>
+
+namespace swirly {
+inline namespace db {
+
+/**
+ * Model that restores state from a snapshot, and then replays the tail of a binary journal over
+ * it, so that the cost of recovery depends on the length of the tail rather than the journal.
+ *
+ * The snapshot holds each market's max-id, and execs are only applied if their id is greater than
+ * the highest id applied so far for their market, so replay is idempotent: messages that the
+ * snapshot already reflects, and messages that were journalled more than once, are skipped. The
+ * tail starts at the most recent segment that holds a message reflected in the snapshot, because
+ * every message journalled before it must also be reflected.
+ */
+class SWIRLY_API ReplayModel : public Model {
+  public:
+    /**
+     * @param dir
+     *            The journal directory.
+     * @param ref_model
+     *            The model from which reference data is read.
+     * @param snap_model
+     *            The model from which the snapshot is read.
+     */
+    ReplayModel(const char* dir, const Model& ref_model, const Model& snap_model);
+    ~ReplayModel() override;
+
+    // Copy.
+    ReplayModel(const ReplayModel&) = delete;
+    ReplayModel& operator=(const ReplayModel&) = delete;
+
+    // Move.
+    ReplayModel(ReplayModel&&);
+    ReplayModel& operator=(ReplayModel&&);
+
+  protected:
+    bool do_concurrent() const noexcept override;
+
+    void do_read_asset(const ModelCallback<AssetPtr>& cb) const override;
+
+    void do_read_instr(const ModelCallback<InstrPtr>& cb) const override;
+
+    void do_read_market(const ModelCallback<MarketPtr>& cb) const override;
+
+    void do_read_order(const ModelCallback<OrderPtr>& cb) const override;
+
+    void do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const override;
+
+    void do_read_trade(const ModelCallback<ExecPtr>& cb) const override;
+
+    void do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const override;
+
+  private:
+    struct Impl;
+    const Impl& impl() const;
+
+    const Model* ref_model_;
+    const Model* snap_model_;
+    std::unique_ptr<Impl> impl_;
+};
+
+} // namespace db
+} // namespace swirly
+
+#endif // SWIRLY_DB_REPLAYMODEL_HPP
@@ -0,0 +1,252 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "ReplayModel.hpp"
+
+#include "Bin.hxx"
+#include "BinJourn.hpp"
+#include "BinModel.hpp"
+#include "FbsModel.hpp"
+#include "FbsSnapshot.hpp"
+
+#include <swirly/fin/Exec.hpp>
+#include <swirly/fin/Market.hpp>
+#include <swirly/fin/MarketId.hpp>
+#include <swirly/fin/Msg.hpp>
+#include <swirly/fin/Order.hpp>
+#include <swirly/fin/Posn.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+#include <unistd.h>
+
+using namespace std;
+using namespace swirly;
+
+namespace {
+
+constexpr auto Today = ymd_to_jd(2014, 3, 11);
+constexpr auto SettlDay = Today + 2_jd;
+constexpr auto MarketId = to_market_id(1_id32, SettlDay);
+
+constexpr auto Now = jd_to_time(Today);
+constexpr size_t MaxExecs{1 << 4};
+
+struct RefModel : Model {
+  protected:
+    void do_read_asset(const ModelCallback<AssetPtr>& cb) const override {}
+    void do_read_instr(const ModelCallback<InstrPtr>& cb) const override {}
+    void do_read_market(const ModelCallback<MarketPtr>& cb) const override {}
+    void do_read_order(const ModelCallback<OrderPtr>& cb) const override {}
+    void do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const override {}
+    void do_read_trade(const ModelCallback<ExecPtr>& cb) const override {}
+    void do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const override {}
+};
+
+struct TempDir {
+    TempDir()
+    {
+        char tmpl[] = "/tmp/swirly-journ.XXXXXX";
+        BOOST_REQUIRE(mkdtemp(tmpl));
+        path = tmpl;
+        snap_path = path + "/snap.dat";
+    }
+    ~TempDir()
+    {
+        for (const auto seq : bin::seg_list(path)) {
+            unlink(bin::seg_path(path, seq).c_str());
+        }
+        unlink(snap_path.c_str());
+        rmdir(path.c_str());
+    }
+    string path;
+    string snap_path;
+};
+
+Msg create_market_msg()
+{
+    char buf[MaxMsgSize];
+    encode_create_market(buf, MarketId, "EURUSD"sv, SettlDay, 0);
+    Msg msg;
+    decode_msg(buf, msg);
+    return msg;
+}
+
+Msg create_exec_msg(Id64 id, Id64 order_id, State state, Lots resd_lots, Lots last_lots)
+{
+    const auto exec = make_intrusive<Exec>(
+        "MARAYL"sv, MarketId, "EURUSD"sv, SettlDay, id, order_id, ""sv, state, Side::Buy, 10_lts,
+        12345_tks, resd_lots, 10_lts - resd_lots, 0_cst, last_lots,
+        last_lots > 0_lts ? 12345_tks : 0_tks, 1_lts, 0_id64, 0_lts, 0_cst, LiqInd::None,
+        Symbol{}, Now + Millis{id.count()});
+    char buf[MaxMsgSize];
+    encode_create_exec(buf, *exec);
+    Msg msg;
+    decode_msg(buf, msg);
+    return msg;
+}
+
+Msg archive_trade_msg(Id64 id)
+{
+    char buf[MaxMsgSize];
+    encode_archive_trade(buf, MarketId, {&id, 1}, Now);
+    Msg msg;
+    decode_msg(buf, msg);
+    return msg;
+}
+
+void write_snapshot(const Model& model, const string& path)
+{
+    FbsSnapshot snap;
+    model.read_market([&snap](auto ptr) { snap.add_market(*ptr); });
+    model.read_order([&snap](auto ptr) { snap.add_order(*ptr); });
+    model.read_exec(Time{}, [&snap](auto ptr) { snap.add_exec(*ptr); });
+    model.read_trade([&snap](auto ptr) { snap.add_trade(*ptr); });
+    model.read_posn(Today, [&snap](auto ptr) { snap.add_posn(*ptr); });
+    snap.finish(Now);
+    snap.write(path.c_str());
+}
+
+template <typename ValueT>
+vector<ValueT> read_all(const Model& model, void (Model::*fn)(const ModelCallback<ValueT>&) const)
+{
+    vector<ValueT> v;
+    (model.*fn)([&v](ValueT ptr) { v.push_back(std::move(ptr)); });
+    return v;
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(ReplayModelSuite)
+
+BOOST_AUTO_TEST_CASE(ReplayModelTailCase)
+{
+    TempDir dir;
+    const RefModel ref_model;
+    BinJourn journ{dir.path.c_str(), 1 << 20};
+    journ.write(create_market_msg());
+    journ.write(create_exec_msg(1_id64, 1_id64, State::New, 10_lts, 0_lts));
+    journ.write(create_exec_msg(2_id64, 1_id64, State::Trade, 3_lts, 7_lts));
+    write_snapshot(BinModel{dir.path.c_str(), ref_model, MaxExecs}, dir.snap_path);
+
+    journ.write(create_exec_msg(3_id64, 3_id64, State::New, 10_lts, 0_lts));
+    journ.write(create_exec_msg(4_id64, 1_id64, State::Trade, 0_lts, 3_lts));
+    journ.write(archive_trade_msg(2_id64));
+
+    const FbsModel snap_model{dir.snap_path.c_str()};
+    const ReplayModel model{dir.path.c_str(), ref_model, snap_model};
+
+    const auto markets = read_all(model, &Model::read_market);
+    BOOST_TEST(markets.size() == 1U);
+    BOOST_TEST(markets[0]->last_lots() == 3_lts);
+    BOOST_TEST(markets[0]->max_id() == 4_id64);
+
+    // The first order was filled in the tail.
+    const auto orders = read_all(model, &Model::read_order);
+    BOOST_TEST(orders.size() == 1U);
+    BOOST_TEST(orders[0]->id() == 3_id64);
+
+    vector<ExecPtr> execs;
+    model.read_exec(Time{}, [&execs](auto ptr) { execs.push_back(ptr); });
+    BOOST_TEST(execs.size() == 4U);
+    BOOST_TEST(execs[0]->id() == 4_id64);
+    BOOST_TEST(execs[3]->id() == 1_id64);
+
+    const auto trades = read_all(model, &Model::read_trade);
+    BOOST_TEST(trades.size() == 1U);
+    BOOST_TEST(trades[0]->id() == 4_id64);
+
+    vector<PosnPtr> posns;
+    model.read_posn(Today, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->buy_lots() == 10_lts);
+}
+
+BOOST_AUTO_TEST_CASE(ReplayModelDuplicateCase)
+{
+    TempDir dir;
+    const RefModel ref_model;
+    BinJourn journ{dir.path.c_str(), 1 << 20};
+    journ.write(create_market_msg());
+    journ.write(create_exec_msg(1_id64, 1_id64, State::New, 10_lts, 0_lts));
+    write_snapshot(BinModel{dir.path.c_str(), ref_model, MaxExecs}, dir.snap_path);
+
+    // The tail is journalled twice, as it would be if recovered messages were journalled again.
+    for (int i{0}; i < 2; ++i) {
+        journ.write(create_market_msg());
+        journ.write(create_exec_msg(2_id64, 1_id64, State::Trade, 3_lts, 7_lts));
+        journ.write(create_exec_msg(3_id64, 3_id64, State::New, 10_lts, 0_lts));
+    }
+
+    const FbsModel snap_model{dir.snap_path.c_str()};
+    const ReplayModel model{dir.path.c_str(), ref_model, snap_model};
+
+    vector<ExecPtr> execs;
+    model.read_exec(Time{}, [&execs](auto ptr) { execs.push_back(ptr); });
+    BOOST_TEST(execs.size() == 3U);
+    BOOST_TEST(execs[0]->id() == 3_id64);
+
+    const auto trades = read_all(model, &Model::read_trade);
+    BOOST_TEST(trades.size() == 1U);
+
+    // The trade is only counted once.
+    vector<PosnPtr> posns;
+    model.read_posn(Today, [&posns](auto ptr) { posns.push_back(ptr); });
+    BOOST_TEST(posns.size() == 1U);
+    BOOST_TEST(posns[0]->buy_lots() == 7_lts);
+
+    const auto markets = read_all(model, &Model::read_market);
+    BOOST_TEST(markets.size() == 1U);
+    BOOST_TEST(markets[0]->max_id() == 3_id64);
+}
+
+BOOST_AUTO_TEST_CASE(ReplayModelSegmentCase)
+{
+    TempDir dir;
+    const RefModel ref_model;
+    constexpr int N{100};
+    // Segments of the minimum size hold only a few records each.
+    BinJourn journ{dir.path.c_str(), 0};
+    journ.write(create_market_msg());
+    for (int i{1}; i <= N; ++i) {
+        Journ::Transaction trans{journ};
+        journ.write(create_exec_msg(Id64{i}, Id64{i}, State::New, 10_lts, 0_lts));
+        trans.commit();
+        if (i == N / 2) {
+            write_snapshot(BinModel{dir.path.c_str(), ref_model, MaxExecs}, dir.snap_path);
+        }
+    }
+    BOOST_TEST(bin::seg_list(dir.path).size() > 2U);
+
+    const FbsModel snap_model{dir.snap_path.c_str()};
+    const ReplayModel model{dir.path.c_str(), ref_model, snap_model};
+    const BinModel bin_model{dir.path.c_str(), ref_model, MaxExecs};
+
+    // Replay gives the same state as a full scan, without duplicating execs that are reflected in
+    // the snapshot.
+    const auto orders = read_all(model, &Model::read_order);
+    BOOST_TEST(orders.size() == read_all(bin_model, &Model::read_order).size());
+    BOOST_TEST(orders.back()->id() == Id64{N});
+
+    vector<ExecPtr> execs;
+    model.read_exec(Time{}, [&execs](auto ptr) { execs.push_back(ptr); });
+    BOOST_TEST(execs.size() == size_t{N});
+
+    const auto markets = read_all(model, &Model::read_market);
+    BOOST_TEST(markets[0]->max_id() == Id64{N});
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -15,3 +15,43 @@
  * 02110-1301, USA.
  */
 #include "Sql.hxx"
+
+#include <cassert>
+
+namespace swirly {
+inline namespace db {
+using namespace std;
+
+string param_list(size_t n)
+{
+    assert(n > 0);
+    string sql;
+    sql.reserve(3 * n);
+    sql += "(?";
+    for (size_t i{1}; i < n; ++i) {
+        sql += ", ?";
+    }
+    sql += ')';
+    return sql;
+}
+
+string multi_row_sql(string_view sql, size_t rows)
+{
+    assert(rows > 0);
+    constexpr auto Values = " VALUES "sv;
+    const auto pos = sql.rfind(Values);
+    assert(pos != string_view::npos);
+    const auto values = sql.substr(pos + Values.size());
+
+    string out;
+    out.reserve(sql.size() + (rows - 1) * (values.size() + 2));
+    out += sql;
+    for (size_t i{1}; i < rows; ++i) {
+        out += ", ";
+        out += values;
+    }
+    return out;
+}
+
+} // namespace db
+} // namespace swirly
@@ -17,6 +17,8 @@
 #ifndef SWIRLY_DB_SQL_HXX
 #define SWIRLY_DB_SQL_HXX
 
+#include <algorithm>
+#include <string>
 #include <string_view>
 
 namespace swirly {
@@ -81,6 +83,17 @@ constexpr auto UpdateSql =          //
     " WHERE id = ?"sv;
 } // namespace market
 
+namespace max_id {
+enum : int {
+    MarketId, //
+    MaxId     //
+};
+
+// The max_id column is null for markets without execs.
+constexpr auto SelectSql = //
+    "SELECT id, max_id FROM market_v"sv;
+} // namespace max_id
+
 namespace order {
 enum : int {   //
     Accnt,     //
@@ -142,6 +155,12 @@ constexpr auto SelectSql =
     " posn_lots, posn_cost, liq_ind_id, cpty, created"                                       //
     " FROM exec_t WHERE created > ? ORDER BY seq_id DESC;"sv;
 
+constexpr auto SelectAccntSql =                                                              //
+    "SELECT accnt, market_id, instr, settl_day, id, order_id, ref, state_id, side_id, lots," //
+    " ticks, resd_lots, exec_lots, exec_cost, last_lots, last_ticks, min_lots, match_id,"    //
+    " posn_lots, posn_cost, liq_ind_id, cpty, created"                                       //
+    " FROM exec_t WHERE accnt = ? AND created > ? ORDER BY seq_id DESC LIMIT ?;"sv;
+
 constexpr auto InsertSql =                                                         //
     "INSERT INTO exec_t (accnt, market_id, instr, settl_day, id, order_id, ref,"   //
     " state_id, side_id, lots, ticks, resd_lots, exec_lots, exec_cost, last_lots," //
@@ -152,6 +171,11 @@ constexpr auto InsertSql =
 constexpr auto UpdateSql =          //
     "UPDATE exec_t SET archive = ?" //
     " WHERE market_id = ? AND id = ?"sv;
+
+// The id list is appended by the caller.
+constexpr auto UpdateInSql =        //
+    "UPDATE exec_t SET archive = ?" //
+    " WHERE market_id = ? AND id IN "sv;
 } // namespace exec
 
 namespace trade {
@@ -202,6 +226,50 @@ constexpr auto SelectSql = //
     "SELECT accnt, market_id, instr, settl_day, side_id, lots, cost FROM posn_v;"sv;
 } // namespace posn
 
+/**
+ * Returns a parenthesised list of n placeholders.
+ */
+std::string param_list(std::size_t n);
+
+/**
+ * Returns the multi-row form of an INSERT statement, in which the VALUES list of the statement is
+ * repeated once for each row.
+ */
+std::string multi_row_sql(std::string_view sql, std::size_t rows);
+
+/**
+ * Upper bound on the number of parameters in a prepared statement.
+ */
+constexpr std::size_t MaxParams{65535};
+
+/**
+ * Returns batch_size clamped so that a multi-row statement with cols parameters per row has at
+ * least one row and no more than MaxParams parameters.
+ */
+constexpr std::size_t clamp_batch_size(std::size_t batch_size, std::size_t cols) noexcept
+{
+    return std::clamp<std::size_t>(batch_size, 1, MaxParams / cols);
+}
+
+/**
+ * Copy a zero-terminated array of ids to out, and repeat the first id in each unused slot, so that
+ * a single IN list of fixed size serves any number of ids. Returns the number of ids, or zero if
+ * there are none, in which case out is left unchanged.
+ */
+template <typename IdT, std::size_t N>
+std::size_t pad_ids(const IdT (&ids)[N], IdT (&out)[N]) noexcept
+{
+    std::size_t n{0};
+    while (n < N && ids[n] != IdT{}) {
+        ++n;
+    }
+    if (n > 0) {
+        std::copy_n(ids, n, out);
+        std::fill(out + n, out + N, ids[0]);
+    }
+    return n;
+}
+
 } // namespace db
 } // namespace swirly
 
@@ -0,0 +1,68 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "Sql.hxx"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace swirly;
+
+BOOST_AUTO_TEST_SUITE(SqlSuite)
+
+BOOST_AUTO_TEST_CASE(ParamListCase)
+{
+    BOOST_TEST(param_list(1) == "(?)");
+    BOOST_TEST(param_list(3) == "(?, ?, ?)");
+}
+
+BOOST_AUTO_TEST_CASE(MultiRowSqlCase)
+{
+    BOOST_TEST(multi_row_sql(market::InsertSql, 1) == market::InsertSql);
+    BOOST_TEST(multi_row_sql(market::InsertSql, 3)
+               == "INSERT INTO market_t (id, instr, settl_day, state)"
+                  " VALUES (?, ?, ?, ?), (?, ?, ?, ?), (?, ?, ?, ?)");
+}
+
+BOOST_AUTO_TEST_CASE(ClampBatchSizeCase)
+{
+    BOOST_TEST(clamp_batch_size(0, 23) == 1U);
+    BOOST_TEST(clamp_batch_size(64, 23) == 64U);
+    // The statement must not exceed the parameter limit.
+    BOOST_TEST(clamp_batch_size(10000, 23) == 2849U);
+    BOOST_TEST(clamp_batch_size(10000, 23) * 23 <= MaxParams);
+}
+
+BOOST_AUTO_TEST_CASE(PadIdsCase)
+{
+    const int none[4]{};
+    int out[4]{9, 9, 9, 9};
+    BOOST_TEST(pad_ids(none, out) == 0U);
+    BOOST_TEST(out[0] == 9);
+
+    const int some[4]{3, 5, 0, 0};
+    BOOST_TEST(pad_ids(some, out) == 2U);
+    BOOST_TEST(out[0] == 3);
+    BOOST_TEST(out[1] == 5);
+    BOOST_TEST(out[2] == 3);
+    BOOST_TEST(out[3] == 3);
+
+    const int all[4]{3, 5, 7, 11};
+    BOOST_TEST(pad_ids(all, out) == 4U);
+    BOOST_TEST(out[3] == 11);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -89,6 +89,12 @@ DbPtr open_db(const char* path, int flags, const Config& config)
         sqlite3_trace(db, trace, nullptr);
 #pragma GCC diagnostic pop
     }
+    // Connections to the same database wait for each other's locks, rather than failing at once.
+    rc = sqlite3_busy_timeout(db, config.get<int>("sqlite_busy_timeout", 5000));
+    if (rc != SQLITE_OK) {
+        throw DatabaseException{err_msg()
+                                << "sqlite3_busy_timeout: " << last_error(*db) << ": " << path};
+    }
     if (config.get("sqlite_enable_fkey", false)) {
         rc = sqlite3_db_config(db, SQLITE_DBCONFIG_ENABLE_FKEY, 1, nullptr);
         if (rc != SQLITE_OK) {
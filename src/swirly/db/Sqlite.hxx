@@ -132,7 +132,12 @@ struct DbTraits<std::string_view> {
     static void bind(sqlite3_stmt& stmt, int col, std::string_view val) { bindsv(stmt, col, val); }
     static std::string_view column(sqlite3_stmt& stmt, int col) noexcept
     {
-        return reinterpret_cast<const char*>(sqlite3_column_text(&stmt, col));
+        const auto* text = reinterpret_cast<const char*>(sqlite3_column_text(&stmt, col));
+        if (!text) {
+            // Null column.
+            return {};
+        }
+        return {text, static_cast<std::size_t>(sqlite3_column_bytes(&stmt, col))};
     }
 };
 
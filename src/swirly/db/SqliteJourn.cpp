@@ -81,6 +81,15 @@ void SqliteJourn::do_write(const Msg& msg)
     dispatch(msg);
 }
 
+void SqliteJourn::do_read_max_id(const function<void(Id64, Id64)>& cb) const
+{
+    using namespace max_id;
+    StmtPtr stmt{prepare(*db_, SelectSql)};
+    while (step(*stmt)) {
+        cb(column<Id64>(*stmt, MarketId), column<Id64>(*stmt, MaxId));
+    }
+}
+
 void SqliteJourn::on_create_market(const CreateMarket& body)
 {
     auto& stmt = *insert_market_stmt_;
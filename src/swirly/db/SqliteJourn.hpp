@@ -53,6 +53,8 @@ class SWIRLY_API SqliteJourn
 
     void do_write(const Msg& msg) override;
 
+    void do_read_max_id(const std::function<void(Id64, Id64)>& cb) const override;
+
   private:
     void on_create_market(const CreateMarket& body);
 
@@ -23,6 +23,7 @@
 #include <swirly/fin/Exec.hpp>
 #include <swirly/fin/Instr.hpp>
 #include <swirly/fin/Market.hpp>
+#include <swirly/fin/MarketId.hpp>
 
 #include <swirly/fin/Order.hpp>
 #include <swirly/fin/Posn.hpp>
@@ -34,6 +35,38 @@ inline namespace db {
 using namespace sqlite;
 using namespace std;
 
+namespace {
+
+ExecPtr make_exec(sqlite3_stmt& stmt)
+{
+    using namespace exec;
+    return Exec::make(column<string_view>(stmt, Accnt),       //
+                      column<Id64>(stmt, MarketId),           //
+                      column<string_view>(stmt, Instr),       //
+                      column<JDay>(stmt, SettlDay),           //
+                      column<Id64>(stmt, Id),                 //
+                      column<Id64>(stmt, OrderId),            //
+                      column<string_view>(stmt, Ref),         //
+                      column<swirly::State>(stmt, State),     //
+                      column<swirly::Side>(stmt, Side),       //
+                      column<swirly::Lots>(stmt, Lots),       //
+                      column<swirly::Ticks>(stmt, Ticks),     //
+                      column<swirly::Lots>(stmt, ResdLots),   //
+                      column<swirly::Lots>(stmt, ExecLots),   //
+                      column<swirly::Cost>(stmt, ExecCost),   //
+                      column<swirly::Lots>(stmt, LastLots),   //
+                      column<swirly::Ticks>(stmt, LastTicks), //
+                      column<swirly::Lots>(stmt, MinLots),    //
+                      column<Id64>(stmt, MatchId),            //
+                      column<swirly::Lots>(stmt, PosnLots),   //
+                      column<swirly::Cost>(stmt, PosnCost),   //
+                      column<swirly::LiqInd>(stmt, LiqInd),   //
+                      column<string_view>(stmt, Cpty),        //
+                      column<Time>(stmt, Created));
+}
+
+} // namespace
+
 SqliteModel::SqliteModel(const DbPtr& db)
 : db_{db}
 {
@@ -131,29 +164,21 @@ void SqliteModel::do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) con
     ScopedBind bind{*stmt};
     bind(since);
     while (step(*stmt)) {
-        cb(Exec::make(column<string_view>(*stmt, Accnt),       //
-                      column<Id64>(*stmt, MarketId),           //
-                      column<string_view>(*stmt, Instr),       //
-                      column<JDay>(*stmt, SettlDay),           //
-                      column<Id64>(*stmt, Id),                 //
-                      column<Id64>(*stmt, OrderId),            //
-                      column<string_view>(*stmt, Ref),         //
-                      column<swirly::State>(*stmt, State),     //
-                      column<swirly::Side>(*stmt, Side),       //
-                      column<swirly::Lots>(*stmt, Lots),       //
-                      column<swirly::Ticks>(*stmt, Ticks),     //
-                      column<swirly::Lots>(*stmt, ResdLots),   //
-                      column<swirly::Lots>(*stmt, ExecLots),   //
-                      column<swirly::Cost>(*stmt, ExecCost),   //
-                      column<swirly::Lots>(*stmt, LastLots),   //
-                      column<swirly::Ticks>(*stmt, LastTicks), //
-                      column<swirly::Lots>(*stmt, MinLots),    //
-                      column<Id64>(*stmt, MatchId),            //
-                      column<swirly::Lots>(*stmt, PosnLots),   //
-                      column<swirly::Cost>(*stmt, PosnCost),   //
-                      column<swirly::LiqInd>(*stmt, LiqInd),   //
-                      column<string_view>(*stmt, Cpty),        //
-                      column<Time>(*stmt, Created)));
+        cb(make_exec(*stmt));
+    }
+}
+
+void SqliteModel::do_read_accnt_exec(Symbol accnt, Time since, size_t limit,
+                                     const ModelCallback<ExecPtr>& cb) const
+{
+    using namespace exec;
+    StmtPtr stmt{prepare(*db_, SelectAccntSql)};
+    ScopedBind bind{*stmt};
+    bind(string_view{accnt.data(), accnt.size()});
+    bind(since);
+    bind(limit);
+    while (step(*stmt)) {
+        cb(make_exec(*stmt));
     }
 }
 
@@ -202,9 +227,9 @@ void SqliteModel::do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) c
         const auto instr = column<string_view>(*stmt, Instr);
         auto settl_day = column<JDay>(*stmt, SettlDay);
 
-        // FIXME: review when end of day is implemented.
-        if (settl_day != 0_jd && settl_day <= bus_day) {
-            market_id &= Id64{~0xffff};
+        // Rolled with the same cutoff as end of day.
+        if (is_settled(settl_day, bus_day)) {
+            market_id = to_rolled_id(market_id);
             settl_day = 0_jd;
         }
 
@@ -125,6 +125,31 @@ constexpr Side opposite(Side side) noexcept
     return side;
 }
 
+/**
+ * Time in force. Only good-till-cancel orders rest on the book: the unfilled quantity of an
+ * immediate-or-cancel order is cancelled, and a fill-or-kill order is cancelled without trading
+ * unless it can be filled in full.
+ */
+enum class TimeInForce { Gtc, Ioc, Fok };
+
+inline const char* enum_string(TimeInForce tif) noexcept
+{
+    switch (tif) {
+    case TimeInForce::Gtc:
+        return "GTC";
+    case TimeInForce::Ioc:
+        return "IOC";
+    case TimeInForce::Fok:
+        return "FOK";
+    }
+    return "";
+}
+
+inline std::ostream& operator<<(std::ostream& os, TimeInForce tif)
+{
+    return os << enum_string(tif);
+}
+
 /**
  * Order states.
  * @image html OrderState.png
@@ -19,8 +19,12 @@
 
 #include <swirly/fin/Transaction.hpp>
 
+#include <swirly/util/BasicTypes.hpp>
+
 #include <swirly/Config.h>
 
+#include <functional>
+
 namespace swirly {
 inline namespace fin {
 struct Msg;
@@ -47,6 +51,13 @@ class SWIRLY_API Journ {
 
     void write(const Msg& msg) { do_write(msg); }
 
+    /**
+     * Read the id of each journalled market, together with the highest exec id that has been
+     * journalled for the market, or zero if there is none. This is used on recovery to identify
+     * messages that were journalled before a crash, but never released from the queue.
+     */
+    void read_max_id(const std::function<void(Id64, Id64)>& cb) const { do_read_max_id(cb); }
+
   protected:
     virtual void do_begin() = 0;
 
@@ -55,6 +66,8 @@ class SWIRLY_API Journ {
     virtual void do_rollback() noexcept = 0;
 
     virtual void do_write(const Msg& msg) = 0;
+
+    virtual void do_read_max_id(const std::function<void(Id64, Id64)>& cb) const = 0;
 };
 
 } // namespace fin
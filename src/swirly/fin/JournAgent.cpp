@@ -0,0 +1,92 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "JournAgent.hpp"
+
+#include <swirly/fin/Journ.hpp>
+#include <swirly/fin/Msg.hpp>
+#include <swirly/fin/MsgQueue.hpp>
+
+namespace swirly {
+inline namespace fin {
+using namespace std;
+
+JournAgent::~JournAgent() = default;
+
+void JournAgent::skip_journalled()
+{
+    max_ids_.clear();
+    journ_.read_max_id([this](Id64 market_id, Id64 max_id) { max_ids_[market_id] = max_id; });
+    skip_ = true;
+}
+
+int JournAgent::operator()()
+{
+    Msg msg;
+    bool end;
+    auto pos = mq_.rpos();
+    if (!mq_.peek(msg, end, pos)) {
+        return 0;
+    }
+    const auto start = UnixClock::now();
+    size_t n{0};
+    Journ::Transaction trans{journ_};
+    for (;;) {
+        if (!skip_ || !journalled(msg)) {
+            journ_.write(msg);
+        }
+        ++n;
+        // The remainder of a batch is available as soon as its first message is.
+        if (end && (n >= max_msgs_ || UnixClock::now() - start >= max_wait_)) {
+            break;
+        }
+        if (!mq_.peek(msg, end, pos)) {
+            break;
+        }
+    }
+    trans.commit();
+    // Messages are only released once they are durable, so that a file-based queue still holds any
+    // messages that were lost from an uncommitted transaction.
+    mq_.release(pos);
+    __atomic_store_n(&committed_, pos, __ATOMIC_RELEASE);
+    if (slot_) {
+        slot_(pos);
+    }
+    return n;
+}
+
+bool JournAgent::journalled(const Msg& msg) const noexcept
+{
+    // The max ids are not updated as messages are written, because each message in the queue is
+    // distinct, so none that has been written since they were read can reappear.
+    switch (msg.type) {
+    case MsgType::CreateMarket: {
+        const Id64 id{msg.create_market.id};
+        return max_ids_.count(id) > 0;
+    }
+    case MsgType::CreateExec: {
+        const Id64 market_id{msg.create_exec.market_id}, id{msg.create_exec.id};
+        const auto it = max_ids_.find(market_id);
+        return it != max_ids_.end() && id <= it->second;
+    }
+    default:
+        break;
+    }
+    return false;
+}
+
+} // namespace fin
+} // namespace swirly
@@ -0,0 +1,111 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_FIN_JOURNAGENT_HPP
+#define SWIRLY_FIN_JOURNAGENT_HPP
+
+#include <swirly/sys/Memory.hpp>
+
+#include <swirly/util/BasicTypes.hpp>
+#include <swirly/util/Slot.hpp>
+#include <swirly/util/Time.hpp>
+
+#include <swirly/Config.h>
+
+#include <cstdint>
+#include <map>
+
+namespace swirly {
+inline namespace fin {
+class Journ;
+class MsgQueue;
+struct Msg;
+
+/**
+ * Agent that drains the message queue into the journal. Messages are grouped into a single
+ * transaction until the queue is empty, max_msgs messages have been written, or max_wait has
+ * elapsed, so that the cost of each commit is shared by many messages. A batch is never split
+ * across transactions. Messages remain in the queue until they have been committed, so the
+ * journal's position in the queue is also its committed position.
+ */
+class SWIRLY_API JournAgent {
+  public:
+    /**
+     * Slot invoked on the journal thread with the new committed position after each commit.
+     */
+    using CommitSlot = BasicSlot<std::int64_t>;
+
+    JournAgent(MsgQueue& mq, Journ& journ, std::size_t max_msgs, Duration max_wait,
+               CommitSlot slot = {}) noexcept
+    : mq_(mq)
+    , journ_(journ)
+    , max_msgs_{max_msgs}
+    , max_wait_{max_wait}
+    , slot_{slot}
+    {
+    }
+    ~JournAgent();
+
+    // Copy.
+    JournAgent(const JournAgent&) = delete;
+    JournAgent& operator=(const JournAgent&) = delete;
+
+    // Move.
+    JournAgent(JournAgent&&) = delete;
+    JournAgent& operator=(JournAgent&&) = delete;
+
+    /**
+     * Returns the queue position up to which messages have been committed to the journal. The
+     * position increases monotonically, so a response to a request that posted messages up to
+     * MsgQueue::wpos() is durable once the committed position has reached it. This function may be
+     * called from any thread.
+     */
+    std::int64_t committed() const noexcept
+    {
+        return __atomic_load_n(&committed_, __ATOMIC_ACQUIRE);
+    }
+    /**
+     * Skip messages that are already in the journal. A crash between the commit of a group and the
+     * release of its messages leaves the group in a file-based queue, so this must be called before
+     * a recovered queue is drained. Markets that the journal already holds, and execs at or below
+     * the highest exec id journalled for their market, are skipped. The remaining messages are
+     * idempotent.
+     */
+    void skip_journalled();
+    /**
+     * Commit a single group of messages. Returns the number of messages consumed from the queue,
+     * including any that were skipped.
+     */
+    int operator()();
+
+  private:
+    bool journalled(const Msg& msg) const noexcept;
+
+    MsgQueue& mq_;
+    Journ& journ_;
+    const std::size_t max_msgs_;
+    const Duration max_wait_;
+    const CommitSlot slot_;
+    // Highest exec id journalled for each market, when skipping journalled messages.
+    std::map<Id64, Id64> max_ids_;
+    bool skip_{false};
+    alignas(CacheLineSize) std::int64_t committed_{0};
+};
+
+} // namespace fin
+} // namespace swirly
+
+#endif // SWIRLY_FIN_JOURNAGENT_HPP
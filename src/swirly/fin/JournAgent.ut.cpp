@@ -0,0 +1,162 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "JournAgent.hpp"
+
+#include <swirly/fin/Exec.hpp>
+#include <swirly/fin/Journ.hpp>
+#include <swirly/fin/MarketId.hpp>
+#include <swirly/fin/Msg.hpp>
+#include <swirly/fin/MsgQueue.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace swirly;
+
+namespace {
+
+constexpr auto Today = ymd_to_jd(2014, 3, 11);
+constexpr auto SettlDay = Today + 2_jd;
+constexpr auto MarketId = to_market_id(1_id32, SettlDay);
+
+constexpr auto Now = jd_to_time(Today);
+
+struct TestJourn : Journ {
+    int begins{0};
+    int commits{0};
+    int msgs{0};
+    map<Id64, Id64> max_ids;
+    vector<Msg> written;
+
+  protected:
+    void do_begin() override { ++begins; }
+    void do_commit() override { ++commits; }
+    void do_rollback() noexcept override {}
+    void do_write(const Msg& msg) override
+    {
+        ++msgs;
+        written.push_back(msg);
+    }
+    void do_read_max_id(const function<void(Id64, Id64)>& cb) const override
+    {
+        for (const auto& [market_id, max_id] : max_ids) {
+            cb(market_id, max_id);
+        }
+    }
+};
+
+ConstExecPtr make_exec(Id64 id, Id64 market_id = MarketId)
+{
+    return make_intrusive<Exec>("MARAYL"sv, market_id, "EURUSD"sv, SettlDay, id, id, ""sv,
+                                State::New, Side::Buy, 10_lts, 12345_tks, 10_lts, 0_lts, 0_cst,
+                                0_lts, 0_tks, 1_lts, 0_id64, 0_lts, 0_cst, LiqInd::None, Symbol{},
+                                Now);
+}
+
+} // namespace
+
+BOOST_AUTO_TEST_SUITE(JournAgentSuite)
+
+BOOST_AUTO_TEST_CASE(JournAgentGroupCase)
+{
+    MsgQueue mq{1 << 10};
+    TestJourn journ;
+    JournAgent agent{mq, journ, 4, 1s};
+
+    BOOST_TEST(agent() == 0);
+    BOOST_TEST(journ.begins == 0);
+
+    for (int i{0}; i < 5; ++i) {
+        mq.update_market(MarketId, i);
+    }
+    // The group is limited to four messages.
+    BOOST_TEST(agent() == 4);
+    BOOST_TEST(journ.commits == 1);
+    BOOST_TEST(agent.committed() < mq.wpos());
+    BOOST_TEST(agent() == 1);
+    BOOST_TEST(journ.commits == 2);
+    BOOST_TEST(agent.committed() == mq.wpos());
+
+    // A batch is never split across transactions.
+    mq.update_market(MarketId, 0);
+    const ConstExecPtr execs[] = {make_exec(1_id64), make_exec(2_id64), make_exec(3_id64),
+                                  make_exec(4_id64), make_exec(5_id64)};
+    mq.create_exec(execs);
+    mq.update_market(MarketId, 0);
+    BOOST_TEST(agent() == 6);
+    BOOST_TEST(agent() == 1);
+    BOOST_TEST(journ.commits == 4);
+    BOOST_TEST(journ.msgs == 12);
+    BOOST_TEST(agent.committed() == mq.wpos());
+}
+
+BOOST_AUTO_TEST_CASE(JournAgentSlotCase)
+{
+    MsgQueue mq{1 << 10};
+    TestJourn journ;
+
+    vector<int64_t> positions;
+    auto fn = [&positions](int64_t pos) { positions.push_back(pos); };
+    JournAgent agent{mq, journ, 4, 1s, bind(&fn)};
+
+    BOOST_TEST(agent() == 0);
+    BOOST_TEST(positions.empty());
+
+    mq.update_market(MarketId, 0);
+    BOOST_TEST(agent() == 1);
+    mq.update_market(MarketId, 0);
+    BOOST_TEST(agent() == 1);
+    BOOST_TEST(positions.size() == 2U);
+    BOOST_TEST(positions[0] < positions[1]);
+    BOOST_TEST(positions[1] == mq.wpos());
+}
+
+BOOST_AUTO_TEST_CASE(JournAgentSkipCase)
+{
+    constexpr auto OtherId = to_market_id(2_id32, SettlDay);
+
+    MsgQueue mq{1 << 10};
+    TestJourn journ;
+    // The first group was committed before the crash, but never released from the queue.
+    journ.max_ids[MarketId] = 2_id64;
+
+    mq.create_market(MarketId, "EURUSD"sv, SettlDay, 0);
+    const ConstExecPtr execs[] = {make_exec(1_id64), make_exec(2_id64)};
+    mq.create_exec(execs);
+    mq.update_market(MarketId, 1);
+    mq.create_market(OtherId, "GBPUSD"sv, SettlDay, 0);
+    const ConstExecPtr more_execs[] = {make_exec(3_id64), make_exec(1_id64, OtherId)};
+    mq.create_exec(more_execs);
+
+    JournAgent agent{mq, journ, 100, 1s};
+    agent.skip_journalled();
+    // Skipped messages are consumed all the same.
+    BOOST_TEST(agent() == 7);
+    BOOST_TEST(agent.committed() == mq.wpos());
+
+    BOOST_TEST(journ.written.size() == 4U);
+    BOOST_TEST((journ.written[0].type == MsgType::UpdateMarket));
+    BOOST_TEST((journ.written[1].type == MsgType::CreateMarket));
+    BOOST_TEST((journ.written[2].type == MsgType::CreateExec));
+    const Id64 id{journ.written[2].create_exec.id};
+    BOOST_TEST(id == 3_id64);
+    BOOST_TEST((journ.written[3].type == MsgType::CreateExec));
+    const Id64 market_id{journ.written[3].create_exec.market_id};
+    BOOST_TEST(market_id == OtherId);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -16,17 +16,53 @@
  */
 #include "Level.hpp"
 
-#include <swirly/fin/Order.hpp>
+#include <algorithm>
+#include <limits>
 
 namespace swirly {
 inline namespace fin {
 using namespace std;
 
+static_assert(sizeof(BookEntry) <= 1 * 64, "no greater than specified cache-lines");
 static_assert(sizeof(Level) <= 2 * 64, "no greater than specified cache-lines");
 
+BookEntry::BookEntry(const OrderPtr& order) noexcept
+: order_{order}
+, accnt_{order->accnt()}
+, ticks_{order->ticks()}
+, resd_lots_{order->resd_lots()}
+{
+}
+
+BookEntry::~BookEntry() = default;
+
+BookQueue::~BookQueue()
+{
+    list_.clear_and_dispose([](BookEntry* ptr) { delete ptr; });
+}
+
+BookQueue::BookQueue(BookQueue&&) = default;
+
+BookQueue& BookQueue::operator=(BookQueue&&) = default;
+
+BookQueue::Iterator BookQueue::insert_back(ValuePtr value) noexcept
+{
+    list_.push_back(*value);
+    // Take ownership.
+    return List::s_iterator_to(*value.release());
+}
+
+BookQueue::ValuePtr BookQueue::remove(const BookEntry& ref) noexcept
+{
+    ValuePtr value;
+    list_.erase_and_dispose(List::s_iterator_to(ref), [&value](BookEntry* ptr) {
+        value = ValuePtr{ptr};
+    });
+    return value;
+}
+
 Level::Level(const Order& first_order) noexcept
-: first_order_{&first_order}
-, key_{detail::compose_key(first_order.side(), first_order.ticks())}
+: key_{detail::compose_key(first_order.side(), first_order.ticks())}
 , ticks_{first_order.ticks()}
 , lots_{first_order.resd_lots()}
 , count_{1}
@@ -51,36 +87,116 @@ void Level::sub_order(const Order& order) noexcept
 
 LevelSet::~LevelSet()
 {
+    for (std::uint32_t i{0}; count_ > 0 && i < width_; ++i) {
+        if (window_[i]) {
+            delete window_[i];
+            --count_;
+        }
+    }
     set_.clear_and_dispose([](Level* ptr) { delete ptr; });
 }
 
-LevelSet::LevelSet(LevelSet&&) = default;
+LevelSet::LevelSet(LevelSet&& rhs)
+: set_{move(rhs.set_)}
+, window_{move(rhs.window_)}
+, bits_{move(rhs.bits_)}
+, base_{rhs.base_}
+, width_{rhs.width_}
+, count_{rhs.count_}
+{
+    // The window has moved, so the source must no longer refer to it.
+    rhs.base_ = 0;
+    rhs.width_ = 0;
+    rhs.count_ = 0;
+}
+
+LevelSet& LevelSet::operator=(LevelSet&& rhs)
+{
+    // The previous levels are destroyed along with the temporary.
+    LevelSet tmp{move(rhs)};
+    set_.swap(tmp.set_);
+    window_.swap(tmp.window_);
+    bits_.swap(tmp.bits_);
+    swap(base_, tmp.base_);
+    swap(width_, tmp.width_);
+    swap(count_, tmp.count_);
+    return *this;
+}
 
-LevelSet& LevelSet::operator=(LevelSet&&) = default;
+void LevelSet::set_window(size_t width)
+{
+    assert(width <= numeric_limits<uint32_t>::max());
+    // Allocate before any level is moved, so that a failure leaves the set unchanged.
+    unique_ptr<Level*[]> window;
+    unique_ptr<uint64_t[]> bits;
+    if (width > 0) {
+        // Value initialised to null and zero.
+        window = make_unique<Level*[]>(width);
+        bits = make_unique<uint64_t[]>((width + WordBits - 1) / WordBits);
+    }
+    drain();
+    window_ = move(window);
+    bits_ = move(bits);
+    base_ = 0;
+    width_ = width;
+    if (width_ > 0 && !set_.empty()) {
+        slide(set_.begin()->key());
+    }
+}
 
 LevelSet::Iterator LevelSet::insert(ValuePtr value) noexcept
 {
-    Iterator it;
+    const auto key = value->key();
+    if (in_window(key)) {
+        Level* const level{window_[key - base_]};
+        if (level) {
+            return {this, level};
+        }
+        // Take ownership.
+        place(*value.release());
+        return {this, window_[key - base_]};
+    }
+    Set::iterator it;
     bool inserted;
     tie(it, inserted) = set_.insert(*value);
     if (inserted) {
         // Take ownership if inserted.
         value.release();
+        maybe_slide(*it);
     }
-    return it;
+    return {this, &*it};
 }
 
 LevelSet::Iterator LevelSet::insert_hint(ConstIterator hint, ValuePtr value) noexcept
 {
-    auto it = set_.insert(hint, *value);
     // Take ownership.
-    value.release();
-    return it;
+    Level& level{*value.release()};
+    if (in_window(level.key())) {
+        place(level);
+        return {this, &level};
+    }
+    // Only tree levels are useful as a hint.
+    auto pos = hint.level_ && hint.level_->key_hook.is_linked() ? Set::s_iterator_to(*hint)
+                                                                 : set_.cend();
+    auto it = set_.insert(pos, level);
+    maybe_slide(*it);
+    return {this, &*it};
 }
 
 LevelSet::Iterator LevelSet::insert_or_replace(ValuePtr value) noexcept
 {
-    Iterator it;
+    const auto key = value->key();
+    if (in_window(key)) {
+        // Replace if exists.
+        ValuePtr prev{window_[key - base_]};
+        if (prev) {
+            unplace(*prev);
+        }
+        // Take ownership.
+        place(*value.release());
+        return {this, window_[key - base_]};
+    }
+    Set::iterator it;
     bool inserted;
     tie(it, inserted) = set_.insert(*value);
     if (!inserted) {
@@ -91,13 +207,79 @@ LevelSet::Iterator LevelSet::insert_or_replace(ValuePtr value) noexcept
     }
     // Take ownership.
     value.release();
-    return it;
+    if (inserted) {
+        maybe_slide(*it);
+    }
+    return {this, &*it};
 }
 
 void LevelSet::remove(const Level& level) noexcept
 {
+    if (!level.key_hook.is_linked()) {
+        unplace(level);
+        delete &level;
+        return;
+    }
     set_.erase_and_dispose(Set::s_iterator_to(level), [](Level* ptr) { delete ptr; });
 }
 
+void LevelSet::place(Level& level) noexcept
+{
+    const auto pos = static_cast<size_t>(level.key() - base_);
+    assert(pos < width_ && !window_[pos]);
+    window_[pos] = &level;
+    bits_[pos / WordBits] |= uint64_t{1} << (pos % WordBits);
+    ++count_;
+}
+
+void LevelSet::unplace(const Level& level) noexcept
+{
+    const auto pos = static_cast<size_t>(level.key() - base_);
+    assert(pos < width_ && window_[pos] == &level);
+    window_[pos] = nullptr;
+    bits_[pos / WordBits] &= ~(uint64_t{1} << (pos % WordBits));
+    --count_;
+}
+
+void LevelSet::maybe_slide(const Level& level) noexcept
+{
+    if (width_ == 0) {
+        return;
+    }
+    // Slide the window if it is empty, or if the level has become the best price.
+    if (count_ == 0 || (level.key() < base_ && &level == &*set_.begin())) {
+        slide(level.key());
+    }
+}
+
+void LevelSet::slide(LevelKey key) noexcept
+{
+    drain();
+    // Leave a quarter of the window for improving prices.
+    base_ = key - static_cast<LevelKey>(width_ / 4);
+    auto it = set_.lower_bound(base_, KeyValueCompare());
+    while (it != set_.end() && in_window(it->key())) {
+        Level& level{*it};
+        it = set_.erase(it);
+        place(level);
+    }
+}
+
+void LevelSet::drain() noexcept
+{
+    if (count_ == 0) {
+        return;
+    }
+    // Window levels lie between the tree levels below and above the window, and are visited in
+    // key order, so each is linked immediately before the first level above the window.
+    const auto pos = set_.lower_bound(base_ + width_, KeyValueCompare());
+    for (Level* level{next_slot(0)}; level; level = next_slot(level->key() - base_ + 1)) {
+        set_.insert_before(pos, *level);
+    }
+    fill(window_.get(), window_.get() + width_, nullptr);
+    fill(bits_.get(), bits_.get() + (size_t{width_} + WordBits - 1) / WordBits, 0);
+    count_ = 0;
+}
+
 } // namespace fin
 } // namespace swirly
@@ -17,12 +17,19 @@
 #ifndef SWIRLY_FIN_LEVEL_HPP
 #define SWIRLY_FIN_LEVEL_HPP
 
-#include <swirly/fin/Types.hpp>
+#include <swirly/fin/Order.hpp>
 
 #include <swirly/app/MemAlloc.hpp>
 
+#include <swirly/sys/Memory.hpp>
+
+#include <boost/intrusive/list.hpp>
 #include <boost/intrusive/set.hpp>
 
+#include <algorithm>
+#include <iterator>
+#include <type_traits>
+
 namespace swirly {
 inline namespace fin {
 
@@ -40,11 +47,100 @@ constexpr LevelKey compose_key(Side side, Ticks ticks) noexcept
 
 } // namespace detail
 
+/**
+ * Book entry.
+ *
+ * A compact, cache-line sized record of a resting order. The fields read by the matching loop are
+ * copied from the order, so that a sweep through a deep level touches one line per maker. The full
+ * order record is only dereferenced when a trade is generated.
+ */
+class SWIRLY_API BookEntry : public MemAlloc {
+  public:
+    explicit BookEntry(const OrderPtr& order) noexcept;
+
+    ~BookEntry();
+
+    // Copy.
+    BookEntry(const BookEntry&) = delete;
+    BookEntry& operator=(const BookEntry&) = delete;
+
+    // Move.
+    BookEntry(BookEntry&&) = delete;
+    BookEntry& operator=(BookEntry&&) = delete;
+
+    const OrderPtr& order() const noexcept { return order_; }
+    Symbol accnt() const noexcept { return accnt_; }
+    Ticks ticks() const noexcept { return ticks_; }
+    Lots resd_lots() const noexcept { return resd_lots_; }
+    void reduce(Lots delta) noexcept { resd_lots_ -= delta; }
+
+    /**
+     * Aligning the first member aligns each entry to a cache-line.
+     */
+    alignas(CacheLineSize) boost::intrusive::list_member_hook<> list_hook;
+
+  private:
+    const OrderPtr order_;
+    const Symbol accnt_;
+    const Ticks ticks_;
+    /**
+     * Mirrors the order's residual while the order rests on the book.
+     */
+    Lots resd_lots_;
+};
+
+/**
+ * FIFO queue of book entries in time priority.
+ */
+class SWIRLY_API BookQueue {
+    using ConstantTimeSizeOption = boost::intrusive::constant_time_size<false>;
+    using MemberHookOption = boost::intrusive::member_hook<BookEntry, decltype(BookEntry::list_hook),
+                                                           &BookEntry::list_hook>;
+    using List = boost::intrusive::list<BookEntry, ConstantTimeSizeOption, MemberHookOption>;
+    using ValuePtr = std::unique_ptr<BookEntry>;
+
+  public:
+    using Iterator = typename List::iterator;
+    using ConstIterator = typename List::const_iterator;
+
+    BookQueue() = default;
+
+    ~BookQueue();
+
+    // Copy.
+    BookQueue(const BookQueue&) = delete;
+    BookQueue& operator=(const BookQueue&) = delete;
+
+    // Move.
+    BookQueue(BookQueue&&);
+    BookQueue& operator=(BookQueue&&);
+
+    // Begin.
+    ConstIterator begin() const noexcept { return list_.begin(); }
+    ConstIterator cbegin() const noexcept { return list_.cbegin(); }
+    Iterator begin() noexcept { return list_.begin(); }
+
+    // End.
+    ConstIterator end() const noexcept { return list_.end(); }
+    ConstIterator cend() const noexcept { return list_.cend(); }
+    Iterator end() noexcept { return list_.end(); }
+
+    bool empty() const noexcept { return list_.empty(); }
+
+    Iterator insert_back(ValuePtr value) noexcept;
+
+    ValuePtr remove(const BookEntry& ref) noexcept;
+
+  private:
+    List list_;
+};
+
 /**
  * Price level.
  *
  * A price level is an aggregation of orders by price. I.e. the sum of all orders in the market at
- * the same price.
+ * the same price. Each level owns the FIFO queue of orders resting at its price, so that inserts
+ * and cancels only touch the level concerned.
  */
 class SWIRLY_API Level
 : public Comparable<Level>
@@ -63,12 +159,12 @@ class SWIRLY_API Level
     Level& operator=(Level&&) = delete;
 
     int compare(const Level& rhs) const noexcept { return swirly::compare(key_, rhs.key_); }
-    const Order& first_order() const noexcept { return *first_order_; }
+    const BookQueue& entries() const noexcept { return entries_; }
     LevelKey key() const noexcept { return key_; }
     Ticks ticks() const noexcept { return ticks_; }
     Lots lots() const noexcept { return lots_; }
     int count() const noexcept { return count_; }
-    void set_first_order(const Order& first_order) noexcept { first_order_ = &first_order; }
+    BookQueue& entries() noexcept { return entries_; }
     void reduce(Lots delta) noexcept { lots_ -= delta; }
     void add_order(const Order& order) noexcept;
 
@@ -77,7 +173,10 @@ class SWIRLY_API Level
     boost::intrusive::set_member_hook<> key_hook;
 
   private:
-    const Order* first_order_;
+    /**
+     * Book entries in time priority.
+     */
+    BookQueue entries_;
     const LevelKey key_;
     const Ticks ticks_;
     /**
@@ -90,6 +189,20 @@ class SWIRLY_API Level
     int count_;
 };
 
+/**
+ * Set of price levels ordered from best to worst.
+ *
+ * Levels are linked into an intrusive tree by default. An optional direct-mapped window may be
+ * enabled, in which case the window becomes the primary store for levels whose key falls within it:
+ * those levels are held in a flat array indexed by their offset from the window base, and are not
+ * linked into the tree, so that inserting, finding and removing them is O(1). The tree only holds
+ * levels outside the window.
+ *
+ * An occupancy bitmap allows ordered iteration to skip empty slots a word at a time. Iteration
+ * visits tree levels below the window, then the window, then tree levels above the window. The
+ * window is re-centred when a new best price falls outside it, which moves levels between the
+ * window and the tree.
+ */
 class SWIRLY_API LevelSet {
     struct ValueCompare {
         bool operator()(const Level& lhs, const Level& rhs) const noexcept
@@ -109,9 +222,73 @@ class SWIRLY_API LevelSet {
         = boost::intrusive::set<Level, ConstantTimeSizeOption, CompareOption, MemberHookOption>;
     using ValuePtr = std::unique_ptr<Level>;
 
+    /**
+     * Forward iterator over the window and the tree.
+     */
+    template <typename ValueT>
+    class BasicIterator {
+        friend class LevelSet;
+
+      public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Level;
+        using difference_type = std::ptrdiff_t;
+        using pointer = ValueT*;
+        using reference = ValueT&;
+
+        BasicIterator() noexcept = default;
+
+        // Conversion from mutable to const iterator.
+        template <typename RhsT,
+                  typename = std::enable_if_t<std::is_convertible_v<RhsT*, ValueT*>>>
+        BasicIterator(const BasicIterator<RhsT>& rhs) noexcept
+        : set_{rhs.set_}
+        , level_{rhs.level_}
+        {
+        }
+
+        ValueT& operator*() const noexcept { return *level_; }
+        ValueT* operator->() const noexcept { return level_; }
+
+        BasicIterator& operator++() noexcept
+        {
+            level_ = set_->next(*level_);
+            return *this;
+        }
+        BasicIterator operator++(int) noexcept
+        {
+            auto prev = *this;
+            ++*this;
+            return prev;
+        }
+        friend bool operator==(BasicIterator lhs, BasicIterator rhs) noexcept
+        {
+            return lhs.level_ == rhs.level_;
+        }
+        friend bool operator!=(BasicIterator lhs, BasicIterator rhs) noexcept
+        {
+            return lhs.level_ != rhs.level_;
+        }
+
+      private:
+        BasicIterator(const LevelSet* set, ValueT* level) noexcept
+        : set_{set}
+        , level_{level}
+        {
+        }
+        template <typename>
+        friend class BasicIterator;
+
+        const LevelSet* set_{nullptr};
+        /**
+         * Null at end.
+         */
+        ValueT* level_{nullptr};
+    };
+
   public:
-    using Iterator = typename Set::iterator;
-    using ConstIterator = typename Set::const_iterator;
+    using Iterator = BasicIterator<Level>;
+    using ConstIterator = BasicIterator<const Level>;
 
     LevelSet() = default;
     ~LevelSet();
@@ -125,38 +302,67 @@ class SWIRLY_API LevelSet {
     LevelSet& operator=(LevelSet&&);
 
     // Begin.
-    ConstIterator begin() const noexcept { return set_.begin(); }
-    ConstIterator cbegin() const noexcept { return set_.cbegin(); }
-    Iterator begin() noexcept { return set_.begin(); }
+    ConstIterator begin() const noexcept { return {this, first()}; }
+    ConstIterator cbegin() const noexcept { return {this, first()}; }
+    Iterator begin() noexcept { return {this, first()}; }
 
     // End.
-    ConstIterator end() const noexcept { return set_.end(); }
-    ConstIterator cend() const noexcept { return set_.cend(); }
-    Iterator end() noexcept { return set_.end(); }
+    ConstIterator end() const noexcept { return {this, nullptr}; }
+    ConstIterator cend() const noexcept { return {this, nullptr}; }
+    Iterator end() noexcept { return {this, nullptr}; }
+
+    bool empty() const noexcept { return count_ == 0 && set_.empty(); }
+    /**
+     * Returns the width of the direct-mapped window, or zero if the window is disabled.
+     */
+    std::size_t window() const noexcept { return width_; }
 
     // Find.
     ConstIterator find(Side side, Ticks ticks) const noexcept
     {
-        return set_.find(detail::compose_key(side, ticks), KeyValueCompare());
+        return const_cast<LevelSet*>(this)->find(side, ticks);
     }
     Iterator find(Side side, Ticks ticks) noexcept
     {
-        return set_.find(detail::compose_key(side, ticks), KeyValueCompare());
+        const auto key = detail::compose_key(side, ticks);
+        if (in_window(key)) {
+            // All levels inside the window are held by the window.
+            return {this, window_[key - base_]};
+        }
+        auto it = set_.find(key, KeyValueCompare());
+        return {this, it != set_.end() ? &*it : nullptr};
     }
+    /**
+     * Returns the level matching side and ticks, and true, if it exists. Otherwise returns an
+     * insertion hint and false. Levels inside the window need no hint, so the end iterator is
+     * returned for them; outside the window the hint is the tree's lower bound.
+     */
     std::pair<ConstIterator, bool> find_hint(Side side, Ticks ticks) const noexcept
     {
-        const auto key = detail::compose_key(side, ticks);
-        const auto comp = KeyValueCompare();
-        auto it = set_.lower_bound(key, comp);
-        return std::make_pair(it, it != set_.end() && !comp(key, *it));
+        return const_cast<LevelSet*>(this)->find_hint(side, ticks);
     }
     std::pair<Iterator, bool> find_hint(Side side, Ticks ticks) noexcept
     {
         const auto key = detail::compose_key(side, ticks);
+        if (in_window(key)) {
+            Level* const level{window_[key - base_]};
+            return std::make_pair(Iterator{this, level}, level != nullptr);
+        }
         const auto comp = KeyValueCompare();
         auto it = set_.lower_bound(key, comp);
-        return std::make_pair(it, it != set_.end() && !comp(key, *it));
+        if (it == set_.end()) {
+            return std::make_pair(end(), false);
+        }
+        return std::make_pair(Iterator{this, &*it}, !comp(key, *it));
     }
+    /**
+     * Enable direct-mapped window of the specified width, or disable the window if width is zero.
+     * The window is rebuilt from the existing levels, so this function may be called at any time.
+     *
+     * Throws std::bad_alloc.
+     */
+    void set_window(std::size_t width);
+
     Iterator insert(ValuePtr value) noexcept;
 
     Iterator insert_hint(ConstIterator hint, ValuePtr value) noexcept;
@@ -182,7 +388,92 @@ class SWIRLY_API LevelSet {
     }
 
   private:
+    static constexpr std::size_t WordBits{64};
+
+    bool in_window(LevelKey key) const noexcept
+    {
+        // Unsigned comparison also rejects keys below the base.
+        return static_cast<std::size_t>(key - base_) < width_;
+    }
+    /**
+     * Returns the first occupied window slot at or after pos, or null if there is none.
+     */
+    Level* next_slot(std::size_t pos) const noexcept
+    {
+        if (pos >= width_) {
+            return nullptr;
+        }
+        auto i = pos / WordBits;
+        auto word = bits_[i] & (~std::uint64_t{0} << (pos % WordBits));
+        const auto words = (std::size_t{width_} + WordBits - 1) / WordBits;
+        while (word == 0) {
+            if (++i == words) {
+                return nullptr;
+            }
+            word = bits_[i];
+        }
+        return window_[i * WordBits + __builtin_ctzll(word)];
+    }
+    Level* first() const noexcept
+    {
+        auto it = set_.begin();
+        if (count_ > 0 && (it == set_.end() || it->key() >= base_)) {
+            return next_slot(0);
+        }
+        return it != set_.end() ? const_cast<Level*>(&*it) : nullptr;
+    }
+    Level* next(const Level& level) const noexcept
+    {
+        if (!level.key_hook.is_linked()) {
+            // Held by the window.
+            if (Level* const next_level{next_slot(level.key() - base_ + 1)}) {
+                return next_level;
+            }
+            auto it = set_.lower_bound(base_ + width_, KeyValueCompare());
+            return it != set_.end() ? const_cast<Level*>(&*it) : nullptr;
+        }
+        auto it = std::next(Set::s_iterator_to(level));
+        if (count_ > 0 && level.key() < base_ && (it == set_.end() || it->key() >= base_)) {
+            // Step from the tree into the window.
+            return next_slot(0);
+        }
+        return it != set_.end() ? const_cast<Level*>(&*it) : nullptr;
+    }
+    /**
+     * Place level in its window slot.
+     */
+    void place(Level& level) noexcept;
+    /**
+     * Clear level's window slot.
+     */
+    void unplace(const Level& level) noexcept;
+    /**
+     * Re-centre the window on a tree level that has become the best price, or on any tree level
+     * if the window is empty.
+     */
+    void maybe_slide(const Level& level) noexcept;
+    /**
+     * Centre the window on key. Levels leaving the window are linked into the tree, and tree
+     * levels inside the new window are unlinked and placed in the window.
+     */
+    void slide(LevelKey key) noexcept;
+    /**
+     * Link all levels in the window into the tree, leaving the window empty.
+     */
+    void drain() noexcept;
+
     Set set_;
+    std::unique_ptr<Level*[]> window_;
+    /**
+     * Occupancy bitmap with one bit per window slot.
+     */
+    std::unique_ptr<std::uint64_t[]> bits_;
+    LevelKey base_{0};
+    std::uint32_t width_{0};
+    /**
+     * Number of levels held by the window.
+     */
+    std::uint32_t count_{0};
 };
 
 } // namespace fin
@@ -35,7 +35,7 @@ BOOST_AUTO_TEST_CASE(LevelSetCase)
 
     Level& level1{*s.emplace(order)};
     BOOST_TEST(level1.key() == -12345);
-    BOOST_TEST(s.find(Side::Buy, 12345_tks) != s.end());
+    BOOST_TEST((s.find(Side::Buy, 12345_tks) != s.end()));
 
     // Duplicate.
     Level& level2{*s.emplace(order)};
@@ -47,4 +47,111 @@ BOOST_AUTO_TEST_CASE(LevelSetCase)
     BOOST_TEST(level3.key() == -12345);
 }
 
+BOOST_AUTO_TEST_CASE(LevelWindowCase)
+{
+    auto make_order = [](Ticks ticks) {
+        return Order::make("MARAYL"sv, 1_id64, "EURUSD"sv, 0_jd, 0_id64, ""sv, State::New,
+                           Side::Sell, 10_lts, ticks, 10_lts, 0_lts, 0_cst, 0_lts, 0_tks, 0_lts,
+                           Time{}, Time{});
+    };
+    const auto order1 = make_order(12345_tks);
+    const auto order2 = make_order(12347_tks);
+    const auto order3 = make_order(12400_tks);
+    const auto order4 = make_order(12340_tks);
+
+    LevelSet s;
+    auto& level1 = *s.emplace(*order1);
+    BOOST_TEST(level1.key_hook.is_linked());
+    s.set_window(16);
+    BOOST_TEST(s.window() == 16U);
+
+    // Levels inside the window are held by the window instead of the tree.
+    BOOST_TEST(!level1.key_hook.is_linked());
+    BOOST_TEST(&*s.find(Side::Sell, 12345_tks) == &level1);
+    BOOST_TEST((s.find(Side::Sell, 12346_tks) == s.end()));
+
+    auto hint = s.find_hint(Side::Sell, 12347_tks);
+    BOOST_TEST(!hint.second);
+    auto& level2 = *s.emplace_hint(hint.first, *order2);
+    BOOST_TEST(!level2.key_hook.is_linked());
+    BOOST_TEST(&*s.find(Side::Sell, 12347_tks) == &level2);
+    hint = s.find_hint(Side::Sell, 12347_tks);
+    BOOST_TEST(hint.second);
+    BOOST_TEST(&*hint.first == &level2);
+
+    // Outlier is held by the tree.
+    auto& level3 = *s.emplace(*order3);
+    BOOST_TEST(level3.key_hook.is_linked());
+    BOOST_TEST(&*s.find(Side::Sell, 12400_tks) == &level3);
+
+    // New best price outside the window slides the window, and the level moves into it.
+    auto& level4 = *s.emplace(*order4);
+    BOOST_TEST(!level4.key_hook.is_linked());
+    BOOST_TEST(&*s.begin() == &level4);
+    BOOST_TEST(&*s.find(Side::Sell, 12340_tks) == &level4);
+    BOOST_TEST(&*s.find(Side::Sell, 12347_tks) == &level2);
+
+    // Ordered iteration spans the window and the tree.
+    auto ticks = [&s]() {
+        vector<Ticks> v;
+        for (const auto& level : s) {
+            v.push_back(level.ticks());
+        }
+        return v;
+    };
+    BOOST_TEST(ticks() == (vector<Ticks>{12340_tks, 12345_tks, 12347_tks, 12400_tks}),
+               boost::test_tools::per_element());
+
+    s.remove(level2);
+    BOOST_TEST((s.find(Side::Sell, 12347_tks) == s.end()));
+    BOOST_TEST(ticks() == (vector<Ticks>{12340_tks, 12345_tks, 12400_tks}),
+               boost::test_tools::per_element());
+
+    // Replace inside the window.
+    auto& level5 = *s.emplace_or_replace(*order1);
+    BOOST_TEST(&*s.find(Side::Sell, 12345_tks) == &level5);
+    BOOST_TEST(!level5.key_hook.is_linked());
+
+    // Disable, which returns every level to the tree.
+    s.set_window(0);
+    BOOST_TEST(s.window() == 0U);
+    BOOST_TEST(level4.key_hook.is_linked());
+    BOOST_TEST(level5.key_hook.is_linked());
+    BOOST_TEST(ticks() == (vector<Ticks>{12340_tks, 12345_tks, 12400_tks}),
+               boost::test_tools::per_element());
+}
+
+BOOST_AUTO_TEST_CASE(LevelWindowIterCase)
+{
+    auto make_order = [](Ticks ticks) {
+        return Order::make("MARAYL"sv, 1_id64, "EURUSD"sv, 0_jd, 0_id64, ""sv, State::New,
+                           Side::Sell, 10_lts, ticks, 10_lts, 0_lts, 0_cst, 0_lts, 0_tks, 0_lts,
+                           Time{}, Time{});
+    };
+    LevelSet s;
+    s.set_window(128);
+    // The first level centres the window, leaving a quarter of it below for better prices.
+    s.emplace(*make_order(1000_tks));
+    s.emplace(*make_order(1100_tks));
+    // Worse than the window.
+    s.emplace(*make_order(1200_tks));
+    // Better than the best level by less than a quarter of the window, so no slide is required.
+    auto& level = *s.emplace(*make_order(990_tks));
+    BOOST_TEST(!level.key_hook.is_linked());
+
+    vector<Ticks> ticks;
+    for (const auto& level : s) {
+        ticks.push_back(level.ticks());
+    }
+    BOOST_TEST(ticks == (vector<Ticks>{990_tks, 1000_tks, 1100_tks, 1200_tks}),
+               boost::test_tools::per_element());
+
+    // Removing every window level leaves the tree to be iterated.
+    s.remove(*s.find(Side::Sell, 990_tks));
+    s.remove(*s.find(Side::Sell, 1000_tks));
+    s.remove(*s.find(Side::Sell, 1100_tks));
+    BOOST_TEST(&*s.begin() == &*s.find(Side::Sell, 1200_tks));
+    BOOST_TEST((++s.begin() == s.end()));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -25,19 +25,20 @@ namespace swirly {
 inline namespace fin {
 using namespace std;
 
-static_assert(sizeof(Market) <= 4 * 64, "no greater than specified cache-lines");
+// Excluding the depth snapshots, whose size depends on the configured number of levels.
+static_assert(sizeof(Market) <= 4 * 64 + 2 * (sizeof(MarketSide) - sizeof(LevelSet)),
+              "no greater than specified cache-lines");
 
 namespace {
 template <typename FnT>
-void to_json_levels(LevelSet::ConstIterator it, LevelSet::ConstIterator end, ostream& os, FnT fn)
+void to_json_levels(ArrayView<DepthLevel> depth, ostream& os, FnT fn)
 {
     for (size_t i{0}; i < MaxLevels; ++i) {
         if (i > 0) {
             os << ',';
         }
-        if (it != end) {
-            os << fn(*it);
-            ++it;
+        if (i < depth.size()) {
+            os << fn(depth[i]);
         } else {
             os << "null";
         }
@@ -91,27 +92,21 @@ void Market::to_json(ostream& os) const
         os << ",\"last_lots\":null,\"last_ticks\":null,\"last_time\":null";
     }
 
-    const auto& bid_levels = bid_side_.levels();
+    const auto bid_depth = bid_side_.depth();
     os << ",\"bid_ticks\":[";
-    to_json_levels(bid_levels.begin(), bid_levels.end(), os,
-                   [](const auto& level) { return level.ticks(); });
+    to_json_levels(bid_depth, os, [](const auto& level) { return level.ticks; });
     os << "],\"bid_lots\":[";
-    to_json_levels(bid_levels.begin(), bid_levels.end(), os,
-                   [](const auto& level) { return level.lots(); });
+    to_json_levels(bid_depth, os, [](const auto& level) { return level.lots; });
     os << "],\"bid_count\":[";
-    to_json_levels(bid_levels.begin(), bid_levels.end(), os,
-                   [](const auto& level) { return level.count(); });
+    to_json_levels(bid_depth, os, [](const auto& level) { return level.count; });
 
-    const auto& offer_levels = offer_side_.levels();
+    const auto offer_depth = offer_side_.depth();
     os << "],\"offer_ticks\":[";
-    to_json_levels(offer_levels.begin(), offer_levels.end(), os,
-                   [](const auto& level) { return level.ticks(); });
+    to_json_levels(offer_depth, os, [](const auto& level) { return level.ticks; });
     os << "],\"offer_lots\":[";
-    to_json_levels(offer_levels.begin(), offer_levels.end(), os,
-                   [](const auto& level) { return level.lots(); });
+    to_json_levels(offer_depth, os, [](const auto& level) { return level.lots; });
     os << "],\"offer_count\":[";
-    to_json_levels(offer_levels.begin(), offer_levels.end(), os,
-                   [](const auto& level) { return level.count(); });
+    to_json_levels(offer_depth, os, [](const auto& level) { return level.count; });
     os << "]}";
 }
 
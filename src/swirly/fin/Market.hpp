@@ -74,8 +74,24 @@ class SWIRLY_API Market
     const MarketSide& bid_side() const noexcept { return bid_side_; }
     const MarketSide& offer_side() const noexcept { return offer_side_; }
     Id64 max_id() const noexcept { return max_id_; }
+    /**
+     * Returns a sequence number that changes whenever the depth snapshot on either side changes,
+     * so that readers can cheaply skip an unchanged book.
+     */
+    std::uint64_t seq() const noexcept { return bid_side_.seq() + offer_side_.seq(); }
 
     void set_state(MarketState state) noexcept { state_ = state; }
+    /**
+     * Index price levels on both sides using a direct-mapped window of the specified width. A
+     * width of zero disables the window.
+     *
+     * Throws std::bad_alloc.
+     */
+    void set_level_window(std::size_t width)
+    {
+        bid_side_.levels().set_window(width);
+        offer_side_.levels().set_window(width);
+    }
     MarketSide& bid_side() noexcept { return bid_side_; }
     MarketSide& offer_side() noexcept { return offer_side_; }
     /**
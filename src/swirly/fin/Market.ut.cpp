@@ -20,6 +20,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+using namespace std;
 using namespace swirly;
 
 BOOST_AUTO_TEST_SUITE(MarketSuite)
@@ -66,4 +67,105 @@ BOOST_AUTO_TEST_CASE(MarketToStringNullCase)
                "}");
 }
 
+BOOST_AUTO_TEST_CASE(MarketSideQueueCase)
+{
+    auto make_order = [](Id64 id, Ticks ticks) {
+        return Order::make("MARAYL"sv, 1_id64, "EURUSD"sv, 0_jd, id, ""sv, State::New, Side::Sell,
+                           10_lts, ticks, 10_lts, 0_lts, 0_cst, 0_lts, 0_tks, 0_lts, Time{},
+                           Time{});
+    };
+    auto ids = [](const Level& level) {
+        vector<Id64> v;
+        for (const auto& entry : level.entries()) {
+            v.push_back(entry.order()->id());
+        }
+        return v;
+    };
+    const auto order1 = make_order(1_id64, 12345_tks);
+    const auto order2 = make_order(2_id64, 12345_tks);
+    const auto order3 = make_order(3_id64, 12345_tks);
+    const auto order4 = make_order(4_id64, 12346_tks);
+
+    MarketSide side;
+    side.insert_order(order1);
+    side.insert_order(order4);
+    side.insert_order(order2);
+    side.insert_order(order3);
+
+    auto& level = *side.levels().find(Side::Sell, 12345_tks);
+    BOOST_TEST(level.count() == 3);
+    BOOST_TEST(level.lots() == 30_lts);
+    BOOST_TEST(ids(level) == (vector<Id64>{1_id64, 2_id64, 3_id64}),
+               boost::test_tools::per_element());
+    BOOST_TEST(ids(*side.levels().find(Side::Sell, 12346_tks)) == (vector<Id64>{4_id64}),
+               boost::test_tools::per_element());
+
+    // Entry mirrors the residual.
+    side.revise_order(*order2, 7_lts, Time{});
+    BOOST_TEST(order2->entry()->resd_lots() == 7_lts);
+    BOOST_TEST(level.lots() == 27_lts);
+
+    // Cancel from the back of the queue.
+    side.cancel_order(*order3, Time{});
+    BOOST_TEST(order3->level() == nullptr);
+    BOOST_TEST(order3->entry() == nullptr);
+    BOOST_TEST(ids(level) == (vector<Id64>{1_id64, 2_id64}), boost::test_tools::per_element());
+
+    // Fill from the front of the queue.
+    side.take_order(*order1, 10_lts, Time{});
+    BOOST_TEST(ids(level) == (vector<Id64>{2_id64}), boost::test_tools::per_element());
+    BOOST_TEST(level.lots() == 7_lts);
+
+    // Level is removed with its last order.
+    side.cancel_order(*order2, Time{});
+    BOOST_TEST((side.levels().find(Side::Sell, 12345_tks) == side.levels().end()));
+    BOOST_TEST(&*side.levels().begin() == order4->level());
+}
+
+BOOST_AUTO_TEST_CASE(MarketSideDepthCase)
+{
+    auto make_order = [](Id64 id, Ticks ticks) {
+        return Order::make("MARAYL"sv, 1_id64, "EURUSD"sv, 0_jd, id, ""sv, State::New, Side::Buy,
+                           10_lts, ticks, 10_lts, 0_lts, 0_cst, 0_lts, 0_tks, 0_lts, Time{},
+                           Time{});
+    };
+    const auto order1 = make_order(1_id64, 12345_tks);
+    const auto order2 = make_order(2_id64, 12344_tks);
+    const auto order3 = make_order(3_id64, 12343_tks);
+    const auto order4 = make_order(4_id64, 12342_tks);
+    const auto order5 = make_order(5_id64, 12345_tks);
+
+    MarketSide side;
+    BOOST_TEST(side.depth().empty());
+
+    side.insert_order(order4);
+    side.insert_order(order3);
+    side.insert_order(order2);
+    BOOST_TEST(side.depth().size() == MaxLevels);
+    BOOST_TEST(side.depth()[0].ticks == 12344_tks);
+
+    // New best bid.
+    side.insert_order(order1);
+    BOOST_TEST(side.depth()[0].ticks == 12345_tks);
+    BOOST_TEST(side.depth()[2].ticks == 12343_tks);
+
+    // Changes beyond the snapshot do not affect it.
+    auto seq = side.seq();
+    side.revise_order(*order4, 5_lts, Time{});
+    BOOST_TEST(side.seq() == seq);
+
+    side.insert_order(order5);
+    BOOST_TEST(side.seq() > seq);
+    BOOST_TEST(side.depth()[0].lots == 20_lts);
+    BOOST_TEST(side.depth()[0].count == 2);
+
+    // Level removal exposes the next level.
+    seq = side.seq();
+    side.cancel_order(*order2, Time{});
+    BOOST_TEST(side.seq() > seq);
+    BOOST_TEST(side.depth()[1].ticks == 12343_tks);
+    BOOST_TEST(side.depth()[2].ticks == 12342_tks);
+    BOOST_TEST(side.depth()[2].lots == 5_lts);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -33,6 +33,25 @@ constexpr Id64 to_market_id(Id32 instr_id, IsoDate settl_date) noexcept
     return to_market_id(instr_id, maybe_iso_to_jd(settl_date));
 }
 
+/**
+ * Returns the market-id of the rolled position for the market's instrument. Positions in settled
+ * markets are rolled into a single position per instrument, which has no settlement-day.
+ */
+constexpr Id64 to_rolled_id(Id64 market_id) noexcept
+{
+    return Id64{market_id.count() & ~0xffff};
+}
+
+/**
+ * Returns true if a market with the specified settlement-day has settled by the business-day. A
+ * market remains open on its settlement-day. Both the application and the models use this cutoff,
+ * so that positions rolled at end of day are rolled in the same way when the model is loaded.
+ */
+constexpr bool is_settled(JDay settl_day, JDay bus_day) noexcept
+{
+    return settl_day != 0_jd && settl_day < bus_day;
+}
+
 template <typename ValueT>
 struct MarketIdTraits {
     using Id = Id64;
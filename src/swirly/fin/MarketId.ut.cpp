@@ -28,4 +28,19 @@ BOOST_AUTO_TEST_CASE(to_market_id_case)
     BOOST_TEST(id == 0xabcdef_id64);
 }
 
+BOOST_AUTO_TEST_CASE(to_rolled_id_case)
+{
+    BOOST_TEST(to_rolled_id(0xabcdef_id64) == 0xab0000_id64);
+}
+
+BOOST_AUTO_TEST_CASE(is_settled_case)
+{
+    // Markets without a settlement-day never settle.
+    BOOST_TEST(!is_settled(0_jd, 2492719_jd));
+    // Markets remain open on their settlement-day.
+    BOOST_TEST(!is_settled(2492719_jd, 2492718_jd));
+    BOOST_TEST(!is_settled(2492719_jd, 2492719_jd));
+    BOOST_TEST(is_settled(2492719_jd, 2492720_jd));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
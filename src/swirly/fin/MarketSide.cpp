@@ -33,19 +33,16 @@ void MarketSide::insert_order(const OrderPtr& order)
     assert(order->lots() > 0_lts);
     assert(order->min_lots() >= 0_lts);
 
-    auto it = insert_level(order);
-    // Next level.
-    ++it;
-    if (it != levels_.end()) {
-        // Insert order after the level's last order.
-        // I.e. insert order before the next level's first order.
-        orders_.insert_before(order, it->first_order());
-    } else {
-        orders_.insert_back(order);
-    }
+    // Allocate entry before the level is modified, so that a failure leaves the side unchanged.
+    auto entry = make_unique<BookEntry>(order);
+    // The level insert may fail, so the order is only associated with the entry once it succeeds.
+    auto& level = insert_level(order);
+    order->set_entry(entry.get());
+    // Append entry to the back of the level's queue.
+    level.entries().insert_back(move(entry));
 }
 
-LevelSet::Iterator MarketSide::insert_level(const OrderPtr& order)
+Level& MarketSide::insert_level(const OrderPtr& order)
 {
     LevelSet::Iterator it;
     bool found;
@@ -56,27 +53,34 @@ LevelSet::Iterator MarketSide::insert_level(const OrderPtr& order)
         it->add_order(*order);
     }
     order->set_level(&*it);
-    return it;
+    if (in_depth(it->key())) {
+        update_depth();
+    }
+    return *it;
 }
 
 void MarketSide::remove_order(Level& level, const Order& order) noexcept
 {
+    const bool depth{in_depth(level.key())};
     level.sub_order(order);
 
+    // Unlink entry before its level is destroyed. The entry holds a reference to the order, so it
+    // is kept until the end of scope.
+    const auto entry = level.entries().remove(*order.entry());
+
     if (level.count() == 0) {
         // Remove level.
         assert(level.lots() == 0_lts);
         levels_.remove(level);
-    } else if (&level.first_order() == &order) {
-        // First order at this level is being removed.
-        auto it = OrderList::to_iterator(order);
-        level.set_first_order(*++it);
     }
 
-    orders_.remove(order);
-
     // No longer associated with side.
     order.set_level(nullptr);
+    order.set_entry(nullptr);
+
+    if (depth) {
+        update_depth();
+    }
 }
 
 void MarketSide::reduce_level(Level& level, const Order& order, Lots delta) noexcept
@@ -87,11 +91,29 @@ void MarketSide::reduce_level(Level& level, const Order& order, Lots delta) noex
     if (delta < order.resd_lots()) {
         // Reduce level's resd by delta.
         level.reduce(delta);
+        order.entry()->reduce(delta);
+        if (in_depth(level.key())) {
+            update_depth();
+        }
     } else {
         assert(delta == order.resd_lots());
         remove_order(level, order);
     }
 }
 
+void MarketSide::update_depth() noexcept
+{
+    size_t i{0};
+    for (const auto& level : levels_) {
+        if (i == MaxLevels) {
+            break;
+        }
+        depth_[i++] = {level.ticks(), level.lots(), level.count()};
+        depth_key_ = level.key();
+    }
+    depth_size_ = i;
+    ++seq_;
+}
+
 } // namespace fin
 } // namespace swirly
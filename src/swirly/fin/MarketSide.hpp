@@ -20,9 +20,22 @@
 #include <swirly/fin/Level.hpp>
 #include <swirly/fin/Order.hpp>
 
+#include <swirly/util/Array.hpp>
+
+#include <array>
+
 namespace swirly {
 inline namespace fin {
 
+/**
+ * Copy of a single price level held in a depth snapshot.
+ */
+struct DepthLevel {
+    Ticks ticks;
+    Lots lots;
+    int count;
+};
+
 class SWIRLY_API MarketSide {
   public:
     MarketSide() = default;
@@ -38,9 +51,16 @@ class SWIRLY_API MarketSide {
     MarketSide& operator=(MarketSide&&) = delete;
 
     const LevelSet& levels() const noexcept { return levels_; }
-    const OrderList& orders() const noexcept { return orders_; }
     LevelSet& levels() noexcept { return levels_; }
-    OrderList& orders() noexcept { return orders_; }
+    /**
+     * Returns a snapshot of the best MaxLevels price levels, best first. The snapshot is only
+     * rebuilt when one of those levels is modified, so readers do not walk the level tree.
+     */
+    ArrayView<DepthLevel> depth() const noexcept { return {depth_.data(), depth_size_}; }
+    /**
+     * Returns a sequence number that is incremented whenever the depth snapshot changes.
+     */
+    std::uint64_t seq() const noexcept { return seq_; }
 
     /**
      * Insert order into side. Assumes that the order does not already belong to a side. I.e. it
@@ -111,14 +131,27 @@ class SWIRLY_API MarketSide {
      *
      * Throws std::bad_alloc.
      */
-    LevelSet::Iterator insert_level(const OrderPtr& order);
+    Level& insert_level(const OrderPtr& order);
 
     void remove_order(Level& level, const Order& order) noexcept;
 
     void reduce_level(Level& level, const Order& order, Lots delta) noexcept;
 
+    /**
+     * Returns true if a level with the specified key is, or would be, within the depth snapshot.
+     */
+    bool in_depth(LevelKey key) const noexcept
+    {
+        return depth_size_ < MaxLevels || key <= depth_key_;
+    }
+    void update_depth() noexcept;
+
     LevelSet levels_;
-    OrderList orders_;
+    std::array<DepthLevel, MaxLevels> depth_{};
+    std::size_t depth_size_{0};
+    // Key of the last level in a full snapshot.
+    LevelKey depth_key_{0};
+    std::uint64_t seq_{0};
 };
 
 } // namespace fin
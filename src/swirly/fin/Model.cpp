@@ -16,10 +16,30 @@
  */
 #include "Model.hpp"
 
+#include <swirly/fin/Exec.hpp>
+
 namespace swirly {
 inline namespace fin {
+using namespace std;
 
 Model::~Model() = default;
 
+bool Model::do_concurrent() const noexcept
+{
+    return false;
+}
+
+void Model::do_read_accnt_exec(Symbol accnt, Time since, size_t limit,
+                               const ModelCallback<ExecPtr>& cb) const
+{
+    size_t n{0};
+    do_read_exec(since, [accnt, limit, &cb, &n](ExecPtr ptr) {
+        if (n < limit && ptr->accnt() == accnt) {
+            ++n;
+            cb(std::move(ptr));
+        }
+    });
+}
+
 } // namespace fin
 } // namespace swirly
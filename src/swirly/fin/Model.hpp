@@ -20,6 +20,7 @@
 #include <swirly/fin/Types.hpp>
 
 #include <swirly/util/Date.hpp>
+#include <swirly/util/Symbol.hpp>
 #include <swirly/util/Time.hpp>
 
 namespace swirly {
@@ -45,11 +46,25 @@ class SWIRLY_API Model {
     constexpr Model(Model&&) noexcept = default;
     Model& operator=(Model&&) noexcept = default;
 
+    /**
+     * Returns true if the read methods may be called concurrently from different threads. The
+     * objects passed to each callback must then be independent of those passed by other reads.
+     */
+    bool concurrent() const noexcept { return do_concurrent(); }
+
     void read_asset(const ModelCallback<AssetPtr>& cb) const { do_read_asset(cb); }
     void read_instr(const ModelCallback<InstrPtr>& cb) const { do_read_instr(cb); }
     void read_market(const ModelCallback<MarketPtr>& cb) const { do_read_market(cb); }
     void read_order(const ModelCallback<OrderPtr>& cb) const { do_read_order(cb); }
     void read_exec(Time since, const ModelCallback<ExecPtr>& cb) const { do_read_exec(since, cb); }
+    /**
+     * Read at most limit of the account's execs that were created after since, most recent first.
+     */
+    void read_accnt_exec(Symbol accnt, Time since, std::size_t limit,
+                         const ModelCallback<ExecPtr>& cb) const
+    {
+        do_read_accnt_exec(accnt, since, limit, cb);
+    }
     void read_trade(const ModelCallback<ExecPtr>& cb) const { do_read_trade(cb); }
     void read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const
     {
@@ -57,6 +72,8 @@ class SWIRLY_API Model {
     }
 
   protected:
+    virtual bool do_concurrent() const noexcept;
+
     virtual void do_read_asset(const ModelCallback<AssetPtr>& cb) const = 0;
 
     virtual void do_read_instr(const ModelCallback<InstrPtr>& cb) const = 0;
@@ -67,6 +84,12 @@ class SWIRLY_API Model {
 
     virtual void do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const = 0;
 
+    /**
+     * The default implementation filters the execs read since the specified time.
+     */
+    virtual void do_read_accnt_exec(Symbol accnt, Time since, std::size_t limit,
+                                    const ModelCallback<ExecPtr>& cb) const;
+
     virtual void do_read_trade(const ModelCallback<ExecPtr>& cb) const = 0;
 
     virtual void do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const = 0;
@@ -15,3 +15,383 @@
  * 02110-1301, USA.
  */
 #include "Msg.hpp"
+
+#include <swirly/fin/Exec.hpp>
+
+#include <swirly/util/String.hpp>
+
+namespace swirly {
+inline namespace fin {
+using namespace std;
+namespace {
+
+// Presence bits for the optional fields of an exec.
+enum : uint32_t {
+    AccntBit = 1 << 0,
+    MarketIdBit = 1 << 1,
+    InstrBit = 1 << 2,
+    SettlDayBit = 1 << 3,
+    IdBit = 1 << 4,
+    OrderIdBit = 1 << 5,
+    RefBit = 1 << 6,
+    StateBit = 1 << 7,
+    SideBit = 1 << 8,
+    LotsBit = 1 << 9,
+    TicksBit = 1 << 10,
+    ResdLotsBit = 1 << 11,
+    ExecLotsBit = 1 << 12,
+    ExecCostBit = 1 << 13,
+    LastLotsBit = 1 << 14,
+    LastTicksBit = 1 << 15,
+    MinLotsBit = 1 << 16,
+    MatchIdBit = 1 << 17,
+    PosnLotsBit = 1 << 18,
+    PosnCostBit = 1 << 19,
+    LiqIndBit = 1 << 20,
+    CptyBit = 1 << 21,
+    CreatedBit = 1 << 22
+};
+
+constexpr size_t HeaderSize{3};
+
+class Encoder {
+  public:
+    Encoder(char* buf, MsgType type) noexcept
+    : buf_{buf}
+    , p_{reinterpret_cast<unsigned char*>(buf) + HeaderSize}
+    {
+        buf_[2] = static_cast<char>(type);
+    }
+    void put_uint(uint64_t val) noexcept
+    {
+        while (val >= 0x80) {
+            *p_++ = static_cast<unsigned char>(val | 0x80);
+            val >>= 7;
+        }
+        *p_++ = static_cast<unsigned char>(val);
+    }
+    void put_int(int64_t val) noexcept
+    {
+        // Zig-zag encoding keeps small negative values small.
+        put_uint((static_cast<uint64_t>(val) << 1) ^ static_cast<uint64_t>(val >> 63));
+    }
+    template <typename ValueT>
+    void put(ValueT val) noexcept
+    {
+        if constexpr (is_enum_v<ValueT>) {
+            put_int(static_cast<int64_t>(val));
+        } else {
+            put_int(val.count());
+        }
+    }
+    void put(string_view sv) noexcept
+    {
+        *p_++ = static_cast<unsigned char>(sv.size());
+        memcpy(p_, sv.data(), sv.size());
+        p_ += sv.size();
+    }
+    size_t finish() noexcept
+    {
+        const size_t size = reinterpret_cast<char*>(p_) - buf_;
+        assert(size <= MaxMsgSize);
+        buf_[0] = static_cast<char>(size);
+        buf_[1] = static_cast<char>(size >> 8);
+        return size;
+    }
+
+  private:
+    char* const buf_;
+    unsigned char* p_;
+};
+
+class Decoder {
+  public:
+    explicit Decoder(const char* buf) noexcept
+    : p_{reinterpret_cast<const unsigned char*>(buf) + HeaderSize}
+    {
+    }
+    uint64_t get_uint() noexcept
+    {
+        uint64_t val{0};
+        for (int shift{0};; shift += 7) {
+            const auto c = *p_++;
+            val |= static_cast<uint64_t>(c & 0x7f) << shift;
+            if (!(c & 0x80)) {
+                break;
+            }
+        }
+        return val;
+    }
+    int64_t get_int() noexcept
+    {
+        const auto val = get_uint();
+        return static_cast<int64_t>(val >> 1) ^ -static_cast<int64_t>(val & 1);
+    }
+    template <typename ValueT>
+    ValueT get() noexcept
+    {
+        if constexpr (is_enum_v<ValueT>) {
+            return static_cast<ValueT>(get_int());
+        } else {
+            return ValueT{get_int()};
+        }
+    }
+    template <size_t SizeN>
+    void get(char (&dst)[SizeN]) noexcept
+    {
+        const size_t len{*p_++};
+        assert(len <= SizeN);
+        memcpy(dst, p_, len);
+        p_ += len;
+    }
+
+  private:
+    const unsigned char* p_;
+};
+
+template <typename ExecT>
+size_t encode_exec(char* buf, const ExecT& exec) noexcept
+{
+    const auto accnt = +exec.accnt();
+    const auto instr = +exec.instr();
+    const auto ref = exec.ref();
+    const auto cpty = +exec.cpty();
+    const auto created = ms_since_epoch(exec.created());
+
+    uint32_t bits{0};
+    const auto set = [&bits](uint32_t bit, bool cond) noexcept {
+        if (cond) {
+            bits |= bit;
+        }
+    };
+    set(AccntBit, !accnt.empty());
+    set(MarketIdBit, exec.market_id() != 0_id64);
+    set(InstrBit, !instr.empty());
+    set(SettlDayBit, exec.settl_day() != 0_jd);
+    set(IdBit, exec.id() != 0_id64);
+    set(OrderIdBit, exec.order_id() != 0_id64);
+    set(RefBit, !ref.empty());
+    set(StateBit, exec.state() != State::None);
+    set(SideBit, exec.side() != Side::None);
+    set(LotsBit, exec.lots() != 0_lts);
+    set(TicksBit, exec.ticks() != 0_tks);
+    set(ResdLotsBit, exec.resd_lots() != 0_lts);
+    set(ExecLotsBit, exec.exec_lots() != 0_lts);
+    set(ExecCostBit, exec.exec_cost() != 0_cst);
+    set(LastLotsBit, exec.last_lots() != 0_lts);
+    set(LastTicksBit, exec.last_ticks() != 0_tks);
+    set(MinLotsBit, exec.min_lots() != 0_lts);
+    set(MatchIdBit, exec.match_id() != 0_id64);
+    set(PosnLotsBit, exec.posn_lots() != 0_lts);
+    set(PosnCostBit, exec.posn_cost() != 0_cst);
+    set(LiqIndBit, exec.liq_ind() != LiqInd::None);
+    set(CptyBit, !cpty.empty());
+    set(CreatedBit, created != 0);
+
+    Encoder enc{buf, MsgType::CreateExec};
+    enc.put_uint(bits);
+    // clang-format off
+    if (bits & AccntBit) { enc.put(accnt); }
+    if (bits & MarketIdBit) { enc.put(exec.market_id()); }
+    if (bits & InstrBit) { enc.put(instr); }
+    if (bits & SettlDayBit) { enc.put(exec.settl_day()); }
+    if (bits & IdBit) { enc.put(exec.id()); }
+    if (bits & OrderIdBit) { enc.put(exec.order_id()); }
+    if (bits & RefBit) { enc.put(ref); }
+    if (bits & StateBit) { enc.put(exec.state()); }
+    if (bits & SideBit) { enc.put(exec.side()); }
+    if (bits & LotsBit) { enc.put(exec.lots()); }
+    if (bits & TicksBit) { enc.put(exec.ticks()); }
+    if (bits & ResdLotsBit) { enc.put(exec.resd_lots()); }
+    if (bits & ExecLotsBit) { enc.put(exec.exec_lots()); }
+    if (bits & ExecCostBit) { enc.put(exec.exec_cost()); }
+    if (bits & LastLotsBit) { enc.put(exec.last_lots()); }
+    if (bits & LastTicksBit) { enc.put(exec.last_ticks()); }
+    if (bits & MinLotsBit) { enc.put(exec.min_lots()); }
+    if (bits & MatchIdBit) { enc.put(exec.match_id()); }
+    if (bits & PosnLotsBit) { enc.put(exec.posn_lots()); }
+    if (bits & PosnCostBit) { enc.put(exec.posn_cost()); }
+    if (bits & LiqIndBit) { enc.put(exec.liq_ind()); }
+    if (bits & CptyBit) { enc.put(cpty); }
+    if (bits & CreatedBit) { enc.put_int(created); }
+    // clang-format on
+    return enc.finish();
+}
+
+/**
+ * Adapts the body of a CreateExec message to the accessors of Exec, so that both can share the same
+ * encoding.
+ */
+class ExecView {
+  public:
+    explicit ExecView(const CreateExec& body) noexcept
+    : body_{body}
+    {
+    }
+    Symbol accnt() const noexcept { return Symbol{to_string_view(body_.accnt)}; }
+    Id64 market_id() const noexcept { return body_.market_id; }
+    Symbol instr() const noexcept { return Symbol{to_string_view(body_.instr)}; }
+    JDay settl_day() const noexcept { return body_.settl_day; }
+    Id64 id() const noexcept { return body_.id; }
+    Id64 order_id() const noexcept { return body_.order_id; }
+    string_view ref() const noexcept { return to_string_view(body_.ref); }
+    State state() const noexcept { return body_.state; }
+    Side side() const noexcept { return body_.side; }
+    Lots lots() const noexcept { return body_.lots; }
+    Ticks ticks() const noexcept { return body_.ticks; }
+    Lots resd_lots() const noexcept { return body_.resd_lots; }
+    Lots exec_lots() const noexcept { return body_.exec_lots; }
+    Cost exec_cost() const noexcept { return body_.exec_cost; }
+    Lots last_lots() const noexcept { return body_.last_lots; }
+    Ticks last_ticks() const noexcept { return body_.last_ticks; }
+    Lots min_lots() const noexcept { return body_.min_lots; }
+    Id64 match_id() const noexcept { return body_.match_id; }
+    Lots posn_lots() const noexcept { return body_.posn_lots; }
+    Cost posn_cost() const noexcept { return body_.posn_cost; }
+    LiqInd liq_ind() const noexcept { return body_.liq_ind; }
+    Symbol cpty() const noexcept { return Symbol{to_string_view(body_.cpty)}; }
+    Time created() const noexcept { return to_time(Millis{body_.created}); }
+
+  private:
+    const CreateExec& body_;
+};
+
+} // namespace
+
+size_t encode_create_market(char* buf, Id64 id, Symbol instr, JDay settl_day,
+                            MarketState state) noexcept
+{
+    Encoder enc{buf, MsgType::CreateMarket};
+    enc.put(id);
+    enc.put(+instr);
+    enc.put(settl_day);
+    enc.put_uint(state);
+    return enc.finish();
+}
+
+size_t encode_update_market(char* buf, Id64 id, MarketState state) noexcept
+{
+    Encoder enc{buf, MsgType::UpdateMarket};
+    enc.put(id);
+    enc.put_uint(state);
+    return enc.finish();
+}
+
+size_t encode_create_exec(char* buf, const Exec& exec) noexcept
+{
+    return encode_exec(buf, exec);
+}
+
+size_t encode_archive_trade(char* buf, Id64 market_id, ArrayView<Id64> ids,
+                            Time modified) noexcept
+{
+    assert(ids.size() <= MaxIds);
+    Encoder enc{buf, MsgType::ArchiveTrade};
+    enc.put(market_id);
+    enc.put_int(ms_since_epoch(modified));
+    enc.put_uint(ids.size());
+    for (const auto id : ids) {
+        enc.put(id);
+    }
+    return enc.finish();
+}
+
+size_t encode_msg(char* buf, const Msg& msg) noexcept
+{
+    size_t size{0};
+    switch (msg.type) {
+    case MsgType::CreateMarket: {
+        const auto& body = msg.create_market;
+        size = encode_create_market(buf, body.id, Symbol{to_string_view(body.instr)},
+                                    body.settl_day, body.state);
+    } break;
+    case MsgType::UpdateMarket: {
+        const auto& body = msg.update_market;
+        size = encode_update_market(buf, body.id, body.state);
+    } break;
+    case MsgType::CreateExec:
+        size = encode_exec(buf, ExecView{msg.create_exec});
+        break;
+    case MsgType::ArchiveTrade: {
+        const auto& body = msg.archive_trade;
+        // The list of ids is terminated by the first zero id, if any.
+        size_t n{0};
+        while (n < MaxIds && body.ids[n] != 0_id64) {
+            ++n;
+        }
+        Encoder enc{buf, MsgType::ArchiveTrade};
+        enc.put(body.market_id);
+        enc.put_int(body.modified);
+        enc.put_uint(n);
+        for (size_t i{0}; i < n; ++i) {
+            enc.put(body.ids[i]);
+        }
+        size = enc.finish();
+    } break;
+    }
+    return size;
+}
+
+void decode_msg(const char* buf, Msg& msg) noexcept
+{
+    memset(&msg, 0, sizeof(msg));
+    msg.type = static_cast<MsgType>(buf[2] & 0x7f);
+
+    Decoder dec{buf};
+    switch (msg.type) {
+    case MsgType::CreateMarket: {
+        auto& body = msg.create_market;
+        body.id = dec.get<Id64>();
+        dec.get(body.instr);
+        body.settl_day = dec.get<JDay>();
+        body.state = dec.get_uint();
+    } break;
+    case MsgType::UpdateMarket: {
+        auto& body = msg.update_market;
+        body.id = dec.get<Id64>();
+        body.state = dec.get_uint();
+    } break;
+    case MsgType::CreateExec: {
+        auto& body = msg.create_exec;
+        const auto bits = dec.get_uint();
+        // clang-format off
+        if (bits & AccntBit) { dec.get(body.accnt); }
+        if (bits & MarketIdBit) { body.market_id = dec.get<Id64>(); }
+        if (bits & InstrBit) { dec.get(body.instr); }
+        if (bits & SettlDayBit) { body.settl_day = dec.get<JDay>(); }
+        if (bits & IdBit) { body.id = dec.get<Id64>(); }
+        if (bits & OrderIdBit) { body.order_id = dec.get<Id64>(); }
+        if (bits & RefBit) { dec.get(body.ref); }
+        if (bits & StateBit) { body.state = dec.get<State>(); }
+        if (bits & SideBit) { body.side = dec.get<Side>(); }
+        if (bits & LotsBit) { body.lots = dec.get<Lots>(); }
+        if (bits & TicksBit) { body.ticks = dec.get<Ticks>(); }
+        if (bits & ResdLotsBit) { body.resd_lots = dec.get<Lots>(); }
+        if (bits & ExecLotsBit) { body.exec_lots = dec.get<Lots>(); }
+        if (bits & ExecCostBit) { body.exec_cost = dec.get<Cost>(); }
+        if (bits & LastLotsBit) { body.last_lots = dec.get<Lots>(); }
+        if (bits & LastTicksBit) { body.last_ticks = dec.get<Ticks>(); }
+        if (bits & MinLotsBit) { body.min_lots = dec.get<Lots>(); }
+        if (bits & MatchIdBit) { body.match_id = dec.get<Id64>(); }
+        if (bits & PosnLotsBit) { body.posn_lots = dec.get<Lots>(); }
+        if (bits & PosnCostBit) { body.posn_cost = dec.get<Cost>(); }
+        if (bits & LiqIndBit) { body.liq_ind = dec.get<LiqInd>(); }
+        if (bits & CptyBit) { dec.get(body.cpty); }
+        if (bits & CreatedBit) { body.created = dec.get_int(); }
+        // clang-format on
+    } break;
+    case MsgType::ArchiveTrade: {
+        auto& body = msg.archive_trade;
+        body.market_id = dec.get<Id64>();
+        body.modified = dec.get_int();
+        const auto n = dec.get_uint();
+        assert(n <= MaxIds);
+        for (size_t i{0}; i < n; ++i) {
+            body.ids[i] = dec.get<Id64>();
+        }
+    } break;
+    }
+}
+
+} // namespace fin
+} // namespace swirly
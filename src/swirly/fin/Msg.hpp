@@ -23,10 +23,13 @@
 
 #include <swirly/util/BasicTypes.hpp>
 #include <swirly/util/Date.hpp>
+#include <swirly/util/Array.hpp>
 #include <swirly/util/Symbol.hpp>
+#include <swirly/util/Time.hpp>
 
 namespace swirly {
 inline namespace fin {
+class Exec;
 
 enum class MsgType : int { CreateMarket, UpdateMarket, CreateExec, ArchiveTrade };
 
@@ -93,6 +96,65 @@ struct SWIRLY_PACKED Msg {
 static_assert(std::is_pod_v<Msg>);
 static_assert(sizeof(Msg) == 252, "must be specific size");
 
+/**
+ * Upper bound on the size of an encoded message.
+ *
+ * Messages are encoded as variable-length records. Each record starts with a two-byte length and
+ * a one-byte type, the top bit of which marks all but the last message of a batch. Integers are
+ * encoded as varints, strings are length-prefixed and stored at their actual length, and fields of
+ * an exec that are zero or empty are omitted altogether, so that a typical exec occupies a fraction
+ * of the fixed-size Msg.
+ */
+constexpr std::size_t MaxMsgSize{512};
+
+/**
+ * Returns true if the encoded message is followed by further messages from the same batch.
+ */
+inline bool msg_more(const char* buf) noexcept
+{
+    return buf[2] & 0x80;
+}
+
+/**
+ * Mark the encoded message as being followed by further messages from the same batch.
+ */
+inline void set_msg_more(char* buf) noexcept
+{
+    buf[2] |= 0x80;
+}
+
+/**
+ * Returns the size of the encoded message.
+ */
+inline std::size_t msg_size(const char* buf) noexcept
+{
+    const auto* const p = reinterpret_cast<const unsigned char*>(buf);
+    return p[0] | p[1] << 8;
+}
+
+SWIRLY_API std::size_t encode_create_market(char* buf, Id64 id, Symbol instr, JDay settl_day,
+                                            MarketState state) noexcept;
+
+SWIRLY_API std::size_t encode_update_market(char* buf, Id64 id, MarketState state) noexcept;
+
+SWIRLY_API std::size_t encode_create_exec(char* buf, const Exec& exec) noexcept;
+
+/**
+ * Encode archive trade. The number of ids must not exceed MaxIds.
+ */
+SWIRLY_API std::size_t encode_archive_trade(char* buf, Id64 market_id, ArrayView<Id64> ids,
+                                            Time modified) noexcept;
+
+/**
+ * Encode a decoded message, so that it can be stored or forwarded in its compact form.
+ */
+SWIRLY_API std::size_t encode_msg(char* buf, const Msg& msg) noexcept;
+
+/**
+ * Decode message. Fields that were omitted from the encoded message are zero-filled.
+ */
+SWIRLY_API void decode_msg(const char* buf, Msg& msg) noexcept;
+
 } // namespace fin
 } // namespace swirly
 
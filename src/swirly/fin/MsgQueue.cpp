@@ -16,9 +16,11 @@
  */
 #include "MsgQueue.hpp"
 
+#include <swirly/fin/Exception.hpp>
 #include <swirly/fin/Exec.hpp>
 #include <swirly/fin/Journ.hpp>
 
+#include <swirly/util/Crc.hpp>
 #include <swirly/util/Log.hpp>
 
 #include <thread>
@@ -27,118 +29,194 @@ namespace swirly {
 inline namespace fin {
 using namespace std;
 
+size_t seal_msg(char* buf) noexcept
+{
+    const auto size = msg_size(buf) + MsgCrcSize;
+    assert(size <= MaxMsgSize);
+    buf[0] = static_cast<char>(size);
+    buf[1] = static_cast<char>(size >> 8);
+    const uint32_t crc{crc32c(buf, size - MsgCrcSize)};
+    memcpy(buf + size - MsgCrcSize, &crc, sizeof(crc));
+    return size;
+}
+
+bool check_msg(const char* buf) noexcept
+{
+    const auto size = msg_size(buf);
+    if (size < MsgCrcSize) {
+        return false;
+    }
+    uint32_t crc;
+    memcpy(&crc, buf + size - MsgCrcSize, sizeof(crc));
+    return crc32c(buf, size - MsgCrcSize) == crc;
+}
+
 MsgQueue::~MsgQueue() = default;
 
 void MsgQueue::archive_trade(Id64 market_id, ArrayView<Id64> ids, Time modified)
 {
     detail::Range<MaxIds> r{ids.size()};
-    if (mq_.reserve() < r.steps()) {
-        throw std::runtime_error{"insufficient queue capacity"};
-    }
+    buf_.resize(max(buf_.size(), r.steps() * MaxChunks * sizeof(MsgChunk)));
+    size_t chunks{0};
     do {
-        do_archive_trade(market_id, make_array_view(&ids[r.step_offset()], r.step_size()),
-                         modified);
+        char* const buf{&buf_[chunks * sizeof(MsgChunk)]};
+        encode_archive_trade(buf, market_id, make_array_view(&ids[r.step_offset()], r.step_size()),
+                             modified);
+        if (r.step_offset() + r.step_size() < ids.size()) {
+            set_msg_more(buf);
+        }
+        chunks += msg_chunks(seal_msg(buf));
     } while (r.next());
+    post_batch(chunks);
 }
 
-void MsgQueue::do_create_market(Id64 id, Symbol instr, JDay settl_day, MarketState state)
+void MsgQueue::create_exec(ArrayView<ConstExecPtr> execs)
 {
-    const auto fn = [ id, &instr, settl_day, state ](Msg & msg) noexcept
-    {
-        msg.type = MsgType::CreateMarket;
-        auto& body = msg.create_market;
-        body.id = id;
-        pstrcpy<'\0'>(body.instr, instr);
-        body.settl_day = settl_day;
-        body.state = state;
-    };
-    if (!mq_.post(fn)) {
-        throw std::runtime_error{"insufficient queue capacity"};
+    buf_.resize(max(buf_.size(), execs.size() * MaxChunks * sizeof(MsgChunk)));
+    size_t chunks{0};
+    for (size_t i{0}; i < execs.size(); ++i) {
+        char* const buf{&buf_[chunks * sizeof(MsgChunk)]};
+        encode_create_exec(buf, *execs[i]);
+        if (i + 1 < execs.size()) {
+            set_msg_more(buf);
+        }
+        chunks += msg_chunks(seal_msg(buf));
     }
+    post_batch(chunks);
 }
 
-void MsgQueue::do_update_market(Id64 id, MarketState state)
+bool MsgQueue::pop(Msg& msg, bool& end, size_t reader) noexcept
 {
-    const auto fn = [&id, state ](Msg & msg) noexcept
-    {
-        msg.type = MsgType::UpdateMarket;
-        auto& body = msg.update_market;
-        body.id = id;
-        body.state = state;
+    alignas(MsgChunk) char buf[MaxChunks * sizeof(MsgChunk)];
+    const auto size_fn = [](const MsgChunk& chunk) noexcept {
+        return msg_chunks(msg_size(chunk.data));
+    };
+    const auto fn = [&buf](size_t i, MsgChunk&& chunk) noexcept {
+        memcpy(buf + i * sizeof(MsgChunk), chunk.data, sizeof(MsgChunk));
     };
-    if (!mq_.post(fn)) {
-        throw std::runtime_error{"insufficient queue capacity"};
+    if (!mq_.fetch_n(reader, size_fn, fn)) {
+        return false;
     }
+    decode_msg(buf, msg);
+    end = !msg_more(buf);
+    return true;
 }
 
-void MsgQueue::do_create_exec(const Exec& exec)
+bool MsgQueue::peek(Msg& msg, bool& end, int64_t& pos) const noexcept
 {
-    const auto fn = [&exec](Msg & msg) noexcept
-    {
-        msg.type = MsgType::CreateExec;
-        auto& body = msg.create_exec;
-        pstrcpy<'\0'>(body.accnt, exec.accnt());
-        body.market_id = exec.market_id();
-        pstrcpy<'\0'>(body.instr, exec.instr());
-        body.settl_day = exec.settl_day();
-        body.id = exec.id();
-        body.order_id = exec.order_id();
-        pstrcpy<'\0'>(body.ref, exec.ref());
-        body.state = exec.state();
-        body.side = exec.side();
-        body.lots = exec.lots();
-        body.ticks = exec.ticks();
-        body.resd_lots = exec.resd_lots();
-        body.exec_lots = exec.exec_lots();
-        body.exec_cost = exec.exec_cost();
-        body.last_lots = exec.last_lots();
-        body.last_ticks = exec.last_ticks();
-        body.min_lots = exec.min_lots();
-        body.match_id = exec.match_id();
-        body.posn_lots = exec.posn_lots();
-        body.posn_cost = exec.posn_cost();
-        body.liq_ind = exec.liq_ind();
-        pstrcpy<'\0'>(body.cpty, exec.cpty());
-        body.created = ms_since_epoch(exec.created());
+    alignas(MsgChunk) char buf[MaxChunks * sizeof(MsgChunk)];
+    const auto size_fn = [](const MsgChunk& chunk) noexcept {
+        return msg_chunks(msg_size(chunk.data));
+    };
+    const auto fn = [&buf](size_t i, MsgChunk&& chunk) noexcept {
+        memcpy(buf + i * sizeof(MsgChunk), chunk.data, sizeof(MsgChunk));
     };
-    if (!mq_.post(fn)) {
-        throw std::runtime_error{"insufficient queue capacity"};
+    if (!mq_.read_n(pos, size_fn, fn)) {
+        return false;
     }
+    decode_msg(buf, msg);
+    end = !msg_more(buf);
+    return true;
 }
 
-void MsgQueue::create_exec(ArrayView<ConstExecPtr> execs)
+size_t MsgQueue::recover()
 {
-    if (mq_.reserve() < execs.size()) {
-        throw std::runtime_error{"insufficient queue capacity"};
+    const auto wpos = mq_.wpos();
+    auto pos = mq_.rpos(0);
+    // End of the last complete batch.
+    auto end_pos = pos;
+    size_t n{0}, m{0};
+    bool torn{false}, more{false};
+    const auto size_fn = [&torn, &more, &pos, wpos](const MsgChunk& chunk) noexcept -> size_t {
+        const auto size = msg_size(chunk.data);
+        const auto type = chunk.data[2] & 0x7f;
+        if (size < 3 + MsgCrcSize || size > MaxMsgSize
+            || type > static_cast<int>(MsgType::ArchiveTrade)
+            || pos + static_cast<int64_t>(msg_chunks(size)) > wpos) {
+            torn = true;
+            return 1;
+        }
+        more = msg_more(chunk.data);
+        return msg_chunks(size);
+    };
+    alignas(MsgChunk) char buf[MaxChunks * sizeof(MsgChunk)];
+    const auto fn = [&buf](size_t i, MsgChunk&& chunk) noexcept {
+        memcpy(buf + i * sizeof(MsgChunk), chunk.data, sizeof(MsgChunk));
+    };
+    while (mq_.read_n(pos, size_fn, fn) && !torn) {
+        // The header may be intact even though the rest of the message is not.
+        if (!check_msg(buf)) {
+            torn = true;
+            break;
+        }
+        ++m;
+        if (!more) {
+            end_pos = pos;
+            n += m;
+            m = 0;
+        }
     }
-    for (const auto& exec : execs) {
-        do_create_exec(*exec);
+    if (end_pos < wpos) {
+        SWIRLY_WARNING << "discarding torn messages from position " << end_pos << " to " << wpos;
+        mq_.truncate(end_pos);
     }
+    return n;
 }
 
-void MsgQueue::do_archive_trade(Id64 market_id, ArrayView<Id64> ids, Time modified)
+void MsgQueue::post(char* buf)
 {
-    assert(ids.size() <= MaxIds);
-    const auto fn = [&market_id, ids, modified ](Msg & msg) noexcept
-    {
-        msg.type = MsgType::ArchiveTrade;
-        auto& body = msg.archive_trade;
-        body.market_id = market_id;
-        // Cannot use copy and fill here because ArchiveBody is a packed struct:
-        // auto it = copy(ids.begin(), ids.end(), begin(body.ids));
-        // fill(it, end(body.ids), 0);
-        size_t i{0};
-        for (; i < ids.size(); ++i) {
-            body.ids[i] = ids[i];
-        }
-        for (; i < MaxIds; ++i) {
-            body.ids[i] = 0_id64;
-        }
-        body.modified = ms_since_epoch(modified);
+    const auto size = seal_msg(buf);
+    const auto fn = [buf, size](size_t i, MsgChunk& chunk) noexcept {
+        const auto offset = i * sizeof(MsgChunk);
+        memcpy(chunk.data, buf + offset, min(size - offset, sizeof(MsgChunk)));
+    };
+    if (!mq_.post_n(msg_chunks(size), fn)) {
+        throw ServiceUnavailableException{"insufficient queue capacity"sv};
+    }
+    event_->notify();
+}
+
+void MsgQueue::post_batch(size_t chunks)
+{
+    if (chunks == 0) {
+        return;
+    }
+    // Each message in the buffer starts on a chunk boundary.
+    const auto fn = [this](size_t i, MsgChunk& chunk) noexcept {
+        memcpy(chunk.data, &buf_[i * sizeof(MsgChunk)], sizeof(MsgChunk));
     };
-    if (!mq_.post(fn)) {
-        throw std::runtime_error{"insufficient queue capacity"};
+    if (!mq_.post_n(chunks, fn)) {
+        throw ServiceUnavailableException{"insufficient queue capacity"sv};
     }
+    event_->notify();
+}
+
+void MsgQueue::do_create_market(Id64 id, Symbol instr, JDay settl_day, MarketState state)
+{
+    char buf[MaxMsgSize];
+    encode_create_market(buf, id, instr, settl_day, state);
+    post(buf);
+}
+
+void MsgQueue::do_update_market(Id64 id, MarketState state)
+{
+    char buf[MaxMsgSize];
+    encode_update_market(buf, id, state);
+    post(buf);
+}
+
+void MsgQueue::do_create_exec(const Exec& exec)
+{
+    char buf[MaxMsgSize];
+    encode_create_exec(buf, exec);
+    post(buf);
+}
+
+void MsgQueue::do_archive_trade(Id64 market_id, ArrayView<Id64> ids, Time modified)
+{
+    char buf[MaxMsgSize];
+    encode_archive_trade(buf, market_id, ids, modified);
+    post(buf);
 }
 
 } // namespace fin
@@ -19,11 +19,14 @@
 
 #include <swirly/fin/Msg.hpp>
 
-#include <swirly/app/MemQueue.hpp>
+#include <swirly/app/EventCount.hpp>
+#include <swirly/app/MemRing.hpp>
 
 #include <swirly/util/Array.hpp>
 
 #include <cassert>
+#include <memory>
+#include <vector>
 
 namespace swirly {
 inline namespace fin {
@@ -63,15 +66,57 @@ class Range {
 };
 } // namespace detail
 
+/**
+ * Each message is encoded as a variable-length record that occupies one or more consecutive chunks
+ * of the queue. A chunk occupies a single cache-line.
+ */
+struct MsgChunk {
+    char data[CacheLineSize];
+};
+
+constexpr std::size_t msg_chunks(std::size_t size) noexcept
+{
+    return (size + sizeof(MsgChunk) - 1) / sizeof(MsgChunk);
+}
+
+constexpr std::size_t MaxChunks{msg_chunks(MaxMsgSize)};
+
+/**
+ * Size of the checksum that seals each message in the queue.
+ */
+constexpr std::size_t MsgCrcSize{4};
+
+/**
+ * Seal the encoded message with a CRC-32C of its contents, so that a message torn by a crash can be
+ * detected on recovery. The checksum is appended to the message and included in its size, so
+ * sealing must be the last change made to the message. Returns the sealed size.
+ */
+SWIRLY_API std::size_t seal_msg(char* buf) noexcept;
+
+/**
+ * Returns true if the checksum of the sealed message matches its contents.
+ */
+SWIRLY_API bool check_msg(const char* buf) noexcept;
+
+/**
+ * Message queue from the engine to its consumers. The engine is the single producer, and each
+ * message is broadcast to a fixed number of readers, such as the journal, market-data and
+ * drop-copy. The journal is reader zero. The engine is gated by the slowest reader.
+ */
 class SWIRLY_API MsgQueue {
   public:
     MsgQueue(std::nullptr_t = nullptr) noexcept {}
-    explicit MsgQueue(std::size_t capacity)
-    : mq_{capacity}
+    /**
+     * The capacity is specified in chunks.
+     */
+    explicit MsgQueue(std::size_t capacity, std::size_t readers = 1)
+    : mq_{capacity, readers}
+    , event_{std::make_unique<EventCount>()}
     {
     }
     explicit MsgQueue(const char* path)
     : mq_{path}
+    , event_{std::make_unique<EventCount>()}
     {
     }
     ~MsgQueue();
@@ -84,6 +129,29 @@ class SWIRLY_API MsgQueue {
     MsgQueue(MsgQueue&&) = default;
     MsgQueue& operator=(MsgQueue&&) = default;
 
+    /**
+     * Returns the event that is notified whenever messages are posted, so that an idle journal
+     * agent can park instead of spinning. Only in-process readers may wait on the event.
+     */
+    EventCount& event() noexcept { return *event_; }
+    /**
+     * Returns the number of readers.
+     */
+    std::size_t readers() const noexcept { return mq_.readers(); }
+    /**
+     * Returns the queue position following the last message that was posted. Positions are
+     * measured in chunks, and increase monotonically.
+     */
+    std::int64_t wpos() const noexcept { return mq_.wpos(); }
+    /**
+     * Returns the queue position following the last message that was popped by the reader.
+     */
+    std::int64_t rpos(std::size_t reader = 0) const noexcept { return mq_.rpos(reader); }
+    /**
+     * Returns the number of chunks that may be posted before the queue is full. Each message
+     * occupies at least one chunk.
+     */
+    std::size_t reserve() const noexcept { return mq_.reserve(); }
     /**
      * Create Market.
      */
@@ -100,7 +168,7 @@ class SWIRLY_API MsgQueue {
      */
     void create_exec(const Exec& exec) { do_create_exec(exec); }
     /**
-     * Create Executions.
+     * Create Executions. The executions are posted as a single batch.
      */
     void create_exec(ArrayView<ConstExecPtr> execs);
     /**
@@ -111,15 +179,58 @@ class SWIRLY_API MsgQueue {
         do_archive_trade(market_id, {&id, 1}, modified);
     }
     /**
-     * Archive Trades.
+     * Archive Trades. The trades are posted as a single batch.
      */
     void archive_trade(Id64 market_id, ArrayView<Id64> ids, Time modified);
     /**
      * Returns false if queue is empty.
      */
-    bool pop(Msg& msg) noexcept { return mq_.pop(msg); }
+    bool pop(Msg& msg) noexcept
+    {
+        bool end;
+        return pop(msg, end);
+    }
+    /**
+     * Returns false if queue is empty. The end flag is set if the message is the last of its
+     * batch. Messages from the same batch are published together, so the remainder of the batch
+     * is available as soon as its first message is.
+     */
+    bool pop(Msg& msg, bool& end, std::size_t reader = 0) noexcept;
+    /**
+     * Read the message at the specified position, and advance the position past the message.
+     * The message is not released, so it remains in the queue until release() is called. Returns
+     * false if the position has reached the write position.
+     */
+    bool peek(Msg& msg, bool& end, std::int64_t& pos) const noexcept;
+    /**
+     * Release the messages before the specified position on behalf of the reader.
+     */
+    void release(std::int64_t pos, std::size_t reader = 0) noexcept { mq_.release(reader, pos); }
+    /**
+     * Recover a file-based queue that may have been left behind by a process that crashed. The
+     * messages that the journal has yet to release are scanned, and the queue is truncated at the
+     * start of the first batch that is incomplete or contains a torn message, so that the journal
+     * only ever sees whole batches. A message is torn if its header is invalid or its checksum
+     * does not match its contents. This function must be called before the engine or any of the
+     * readers are started.
+     *
+     * Returns the number of messages that remain to be journalled.
+     */
+    std::size_t recover();
 
   private:
+    /**
+     * Seal and post the encoded message. Throws ServiceUnavailableException if the queue cannot
+     * accommodate the message.
+     */
+    void post(char* buf);
+
+    /**
+     * Post the chunks in the encoding buffer as a single batch. Nothing is posted if the queue
+     * cannot accommodate the whole batch, in which case ServiceUnavailableException is thrown.
+     */
+    void post_batch(std::size_t chunks);
+
     void do_create_market(Id64 id, Symbol instr, JDay settl_day, MarketState state);
 
     void do_update_market(Id64 id, MarketState state);
@@ -128,7 +239,10 @@ class SWIRLY_API MsgQueue {
 
     void do_archive_trade(Id64 market_id, ArrayView<Id64> ids, Time modified);
 
-    MemQueue<Msg> mq_{nullptr};
+    MemRing<MsgChunk> mq_{nullptr};
+    std::unique_ptr<EventCount> event_;
+    // Encoding buffer for batches, which are posted with a single reservation.
+    std::vector<char> buf_;
 };
 
 } // namespace fin
@@ -30,6 +30,8 @@
 #include <algorithm>
 #include <queue>
 
+#include <unistd.h>
+
 namespace swirly {
 inline namespace fin {
 std::ostream& operator<<(std::ostream& os, MsgType type)
@@ -208,7 +210,10 @@ BOOST_FIXTURE_TEST_CASE(MsgQueueCreateExec, MsgQueueFixture)
     mq.create_exec(execs);
     {
         Msg msg;
-        BOOST_TEST(mq.pop(msg));
+        bool end;
+        BOOST_TEST(mq.pop(msg, end));
+        // Both execs were posted as a single batch.
+        BOOST_TEST(!end);
         BOOST_CHECK_EQUAL(msg.type, MsgType::CreateExec);
         const auto& body = msg.create_exec;
 
@@ -238,7 +243,9 @@ BOOST_FIXTURE_TEST_CASE(MsgQueueCreateExec, MsgQueueFixture)
     }
     {
         Msg msg;
-        BOOST_TEST(mq.pop(msg));
+        bool end;
+        BOOST_TEST(mq.pop(msg, end));
+        BOOST_TEST(end);
         BOOST_CHECK_EQUAL(msg.type, MsgType::CreateExec);
         const auto& body = msg.create_exec;
 
@@ -268,6 +275,172 @@ BOOST_FIXTURE_TEST_CASE(MsgQueueCreateExec, MsgQueueFixture)
     }
 }
 
+BOOST_AUTO_TEST_CASE(MsgQueueCompactCase)
+{
+    // Zero fields are omitted, so a new order fits in a single chunk.
+    const Exec exec{"MARAYL"sv, MarketId, "EURUSD"sv, SettlDay, 1_id64, 1_id64, "REF"sv,
+                    State::New, Side::Buy, 10_lts, 12345_tks, 10_lts, 0_lts, 0_cst, 0_lts,
+                    0_tks, 1_lts, 0_id64, 0_lts, 0_cst, LiqInd::None, Symbol{}, Now};
+    char buf[MaxMsgSize];
+    const auto size = encode_create_exec(buf, exec);
+    BOOST_TEST(size == msg_size(buf));
+    BOOST_TEST(msg_chunks(size) == 1U);
+
+    // Negative values survive the round trip.
+    const Exec trade{"MARAYL"sv, MarketId, "EURUSD"sv, SettlDay, 2_id64, 1_id64, "REF"sv,
+                     State::Trade, Side::Sell, 10_lts, 12345_tks, 0_lts, 10_lts, 123450_cst,
+                     10_lts, 12345_tks, 1_lts, 3_id64, -10_lts, -123450_cst, LiqInd::Taker,
+                     "GOSAYL"sv, Now};
+    encode_create_exec(buf, trade);
+    Msg msg;
+    decode_msg(buf, msg);
+    const auto& body = msg.create_exec;
+    const Lots posn_lots{body.posn_lots};
+    const Cost posn_cost{body.posn_cost};
+    BOOST_TEST(posn_lots == -10_lts);
+    BOOST_TEST(posn_cost == -123450_cst);
+}
+
+BOOST_AUTO_TEST_CASE(MsgQueueWrapCase)
+{
+    constexpr auto Ref = "A reference that is long enough to span more than one chunk";
+
+    MsgQueue mq{4};
+    const Exec exec{"MARAYL"sv, MarketId, "EURUSD"sv, SettlDay, 1_id64, 1_id64, Ref, State::New,
+                    Side::Buy, 10_lts, 12345_tks, 10_lts, 0_lts, 0_cst, 0_lts, 0_tks, 1_lts, 0_id64,
+                    0_lts, 0_cst, LiqInd::None, Symbol{}, Now};
+    char buf[MaxMsgSize];
+    BOOST_TEST(msg_chunks(encode_create_exec(buf, exec)) == 2U);
+
+    // Records that span multiple chunks wrap around the end of the queue.
+    for (int i{0}; i < 5; ++i) {
+        mq.create_exec(exec);
+        mq.update_market(MarketId, i);
+        BOOST_TEST(mq.reserve() == 1U);
+        BOOST_CHECK_THROW(mq.create_exec(exec), runtime_error);
+
+        Msg msg;
+        BOOST_TEST(mq.pop(msg));
+        BOOST_TEST((msg.type == MsgType::CreateExec));
+        BOOST_TEST(strncmp(msg.create_exec.ref, Ref, MaxRef) == 0);
+        BOOST_TEST(mq.pop(msg));
+        BOOST_TEST((msg.type == MsgType::UpdateMarket));
+        const MarketState state{msg.update_market.state};
+        BOOST_TEST(state == static_cast<MarketState>(i));
+        BOOST_TEST(!mq.pop(msg));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MsgQueueReadersCase)
+{
+    MsgQueue mq{1 << 10, 2};
+    BOOST_TEST(mq.readers() == 2U);
+    mq.create_market(MarketId, "EURUSD"sv, SettlDay, 0x1);
+
+    // Each reader receives every message.
+    for (size_t reader{0}; reader < 2; ++reader) {
+        Msg msg;
+        bool end;
+        BOOST_TEST(mq.pop(msg, end, reader));
+        BOOST_TEST(end);
+        BOOST_TEST((msg.type == MsgType::CreateMarket));
+        const Id64 id{msg.create_market.id};
+        BOOST_TEST(id == MarketId);
+        BOOST_TEST(!mq.pop(msg, end, reader));
+    }
+}
+
+BOOST_AUTO_TEST_CASE(MsgQueueRecoverCase)
+{
+    char path[] = "/tmp/swirly-mq.XXXXXX";
+    const auto fd = mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    close(fd);
+    unlink(path);
+
+    BOOST_TEST(open_mem_ring<MsgChunk>(path, 1 << 4, 1, 0600));
+    // An existing file is reopened rather than overwritten.
+    BOOST_TEST(!open_mem_ring<MsgChunk>(path, 1 << 4, 1, 0600));
+    {
+        MsgQueue mq{path};
+        mq.create_market(MarketId, "EURUSD"sv, SettlDay, 0x1);
+        mq.update_market(MarketId, 0x2);
+
+        // The journal committed the first message before the crash.
+        Msg msg;
+        bool end;
+        auto pos = mq.rpos();
+        BOOST_TEST(mq.peek(msg, end, pos));
+        BOOST_TEST((msg.type == MsgType::CreateMarket));
+        mq.release(pos);
+
+        // A batch that was cut short, followed by a torn message.
+        MemRing<MsgChunk> ring{path};
+        char buf[MaxMsgSize];
+        encode_update_market(buf, MarketId, 0x3);
+        set_msg_more(buf);
+        seal_msg(buf);
+        BOOST_TEST(ring.post_n(1, [&buf](size_t, MsgChunk& chunk) noexcept {
+            memcpy(chunk.data, buf, sizeof(chunk.data));
+        }));
+        BOOST_TEST(ring.push(MsgChunk{}));
+    }
+    {
+        MsgQueue mq{path};
+        BOOST_TEST(mq.wpos() == 4);
+        BOOST_TEST(mq.recover() == 1U);
+        BOOST_TEST(mq.wpos() == 2);
+
+        // Only the message that was posted but not journalled remains.
+        Msg msg;
+        BOOST_TEST(mq.pop(msg));
+        BOOST_TEST((msg.type == MsgType::UpdateMarket));
+        const MarketState state{msg.update_market.state};
+        BOOST_TEST(state == 0x2U);
+        BOOST_TEST(!mq.pop(msg));
+    }
+    unlink(path);
+}
+
+BOOST_AUTO_TEST_CASE(MsgQueueRecoverCrcCase)
+{
+    char path[] = "/tmp/swirly-mq.XXXXXX";
+    const auto fd = mkstemp(path);
+    BOOST_REQUIRE(fd >= 0);
+    close(fd);
+    unlink(path);
+
+    BOOST_TEST(open_mem_ring<MsgChunk>(path, 1 << 4, 1, 0600));
+    {
+        MsgQueue mq{path};
+        mq.create_market(MarketId, "EURUSD"sv, SettlDay, 0x1);
+
+        // A complete message with a valid header, but whose contents were torn.
+        MemRing<MsgChunk> ring{path};
+        char buf[MaxMsgSize];
+        encode_update_market(buf, MarketId, 0x2);
+        const auto size = seal_msg(buf);
+        BOOST_TEST(check_msg(buf));
+        buf[size - MsgCrcSize - 1] ^= 0x01;
+        BOOST_TEST(!check_msg(buf));
+        BOOST_TEST(ring.post_n(1, [&buf](size_t, MsgChunk& chunk) noexcept {
+            memcpy(chunk.data, buf, sizeof(chunk.data));
+        }));
+    }
+    {
+        MsgQueue mq{path};
+        BOOST_TEST(mq.wpos() == 2);
+        BOOST_TEST(mq.recover() == 1U);
+        BOOST_TEST(mq.wpos() == 1);
+
+        Msg msg;
+        BOOST_TEST(mq.pop(msg));
+        BOOST_TEST((msg.type == MsgType::CreateMarket));
+        BOOST_TEST(!mq.pop(msg));
+    }
+    unlink(path);
+}
+
 BOOST_FIXTURE_TEST_CASE(MsgQueueArchiveTrade, MsgQueueFixture)
 {
     vector<Id64> ids;
@@ -280,7 +453,10 @@ BOOST_FIXTURE_TEST_CASE(MsgQueueArchiveTrade, MsgQueueFixture)
     auto it = ids.begin();
     while (it != ids.end()) {
         Msg msg;
-        BOOST_TEST(mq.pop(msg));
+        bool end;
+        BOOST_TEST(mq.pop(msg, end));
+        // The batch ends with the last id.
+        BOOST_TEST(end == (it + MaxIds >= ids.end()));
         BOOST_CHECK_EQUAL(msg.type, MsgType::ArchiveTrade);
         const auto& body = msg.archive_trade;
         BOOST_CHECK_EQUAL(body.market_id, MarketId);
@@ -156,39 +156,5 @@ OrderRefSet::Iterator OrderRefSet::insert_or_replace(const ValuePtr& value) noex
     return it;
 }
 
-OrderList::~OrderList()
-{
-    list_.clear_and_dispose([](const Order* ptr) { ptr->release(); });
-}
-
-OrderList::OrderList(OrderList&&) = default;
-
-OrderList& OrderList::operator=(OrderList&&) = default;
-
-OrderList::Iterator OrderList::insert_back(const OrderPtr& value) noexcept
-{
-    list_.push_back(*value);
-    // Take ownership.
-    value->add_ref();
-    return List::s_iterator_to(*value);
-}
-
-OrderList::Iterator OrderList::insert_before(const OrderPtr& value, const Order& next) noexcept
-{
-    auto it = list_.insert(List::s_iterator_to(next), *value);
-    // Take ownership.
-    value->add_ref();
-    return it;
-}
-
-OrderList::ValuePtr OrderList::remove(const Order& ref) noexcept
-{
-    ValuePtr value;
-    list_.erase_and_dispose(List::s_iterator_to(ref), [&value](Order* ptr) {
-        value = ValuePtr{ptr, false};
-    });
-    return value;
-}
-
 } // namespace fin
 } // namespace swirly
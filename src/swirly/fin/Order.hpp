@@ -22,11 +22,12 @@
 
 #include <swirly/app/MemAlloc.hpp>
 
-#include <boost/intrusive/list.hpp>
+#include <boost/intrusive/set.hpp>
 
 namespace swirly {
 inline namespace fin {
 
+class BookEntry;
 class Level;
 
 /**
@@ -79,6 +80,13 @@ class SWIRLY_API Order
     void to_json(std::ostream& os) const;
 
     auto* level() const noexcept { return level_; }
+    auto* entry() const noexcept { return entry_; }
+    /**
+     * Returns the id of the session that holds the order, or zero if none. The id is opaque to the
+     * order, and is resolved by the application, so that the session of a maker order can be found
+     * without an account lookup.
+     */
+    auto sess_id() const noexcept { return sess_id_; }
     auto state() const noexcept { return state_; }
     auto ticks() const noexcept { return ticks_; }
     auto resd_lots() const noexcept { return resd_lots_; }
@@ -90,6 +98,8 @@ class SWIRLY_API Order
     auto done() const noexcept { return resd_lots_ == 0_lts; }
     auto modified() const noexcept { return modified_; }
     void set_level(Level* level) const noexcept { level_ = level; }
+    void set_entry(BookEntry* entry) const noexcept { entry_ = entry; }
+    void set_sess_id(Id32 sess_id) const noexcept { sess_id_ = sess_id; }
     void create(Time now) noexcept
     {
         assert(lots_ > 0_lts);
@@ -137,11 +147,12 @@ class SWIRLY_API Order
     }
     boost::intrusive::set_member_hook<> id_hook;
     boost::intrusive::set_member_hook<> ref_hook;
-    boost::intrusive::list_member_hook<> list_hook;
 
   private:
     // Internals.
     mutable Level* level_{nullptr};
+    mutable BookEntry* entry_{nullptr};
+    mutable Id32 sess_id_{0_id32};
 
     State state_;
     const Ticks ticks_;
@@ -272,53 +283,6 @@ class SWIRLY_API OrderRefSet {
     Set set_;
 };
 
-class SWIRLY_API OrderList {
-    using ConstantTimeSizeOption = boost::intrusive::constant_time_size<false>;
-    using MemberHookOption
-        = boost::intrusive::member_hook<Order, decltype(Order::list_hook), &Order::list_hook>;
-    using List = boost::intrusive::list<Order, ConstantTimeSizeOption, MemberHookOption>;
-    using ValuePtr = boost::intrusive_ptr<Order>;
-
-  public:
-    using Iterator = typename List::iterator;
-    using ConstIterator = typename List::const_iterator;
-
-    OrderList() = default;
-
-    ~OrderList();
-
-    // Copy.
-    OrderList(const OrderList&) = delete;
-    OrderList& operator=(const OrderList&) = delete;
-
-    // Move.
-    OrderList(OrderList&&);
-    OrderList& operator=(OrderList&&);
-
-    static ConstIterator to_iterator(const Order& order) noexcept
-    {
-        return List::s_iterator_to(order);
-    }
-
-    // Begin.
-    ConstIterator begin() const noexcept { return list_.begin(); }
-    ConstIterator cbegin() const noexcept { return list_.cbegin(); }
-    Iterator begin() noexcept { return list_.begin(); }
-
-    // End.
-    ConstIterator end() const noexcept { return list_.end(); }
-    ConstIterator cend() const noexcept { return list_.cend(); }
-    Iterator end() noexcept { return list_.end(); }
-    Iterator insert_back(const OrderPtr& value) noexcept;
-
-    Iterator insert_before(const OrderPtr& value, const Order& next) noexcept;
-
-    ValuePtr remove(const Order& ref) noexcept;
-
-  private:
-    List list_;
-};
-
 inline std::ostream& operator<<(std::ostream& os, const Order& order)
 {
     order.to_json(os);
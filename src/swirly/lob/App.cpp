@@ -22,6 +22,7 @@
 #include <swirly/fin/Date.hpp>
 #include <swirly/fin/Exception.hpp>
 #include <swirly/fin/Journ.hpp>
+#include <swirly/fin/MarketId.hpp>
 #include <swirly/fin/Model.hpp>
 #include <swirly/fin/MsgQueue.hpp>
 
@@ -30,7 +31,14 @@
 
 #include "Match.hxx"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <functional>
+#include <limits>
 #include <regex>
+#include <thread>
+#include <unordered_map>
 
 namespace swirly {
 inline namespace lob {
@@ -39,13 +47,16 @@ namespace {
 
 const regex SymbolPattern{R"(^[0-9A-Za-z-._]{3,16}$)"};
 
-Ticks spread(const Order& taker_order, const Order& maker_order, Direct direct) noexcept
+// Maximum number of cancels journalled in a single batch by mass cancel.
+constexpr size_t MaxCancels{256};
+
+Ticks spread(const Order& taker_order, const Level& maker_level, Direct direct) noexcept
 {
     return direct == Direct::Paid
         // Paid when the taker lifts the offer.
-        ? maker_order.ticks() - taker_order.ticks()
+        ? maker_level.ticks() - taker_order.ticks()
         // Given when the taker hits the bid.
-        : taker_order.ticks() - maker_order.ticks();
+        : taker_order.ticks() - maker_level.ticks();
 }
 
 template <typename ValueT>
@@ -54,6 +65,50 @@ inline auto& remove_const(const ValueT& ref)
     return const_cast<ValueT&>(ref);
 }
 
+// Stable, so that rows for the same account keep the order in which they were read.
+template <typename PtrT>
+void sort_by_accnt(vector<PtrT>& ptrs)
+{
+    stable_sort(ptrs.begin(), ptrs.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs->accnt().compare(rhs->accnt()) < 0;
+    });
+}
+
+// Run the tasks on at most max_threads threads, including the calling thread, and rethrow the
+// first exception, if any, once all tasks have finished.
+template <size_t N>
+void run_tasks(array<function<void()>, N>& tasks, size_t max_threads)
+{
+    atomic<size_t> next{0};
+    array<exception_ptr, N> errs;
+    const auto work = [&]() {
+        for (size_t i; (i = next++) < N;) {
+            try {
+                tasks[i]();
+            } catch (...) {
+                errs[i] = current_exception();
+            }
+        }
+    };
+    {
+        vector<thread> workers;
+        const auto finally = make_finally([&workers]() noexcept {
+            for (auto& worker : workers) {
+                worker.join();
+            }
+        });
+        for (size_t i{1}; i < min(max_threads, N); ++i) {
+            workers.emplace_back(work);
+        }
+        work();
+    }
+    for (const auto& err : errs) {
+        if (err) {
+            rethrow_exception(err);
+        }
+    }
+}
+
 } // namespace
 
 struct App::Impl {
@@ -66,39 +121,62 @@ struct App::Impl {
         execs_.reserve(1 + 16);
     }
 
-    void load(const Model& model, Time now)
+    void load(const Model& model, Time now, size_t threads, bool lazy_execs)
     {
         const auto bus_day = bus_day_(now);
+        // One week ago.
+        const auto since = now - 604800000ms;
+        if (lazy_execs) {
+            exec_model_ = &model;
+            exec_since_ = since;
+        }
+        // Reference data and markets are read first, which also completes any initial scan by the
+        // model before the remaining reads are started.
         model.read_asset([& assets = assets_](auto ptr) { assets.insert(move(ptr)); });
         model.read_instr([& instrs = instrs_](auto ptr) { instrs.insert(move(ptr)); });
         model.read_market([& markets = markets_](MarketPtr ptr) { markets.insert(ptr); });
-        model.read_order([this](auto ptr) {
-            auto& sess = this->sess(ptr->accnt());
-            sess.insert_order(ptr);
-            bool success{false};
-            const auto finally = make_finally([&]() noexcept {
-                if (!success) {
-                    sess.remove_order(*ptr);
+
+        vector<OrderPtr> orders;
+        vector<OrderPtr> sess_orders;
+        vector<ExecPtr> execs;
+        vector<ExecPtr> trades;
+        vector<PosnPtr> posns;
+        // Rows are read and sorted on worker threads, but only merged on this thread.
+        array<function<void()>, 4> tasks{
+            [&]() {
+                model.read_order([&orders](auto ptr) { orders.push_back(std::move(ptr)); });
+                sess_orders = orders;
+                sort_by_accnt(sess_orders);
+            },
+            [&]() {
+                if (!lazy_execs) {
+                    model.read_exec(since, [&execs](auto ptr) { execs.push_back(std::move(ptr)); });
+                    sort_by_accnt(execs);
                 }
-            });
-            auto it = this->markets_.find(ptr->market_id());
-            assert(it != this->markets_.end());
-            it->insert_order(ptr);
-            success = true;
-        });
-        // One week ago.
-        model.read_exec(now - 604800000ms, [this](auto ptr) {
-            auto& sess = this->sess(ptr->accnt());
-            sess.push_exec_back(ptr);
-        });
-        model.read_trade([this](auto ptr) {
-            auto& sess = this->sess(ptr->accnt());
-            sess.insert_trade(ptr);
-        });
-        model.read_posn(bus_day, [this](auto ptr) {
-            auto& sess = this->sess(ptr->accnt());
-            sess.insert_posn(ptr);
-        });
+            },
+            [&]() {
+                model.read_trade([&trades](auto ptr) { trades.push_back(std::move(ptr)); });
+                sort_by_accnt(trades);
+            },
+            [&]() {
+                model.read_posn(bus_day, [&posns](auto ptr) { posns.push_back(std::move(ptr)); });
+                sort_by_accnt(posns);
+            }};
+        run_tasks(tasks, model.concurrent() ? threads : 1);
+
+        // Orders are appended to their levels in the order read, which is priority order.
+        auto market_it = markets_.end();
+        for (const auto& order : orders) {
+            if (market_it == markets_.end() || market_it->id() != order->market_id()) {
+                market_it = markets_.find(order->market_id());
+                assert(market_it != markets_.end());
+            }
+            market_it->insert_order(order);
+        }
+        insert_by_accnt(sess_orders, [](Sess& sess, const auto& ptr) { sess.insert_order(ptr); });
+        insert_by_accnt(execs, [](Sess& sess, const auto& ptr) { sess.push_exec_back(ptr); });
+        insert_by_accnt(trades, [](Sess& sess, const auto& ptr) { sess.insert_trade(ptr); });
+        insert_by_accnt(posns, [](Sess& sess, const auto& ptr) { sess.insert_posn(ptr); });
     }
 
     const AssetSet& assets() const noexcept { return assets_; }
@@ -115,17 +193,34 @@ struct App::Impl {
 
     const InstrSet& instrs() const noexcept { return instrs_; }
 
-    const Sess& sess(Symbol accnt) const
+    SessPtr make_sess(Id32 id, Symbol accnt) const
     {
-        SessSet::ConstIterator it;
-        bool found;
-        tie(it, found) = sesss_.find_hint(accnt);
-        if (!found) {
-            it = sesss_.insert_hint(it, Sess::make(accnt, max_execs_));
+        auto sess = Sess::make(id, accnt, max_execs_);
+        // Exec history is read on first use if the model was loaded lazily.
+        sess->set_execs_loaded(exec_model_ == nullptr);
+        return sess;
+    }
+
+    Id32 sess_id(Symbol accnt) const
+    {
+        // Accounts are interned to dense ids, and only created sessions touch the tree.
+        auto& id = sess_ids_[accnt];
+        if (id == 0_id32) {
+            id = Id32{sess_vec_.size()};
+            auto it = sesss_.insert(make_sess(id, accnt));
+            sess_vec_.push_back(&*it);
         }
-        return *it;
+        return id;
     }
 
+    const Sess& sess(Id32 id) const noexcept
+    {
+        assert(id > 0_id32 && static_cast<size_t>(id.count()) < sess_vec_.size());
+        return *sess_vec_[id.count()];
+    }
+
+    const Sess& sess(Symbol accnt) const { return sess(sess_id(accnt)); }
+
     const Market& market(Id64 id) const
     {
         auto it = markets_.find(id);
@@ -137,15 +232,58 @@ struct App::Impl {
 
     const MarketSet& markets() const noexcept { return markets_; }
 
-    Sess& sess(Symbol accnt)
+    const SessSet& sesss() const noexcept { return sesss_; }
+
+    const Sess& sess_with_execs(Symbol accnt) const
     {
-        SessSet::Iterator it;
-        bool found;
-        tie(it, found) = sesss_.find_hint(accnt);
-        if (!found) {
-            it = sesss_.insert_hint(it, Sess::make(accnt, max_execs_));
+        auto& sess = remove_const(this->sess(accnt));
+        if (!sess.execs_loaded()) {
+            vector<ConstExecPtr> execs;
+            read_exec_history(accnt, execs);
+            sess.push_exec_history(execs);
+            sess.set_execs_loaded(true);
+        }
+        return sess;
+    }
+
+    bool execs_loaded(Symbol accnt) const { return sess(accnt).execs_loaded(); }
+
+    void read_exec_history(Symbol accnt, vector<ConstExecPtr>& execs) const
+    {
+        // Only state that is constant after load is accessed here.
+        if (exec_model_) {
+            exec_model_->read_accnt_exec(accnt, exec_since_, max_execs_,
+                                         [&execs](auto ptr) { execs.push_back(std::move(ptr)); });
+        }
+    }
+
+    void set_exec_history(Symbol accnt, ArrayView<ConstExecPtr> execs)
+    {
+        auto& sess = this->sess(accnt);
+        if (!sess.execs_loaded()) {
+            sess.push_exec_history(execs);
+            sess.set_execs_loaded(true);
+        }
+    }
+
+    Sess& sess(Id32 id) noexcept { return remove_const(as_const(*this).sess(id)); }
+
+    Sess& sess(Symbol accnt) { return remove_const(as_const(*this).sess(accnt)); }
+
+    /**
+     * Insert rows that are sorted by account, so that each session is looked up once for its run
+     * of rows, rather than once per row.
+     */
+    template <typename PtrT, typename FnT>
+    void insert_by_accnt(const vector<PtrT>& ptrs, FnT fn)
+    {
+        Sess* sess{nullptr};
+        for (const auto& ptr : ptrs) {
+            if (!sess || sess->accnt() != ptr->accnt()) {
+                sess = &this->sess(ptr->accnt());
+            }
+            fn(*sess, ptr);
         }
-        return *it;
     }
 
     const Market& create_market(const Instr& instr, JDay settl_day, MarketState state, Time now)
@@ -181,7 +319,7 @@ struct App::Impl {
     }
 
     void create_order(Sess& sess, Market& market, string_view ref, Side side, Lots lots,
-                      Ticks ticks, Lots min_lots, Time now, Response& resp)
+                      Ticks ticks, Lots min_lots, TimeInForce tif, Time now, Response& resp)
     {
         // N.B. we only check for duplicates in the ref_idx; no unique constraint exists in the database,
         // and order-refs can be reused so long as only one order is live in the system at any given
@@ -191,7 +329,7 @@ struct App::Impl {
         }
 
         const auto bus_day = bus_day_(now);
-        if (market.settl_day() != 0_jd && market.settl_day() < bus_day) {
+        if (is_settled(market.settl_day(), bus_day)) {
             throw MarketClosedException{err_msg()
                                         << "market for '" << market.instr() << "' on "
                                         << jd_to_iso(market.settl_day()) << " has closed"};
@@ -199,6 +337,57 @@ struct App::Impl {
         if (lots == 0_lts || lots < min_lots) {
             throw InvalidLotsException{err_msg() << "invalid lots '" << lots << '\''};
         }
+        do_create_order(sess, market, ref, side, lots, ticks, min_lots, tif, now, resp);
+    }
+
+    void create_orders(Sess& sess, Market& market, ArrayView<NewOrder> new_orders, Time now,
+                       Response& resp, vector<error_code>& errs)
+    {
+        // The market is common to all orders in the batch, so it is only checked once.
+        const auto bus_day = bus_day_(now);
+        if (is_settled(market.settl_day(), bus_day)) {
+            throw MarketClosedException{err_msg()
+                                        << "market for '" << market.instr() << "' on "
+                                        << jd_to_iso(market.settl_day()) << " has closed"};
+        }
+        // Each order requires at least one message, so reject the whole batch before any order is
+        // placed if the queue clearly cannot accommodate them. This is only a lower bound, because
+        // orders that match post more messages, so a full queue is also reported per order below.
+        if (mq_.reserve() < new_orders.size()) {
+            throw ServiceUnavailableException{err_msg() << "insufficient queue capacity"};
+        }
+        errs.assign(new_orders.size(), error_code{});
+        resp.set_market(&market);
+        // Each order is built into a scratch response, which is only merged once the order has been
+        // committed, so that failed orders leave nothing behind.
+        Response order_resp;
+        for (size_t i{0}; i < new_orders.size(); ++i) {
+            const auto& no = new_orders[i];
+            try {
+                // Duplicates within the batch are also detected, because live orders are inserted
+                // into the session as they are created.
+                if (!no.ref.empty() && sess.exists(no.ref)) {
+                    throw RefAlreadyExistsException{err_msg()
+                                                    << "order '" << no.ref << "' already exists"};
+                }
+                if (no.lots == 0_lts || no.lots < no.min_lots) {
+                    throw InvalidLotsException{err_msg() << "invalid lots '" << no.lots << '\''};
+                }
+                order_resp.clear();
+                do_create_order(sess, market, no.ref, no.side, no.lots, no.ticks, no.min_lots,
+                                no.tif, now, order_resp);
+                resp.merge(order_resp);
+            } catch (const Exception& e) {
+                // Includes ServiceUnavailableException from the queue, in which case the order has
+                // been rolled back.
+                errs[i] = e.code();
+            }
+        }
+    }
+
+    void do_create_order(Sess& sess, Market& market, string_view ref, Side side, Lots lots,
+                         Ticks ticks, Lots min_lots, TimeInForce tif, Time now, Response& resp)
+    {
         const auto id = market.alloc_id();
         auto order = Order::make(sess.accnt(), market.id(), market.instr(), market.settl_day(), id,
                                  ref, side, lots, ticks, min_lots, now);
@@ -213,8 +402,11 @@ struct App::Impl {
             this->execs_.clear();
         });
         execs_.push_back(exec);
-        // Order fields are updated on match.
-        match_orders(sess, market, *order, now, resp);
+        // Fill-or-kill orders only match if they can be filled in full.
+        if (tif != TimeInForce::Fok || can_fill(market, *order)) {
+            // Order fields are updated on match.
+            match_orders(sess, market, *order, now, resp);
+        }
 
         resp.set_market(&market);
 
@@ -228,18 +420,15 @@ struct App::Impl {
             resp.set_posn(posn);
         }
 
-        // Place incomplete order in market.
-        if (!order->done()) {
-            // This may fail if level cannot be allocated.
+        ExecPtr cancel_exec;
+        if (tif == TimeInForce::Gtc && !order->done()) {
+            // Place incomplete order in market. This may fail if level cannot be allocated.
             market.insert_order(order);
-        }
-        {
-            // TODO: IOC orders would need an additional revision for the unsolicited cancellation
-            // of any unfilled quantity.
+
             bool success{false};
             // clang-format off
             const auto finally = make_finally([&market, &order, &success]() noexcept {
-                if (!success && !order->done()) {
+                if (!success) {
                     // Undo market insertion.
                     market.remove_order(*order);
                 }
@@ -248,15 +437,115 @@ struct App::Impl {
 
             mq_.create_exec(execs_);
             success = true;
+        } else {
+            // Orders that do not rest never touch the book, so there is nothing to undo.
+            if (!order->done()) {
+                // Unsolicited cancellation of the unfilled quantity.
+                cancel_exec = new_exec(*order, market.alloc_id(), now);
+                cancel_exec->cancel();
+                resp.insert_exec(cancel_exec);
+                execs_.push_back(cancel_exec);
+            }
+            mq_.create_exec(execs_);
         }
 
         // Commit phase.
 
+        if (cancel_exec) {
+            order->cancel(now);
+        }
         if (!order->done()) {
             sess.insert_order(order);
         }
         sess.push_exec_front(exec);
 
+        // Commit matches.
+        if (have_matches) {
+            assert(posn);
+            commit_matches(sess, market, *posn, now);
+        }
+        if (cancel_exec) {
+            sess.push_exec_front(cancel_exec);
+        }
+    }
+
+    void quote(Sess& sess, Market& market, Ticks bid_ticks, Lots bid_lots, Ticks offer_ticks,
+               Lots offer_lots, Time now, Response& resp)
+    {
+        const auto bus_day = bus_day_(now);
+        if (is_settled(market.settl_day(), bus_day)) {
+            throw MarketClosedException{err_msg()
+                                        << "market for '" << market.instr() << "' on "
+                                        << jd_to_iso(market.settl_day()) << " has closed"};
+        }
+        if (bid_lots < 0_lts) {
+            throw InvalidLotsException{err_msg() << "invalid lots '" << bid_lots << '\''};
+        }
+        if (offer_lots < 0_lts) {
+            throw InvalidLotsException{err_msg() << "invalid lots '" << offer_lots << '\''};
+        }
+        if (bid_lots > 0_lts && offer_lots > 0_lts && bid_ticks >= offer_ticks) {
+            throw InvalidTicksException{err_msg() << "quote '" << bid_ticks << '/' << offer_ticks
+                                                  << "' is crossed"};
+        }
+        auto& quote = sess.quote(market.id());
+        QuoteSide bid{plan_quote(quote.bid, bid_ticks, bid_lots)};
+        QuoteSide offer{plan_quote(quote.offer, offer_ticks, offer_lots)};
+
+        // Ensure that matches are cleared when scope exits.
+        const auto finally = make_finally([this]() noexcept {
+            this->matches_.clear();
+            this->execs_.clear();
+        });
+        resp.set_market(&market);
+
+        // A new order must not trade against the order that the opposite side withdraws.
+        prepare_quote(sess, market, bid, Side::Buy, bid_ticks, bid_lots, offer.withdrawn(), now,
+                      resp);
+        prepare_quote(sess, market, offer, Side::Sell, offer_ticks, offer_lots, bid.withdrawn(),
+                      now, resp);
+
+        // Avoid allocating position when there are no matches.
+        PosnPtr posn;
+        const bool have_matches = !matches_.empty();
+        if (have_matches) {
+            // N.B. before commit phase, because this may fail.
+            posn = sess.posn(market.id(), market.instr(), market.settl_day());
+            resp.set_posn(posn);
+        }
+
+        // Place incomplete orders in market.
+        bool success{false};
+        // clang-format off
+        const auto undo = make_finally([&market, &bid, &offer, &success]() noexcept {
+            if (!success) {
+                // Undo market insertion.
+                if (bid.order && !bid.order->done()) {
+                    market.remove_order(*bid.order);
+                }
+                if (offer.order && !offer.order->done()) {
+                    market.remove_order(*offer.order);
+                }
+            }
+        });
+        // clang-format on
+        if (bid.order && !bid.order->done()) {
+            // This may fail if level cannot be allocated.
+            market.insert_order(bid.order);
+        }
+        if (offer.order && !offer.order->done()) {
+            market.insert_order(offer.order);
+        }
+
+        // All changes to both sides are journalled as a single batch.
+        mq_.create_exec(execs_);
+        success = true;
+
+        // Commit phase.
+
+        commit_quote(sess, market, bid, quote.bid, now);
+        commit_quote(sess, market, offer, quote.offer, now);
+
         // Commit matches.
         if (have_matches) {
             assert(posn);
@@ -390,12 +679,24 @@ struct App::Impl {
 
     void cancel_order(Sess& sess, Time now)
     {
-        // FIXME: Not implemented.
+        // Session only holds live orders, which are ordered by market.
+        for (auto& order : sess.orders()) {
+            cancels_.push_back(&order);
+        }
+        do_cancel_orders(now);
     }
 
     void cancel_order(Market& market, Time now)
     {
-        // FIXME: Not implemented.
+        // Walk each level's queue directly to avoid per-order lookups.
+        for (const auto* side : {&market.bid_side(), &market.offer_side()}) {
+            for (const auto& level : side->levels()) {
+                for (const auto& entry : level.entries()) {
+                    cancels_.push_back(entry.order().get());
+                }
+            }
+        }
+        do_cancel_orders(now);
     }
 
     TradePair create_trade(Sess& sess, Market& market, string_view ref, Side side, Lots lots,
@@ -469,14 +770,80 @@ struct App::Impl {
         }
     }
 
+    bool expire_end_of_day(Time now, size_t max_orders)
+    {
+        assert(max_orders > 0);
+        const auto bus_day = bus_day_(now);
+        if (expire_day_ == bus_day) {
+            return true;
+        }
+        size_t n{0};
+        // Resume from the market where the previous slice stopped.
+        for (auto it = markets_.find_hint(expire_from_).first; it != markets_.end(); ++it) {
+            auto& market = *it;
+            // Skip open markets, and those that were closed when expiry last completed.
+            if (!is_settled(market.settl_day(), bus_day) || market.settl_day() < expire_day_) {
+                continue;
+            }
+            for (const auto* side : {&market.bid_side(), &market.offer_side()}) {
+                for (const auto& level : side->levels()) {
+                    for (const auto& entry : level.entries()) {
+                        if (n++ == max_orders) {
+                            expire_from_ = market.id();
+                            do_cancel_orders(now);
+                            return false;
+                        }
+                        cancels_.push_back(entry.order().get());
+                    }
+                }
+            }
+            do_cancel_orders(now);
+        }
+        expire_day_ = bus_day;
+        expire_from_ = 0_id64;
+        return true;
+    }
+
+    bool settl_end_of_day(Time now, size_t max_sesss)
+    {
+        assert(max_sesss > 0);
+        const auto bus_day = bus_day_(now);
+        if (settl_day_ == bus_day) {
+            return true;
+        }
+        size_t n{0};
+        // Resume from the market and session where the previous slice stopped.
+        for (auto it = markets_.find_hint(settl_from_).first; it != markets_.end(); ++it) {
+            const auto& market = *it;
+            // Skip open markets, and those that were closed when settlement last completed.
+            if (!is_settled(market.settl_day(), bus_day) || market.settl_day() < settl_day_) {
+                continue;
+            }
+            for (auto jt = sesss_.find_hint(settl_accnt_).first; jt != sesss_.end(); ++jt) {
+                if (n++ == max_sesss) {
+                    settl_from_ = market.id();
+                    settl_accnt_ = jt->accnt();
+                    return false;
+                }
+                roll_posn(*jt, market);
+            }
+            settl_accnt_ = Symbol{};
+        }
+        settl_day_ = bus_day;
+        settl_from_ = 0_id64;
+        return true;
+    }
+
     void expire_end_of_day(Time now)
     {
-        // FIXME: Not implemented.
+        while (!expire_end_of_day(now, MaxCancels)) {
+        }
     }
 
     void settl_end_of_day(Time now)
     {
-        // FIXME: Not implemented.
+        while (!settl_end_of_day(now, numeric_limits<size_t>::max())) {
+        }
     }
 
   private:
@@ -518,79 +885,123 @@ struct App::Impl {
                           ref, side, lots, ticks, posn_lots, posn_cost, liq_ind, cpty, created);
     }
 
-    Match new_match(Market& market, const Order& taker_order, const OrderPtr& maker_order,
-                    Lots lots, Lots sum_lots, Cost sum_cost, Time created)
+    /**
+     * The trades are appended to the transaction's exec list, which owns them until they escape
+     * into the sessions during the commit phase.
+     */
+    Match new_match(Market& market, const Order& taker_order, Order& maker_order, Lots lots,
+                    Lots sum_lots, Cost sum_cost, Time created)
     {
         const auto maker_id = market.alloc_id();
         const auto taker_id = market.alloc_id();
 
-        auto it = sesss_.find(maker_order->accnt());
-        assert(it != sesss_.end());
-        auto& maker_sess = *it;
-        auto maker_posn = maker_sess.posn(market.id(), market.instr(), market.settl_day());
+        // Resting orders are held by their session.
+        auto& maker_sess = sess(maker_order.sess_id());
+        // Position is owned by the maker's session.
+        auto* const maker_posn
+            = maker_sess.posn(market.id(), market.instr(), market.settl_day()).get();
 
-        const auto ticks = maker_order->ticks();
+        const auto ticks = maker_order.ticks();
 
-        auto maker_trade = new_exec(*maker_order, maker_id, created);
+        auto maker_trade = new_exec(maker_order, maker_id, created);
         maker_trade->trade(lots, ticks, taker_id, LiqInd::Maker, taker_order.accnt());
 
         auto taker_trade = new_exec(taker_order, taker_id, created);
         taker_trade->trade(sum_lots, sum_cost, lots, ticks, maker_id, LiqInd::Taker,
-                           maker_order->accnt());
+                           maker_order.accnt());
+
+        auto* const maker_ptr = maker_trade.get();
+        auto* const taker_ptr = taker_trade.get();
+        execs_.push_back(maker_trade);
+        execs_.push_back(taker_trade);
 
-        return {lots, maker_order, maker_trade, maker_posn, taker_trade};
+        return {lots, &maker_order, maker_posn, maker_ptr, taker_ptr};
+    }
+
+    /**
+     * Returns true if the opposite side has enough liquidity at crossing prices to fill the order
+     * in full. The book is only read.
+     */
+    static bool can_fill(const Market& market, const Order& taker_order) noexcept
+    {
+        const auto direct = taker_order.side() == Side::Buy ? Direct::Paid : Direct::Given;
+        const auto& side
+            = taker_order.side() == Side::Buy ? market.offer_side() : market.bid_side();
+        auto sum_lots = 0_lts;
+        for (const auto& level : side.levels()) {
+            if (spread(taker_order, level, direct) > 0_tks) {
+                break;
+            }
+            sum_lots += level.lots();
+            if (sum_lots >= taker_order.resd_lots()) {
+                return true;
+            }
+        }
+        return false;
     }
 
     void match_orders(const Sess& taker_sess, Market& market, Order& taker_order, MarketSide& side,
-                      Direct direct, Time now, Response& resp)
+                      Direct direct, const Order* skip, Time now, Response& resp)
     {
         auto sum_lots = 0_lts;
         auto sum_cost = 0_cst;
         auto last_lots = 0_lts;
         auto last_ticks = 0_tks;
 
-        for (auto& maker_order : side.orders()) {
-            // Break if order is fully filled.
-            if (sum_lots == taker_order.resd_lots()) {
-                break;
-            }
-            // Only consider orders while prices cross.
-            if (spread(taker_order, maker_order, direct) > 0_tks) {
+        for (auto& maker_level : side.levels()) {
+            // Only consider levels while prices cross.
+            if (spread(taker_order, maker_level, direct) > 0_tks) {
                 break;
             }
+            // Drain level in time priority. Only the book entry is read until a trade is generated.
+            for (const auto& maker_entry : maker_level.entries()) {
+                // Break if order is fully filled.
+                if (sum_lots == taker_order.resd_lots()) {
+                    break;
+                }
 
-            const auto lots = min(taker_order.resd_lots() - sum_lots, maker_order.resd_lots());
-            const auto ticks = maker_order.ticks();
+                // Skip order that is being withdrawn by the same transaction.
+                if (maker_entry.order().get() == skip) {
+                    continue;
+                }
 
-            sum_lots += lots;
-            sum_cost += cost(lots, ticks);
-            last_lots = lots;
-            last_ticks = ticks;
+                const auto lots = min(taker_order.resd_lots() - sum_lots, maker_entry.resd_lots());
+                const auto ticks = maker_entry.ticks();
 
-            auto match
-                = new_match(market, taker_order, &maker_order, lots, sum_lots, sum_cost, now);
+                sum_lots += lots;
+                sum_cost += cost(lots, ticks);
+                last_lots = lots;
+                last_ticks = ticks;
 
-            // Insert order if trade crossed with self.
-            if (maker_order.accnt() == taker_sess.accnt()) {
-                // Maker updated first because this is consistent with last-look semantics.
-                // N.B. the reference count is not incremented here.
-                resp.insert_order(&maker_order);
-                resp.insert_exec(match.maker_trade);
-            }
-            resp.insert_exec(match.taker_trade);
+                const auto& maker_order = maker_entry.order();
+                const auto match
+                    = new_match(market, taker_order, *maker_order, lots, sum_lots, sum_cost, now);
 
-            execs_.push_back(match.maker_trade);
-            execs_.push_back(match.taker_trade);
-            matches_.push_back(move(match));
+                // Insert order if trade crossed with self.
+                if (maker_entry.accnt() == taker_sess.accnt()) {
+                    // Maker updated first because this is consistent with last-look semantics.
+                    // N.B. the reference count is not incremented here.
+                    resp.insert_order(maker_order);
+                    resp.insert_exec(match.maker_trade);
+                }
+                resp.insert_exec(match.taker_trade);
+
+                matches_.push_back(match);
+            }
+            // Break if order is fully filled.
+            if (sum_lots == taker_order.resd_lots()) {
+                break;
+            }
         }
 
-        if (!matches_.empty()) {
+        // N.B. matches may already contain those of a previous taker in the same transaction.
+        if (sum_lots > 0_lts) {
             taker_order.trade(sum_lots, sum_cost, last_lots, last_ticks, now);
         }
     }
 
     void match_orders(const Sess& taker_sess, Market& market, Order& taker_order, Time now,
-                      Response& resp)
+                      Response& resp, const Order* skip = nullptr)
     {
         MarketSide* market_side;
         Direct direct;
@@ -604,7 +1015,7 @@ struct App::Impl {
             market_side = &market.bid_side();
             direct = Direct::Given;
         }
-        match_orders(taker_sess, market, taker_order, *market_side, direct, now, resp);
+        match_orders(taker_sess, market, taker_order, *market_side, direct, skip, now, resp);
     }
 
     // Assumes that maker lots have not been reduced since matching took place. N.B. this function is
@@ -614,21 +1025,19 @@ struct App::Impl {
     {
         for (const auto& match : matches_) {
 
-            const auto maker_order = match.maker_order;
+            auto* const maker_order = match.maker_order;
             assert(maker_order);
 
             // Reduce maker.
             market.take_order(*maker_order, match.lots, now);
 
             // Must succeed because maker order exists.
-            auto it = sesss_.find(maker_order->accnt());
-            assert(it != sesss_.end());
-            auto& maker_sess = *it;
+            auto& maker_sess = sess(maker_order->sess_id());
 
             // Maker updated first because this is consistent with last-look semantics.
 
             // Update maker position.
-            const auto maker_trade = match.maker_trade;
+            auto* const maker_trade = match.maker_trade;
             assert(maker_trade);
             maker_trade->posn(match.maker_posn->net_lots(), match.maker_posn->net_cost());
             match.maker_posn->add_trade(maker_trade->side(), maker_trade->last_lots(),
@@ -642,7 +1051,7 @@ struct App::Impl {
             }
 
             // Update taker position.
-            const auto taker_trade = match.taker_trade;
+            auto* const taker_trade = match.taker_trade;
             assert(taker_trade);
             taker_trade->posn(taker_posn.net_lots(), taker_posn.net_cost());
             taker_posn.add_trade(taker_trade->side(), taker_trade->last_lots(),
@@ -654,6 +1063,101 @@ struct App::Impl {
         }
     }
 
+    /**
+     * Pending update to one side of a quote.
+     */
+    struct QuoteSide {
+        /**
+         * Live order currently quoted on this side, if any.
+         */
+        Order* prev;
+        /**
+         * Revised lots if prev is reduced in place, or zero if prev is cancelled.
+         */
+        Lots revise_lots;
+        /**
+         * True if a new order replaces prev.
+         */
+        bool create;
+        ExecPtr prev_exec;
+        OrderPtr order;
+        ExecPtr exec;
+
+        const Order* withdrawn() const noexcept
+        {
+            return prev && revise_lots == 0_lts ? prev : nullptr;
+        }
+    };
+
+    static QuoteSide plan_quote(const OrderPtr& prev, Ticks ticks, Lots lots) noexcept
+    {
+        QuoteSide qs{};
+        if (prev && !prev->done()) {
+            if (lots > 0_lts && prev->ticks() == ticks && lots <= prev->resd_lots()) {
+                if (lots < prev->resd_lots()) {
+                    // Reducing the size at the same price retains queue position.
+                    qs.prev = prev.get();
+                    qs.revise_lots = prev->exec_lots() + lots;
+                }
+                // Otherwise unchanged.
+                return qs;
+            }
+            qs.prev = prev.get();
+        }
+        qs.create = lots > 0_lts;
+        return qs;
+    }
+
+    void prepare_quote(Sess& sess, Market& market, QuoteSide& qs, Side side, Ticks ticks,
+                       Lots lots, const Order* skip, Time now, Response& resp)
+    {
+        if (qs.prev) {
+            qs.prev_exec = new_exec(*qs.prev, market.alloc_id(), now);
+            if (qs.revise_lots > 0_lts) {
+                qs.prev_exec->revise(qs.revise_lots);
+            } else {
+                qs.prev_exec->cancel();
+            }
+            resp.insert_order(qs.prev);
+            resp.insert_exec(qs.prev_exec);
+            execs_.push_back(qs.prev_exec);
+        }
+        if (qs.create) {
+            const auto id = market.alloc_id();
+            qs.order = Order::make(sess.accnt(), market.id(), market.instr(), market.settl_day(),
+                                   id, ""sv, side, lots, ticks, 0_lts, now);
+            qs.exec = new_exec(*qs.order, id, now);
+
+            resp.insert_order(qs.order);
+            resp.insert_exec(qs.exec);
+            execs_.push_back(qs.exec);
+            // Order fields are updated on match.
+            match_orders(sess, market, *qs.order, now, resp, skip);
+        }
+    }
+
+    void commit_quote(Sess& sess, Market& market, const QuoteSide& qs, OrderPtr& slot,
+                      Time now) noexcept
+    {
+        if (qs.prev) {
+            if (qs.revise_lots > 0_lts) {
+                market.revise_order(*qs.prev, qs.revise_lots, now);
+            } else {
+                market.cancel_order(*qs.prev, now);
+                sess.remove_order(*qs.prev);
+                slot = nullptr;
+            }
+            sess.push_exec_front(qs.prev_exec);
+        }
+        if (qs.create) {
+            if (!qs.order->done()) {
+                sess.insert_order(qs.order);
+            }
+            sess.push_exec_front(qs.exec);
+            slot = qs.order;
+        }
+    }
+
     void do_revise_order(Sess& sess, Market& market, Order& order, Lots lots, Time now,
                          Response& resp)
     {
@@ -702,6 +1206,78 @@ struct App::Impl {
         sess.push_exec_front(exec);
     }
 
+    /**
+     * Cancel the orders collected in cancels_. Orders are cancelled in batches of up to MaxCancels,
+     * and each batch is journalled and committed before the next is started, so this method may
+     * partially fail.
+     */
+    void do_cancel_orders(Time now)
+    {
+        const auto finally = make_finally([this]() noexcept {
+            this->cancels_.clear();
+            this->execs_.clear();
+        });
+
+        // Consecutive orders usually share the same market.
+        Market* market{nullptr};
+        const auto lookup = [this, &market](const Order& order) {
+            if (!market || market->id() != order.market_id()) {
+                market = &remove_const(this->market(order.market_id()));
+            }
+        };
+
+        fin::detail::Range<MaxCancels> r{cancels_.size()};
+        while (!r.done()) {
+            const auto first = cancels_.begin() + r.step_offset();
+            const auto last = first + r.step_size();
+
+            execs_.clear();
+            for (auto it = first; it != last; ++it) {
+                const auto& order = **it;
+                lookup(order);
+                auto exec = new_exec(order, market->alloc_id(), now);
+                exec->cancel();
+                execs_.push_back(exec);
+            }
+
+            mq_.create_exec(execs_);
+
+            // Commit phase.
+
+            auto exec_it = execs_.begin();
+            for (auto it = first; it != last; ++it, ++exec_it) {
+                // Hold reference until both containers have released the order.
+                const OrderPtr order{*it};
+                lookup(*order);
+                market->cancel_order(*order, now);
+                // Resting orders are held by their session.
+                auto& sess = this->sess(order->sess_id());
+                sess.remove_order(*order);
+                sess.push_exec_front(*exec_it);
+            }
+            r.next();
+        }
+    }
+
+    /**
+     * Roll the session's position in a settled market into the session's rolled position for the
+     * instrument. Positions are derived from journalled trades, and every model rolls them with the
+     * same is_settled() cutoff when they are read, so the rolled position is reproduced on restart
+     * without a journal entry of its own.
+     *
+     * Throws std::bad_alloc.
+     */
+    void roll_posn(Sess& sess, const Market& market)
+    {
+        auto it = sess.posns().find(market.id());
+        if (it == sess.posns().end()) {
+            return;
+        }
+        auto rolled = sess.posn(to_rolled_id(market.id()), market.instr(), 0_jd);
+        rolled->add_posn(*it);
+        sess.remove_posn(*it);
+    }
+
     void do_archive_trade(Sess& sess, const Exec& trade, Time now)
     {
         mq_.archive_trade(trade.market_id(), trade.id(), now);
@@ -714,12 +1290,27 @@ struct App::Impl {
     MsgQueue& mq_;
     const BusinessDay bus_day_{MarketZone};
     const size_t max_execs_;
+    // Set if exec history is read from the model on first use, rather than on load.
+    const Model* exec_model_{nullptr};
+    Time exec_since_{};
     AssetSet assets_;
     InstrSet instrs_;
     MarketSet markets_;
     mutable SessSet sesss_;
+    // Dense session ids by account. Sessions are owned by the ordered set, and indexed by id in a
+    // flat vector, whose first slot is reserved, because zero is not a valid id.
+    mutable unordered_map<Symbol, Id32> sess_ids_;
+    mutable vector<Sess*> sess_vec_{nullptr};
     vector<Match> matches_;
     vector<ConstExecPtr> execs_;
+    vector<Order*> cancels_;
+    // End-of-day progress: the business-day when each job last completed, and the position from
+    // which the next slice resumes.
+    JDay expire_day_{0_jd};
+    Id64 expire_from_{0_id64};
+    JDay settl_day_{0_jd};
+    Id64 settl_from_{0_id64};
+    Symbol settl_accnt_;
 };
 
 App::App(MsgQueue& mq, size_t max_execs)
@@ -733,9 +1324,9 @@ App::App(App&&) = default;
 
 App& App::operator=(App&&) = default;
 
-void App::load(const Model& model, Time now)
+void App::load(const Model& model, Time now, size_t threads, bool lazy_execs)
 {
-    impl_->load(model, now);
+    impl_->load(model, now, threads, lazy_execs);
 }
 
 const AssetSet& App::assets() const noexcept
@@ -753,6 +1344,11 @@ const MarketSet& App::markets() const noexcept
     return impl_->markets();
 }
 
+const SessSet& App::sesss() const noexcept
+{
+    return impl_->sesss();
+}
+
 const Instr& App::instr(Symbol symbol) const
 {
     return impl_->instr(symbol);
@@ -763,11 +1359,41 @@ const Market& App::market(Id64 id) const
     return impl_->market(id);
 }
 
+Id32 App::sess_id(Symbol accnt) const
+{
+    return impl_->sess_id(accnt);
+}
+
+const Sess& App::sess(Id32 id) const noexcept
+{
+    return impl_->sess(id);
+}
+
 const Sess& App::sess(Symbol accnt) const
 {
     return impl_->sess(accnt);
 }
 
+const Sess& App::sess_with_execs(Symbol accnt) const
+{
+    return impl_->sess_with_execs(accnt);
+}
+
+bool App::execs_loaded(Symbol accnt) const
+{
+    return impl_->execs_loaded(accnt);
+}
+
+void App::read_exec_history(Symbol accnt, vector<ConstExecPtr>& execs) const
+{
+    impl_->read_exec_history(accnt, execs);
+}
+
+void App::set_exec_history(Symbol accnt, ArrayView<ConstExecPtr> execs)
+{
+    impl_->set_exec_history(accnt, execs);
+}
+
 const Market& App::create_market(const Instr& instr, JDay settl_day, MarketState state, Time now)
 {
     return impl_->create_market(instr, settl_day, state, now);
@@ -778,11 +1404,37 @@ void App::update_market(const Market& market, MarketState state, Time now)
     return impl_->update_market(remove_const(market), state, now);
 }
 
+void App::set_level_window(const Market& market, size_t width)
+{
+    remove_const(market).set_level_window(width);
+}
+
 void App::create_order(const Sess& sess, const Market& market, string_view ref, Side side,
                        Lots lots, Ticks ticks, Lots min_lots, Time now, Response& resp)
 {
     impl_->create_order(remove_const(sess), remove_const(market), ref, side, lots, ticks, min_lots,
-                        now, resp);
+                        TimeInForce::Gtc, now, resp);
+}
+
+void App::create_order(const Sess& sess, const Market& market, string_view ref, Side side,
+                       Lots lots, Ticks ticks, Lots min_lots, TimeInForce tif, Time now,
+                       Response& resp)
+{
+    impl_->create_order(remove_const(sess), remove_const(market), ref, side, lots, ticks, min_lots,
+                        tif, now, resp);
+}
+
+void App::create_orders(const Sess& sess, const Market& market, ArrayView<NewOrder> new_orders,
+                        Time now, Response& resp, vector<error_code>& errs)
+{
+    impl_->create_orders(remove_const(sess), remove_const(market), new_orders, now, resp, errs);
+}
+
+void App::quote(const Sess& sess, const Market& market, Ticks bid_ticks, Lots bid_lots,
+                Ticks offer_ticks, Lots offer_lots, Time now, Response& resp)
+{
+    impl_->quote(remove_const(sess), remove_const(market), bid_ticks, bid_lots, offer_ticks,
+                 offer_lots, now, resp);
 }
 
 void App::revise_order(const Sess& sess, const Market& market, const Order& order, Lots lots,
@@ -870,10 +1522,20 @@ void App::expire_end_of_day(Time now)
     impl_->expire_end_of_day(now);
 }
 
+bool App::expire_end_of_day(Time now, size_t max_orders)
+{
+    return impl_->expire_end_of_day(now, max_orders);
+}
+
 void App::settl_end_of_day(Time now)
 {
     impl_->settl_end_of_day(now);
 }
 
+bool App::settl_end_of_day(Time now, size_t max_sesss)
+{
+    return impl_->settl_end_of_day(now, max_sesss);
+}
+
 } // namespace lob
 } // namespace swirly
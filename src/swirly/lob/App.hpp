@@ -21,12 +21,17 @@
 #include <swirly/fin/Instr.hpp>
 #include <swirly/fin/Market.hpp>
 
+#include <swirly/lob/Sess.hpp>
+
 #include <swirly/util/Array.hpp>
 
+#include <system_error>
+#include <vector>
+
 namespace swirly {
 
 inline namespace app {
-template <typename ValueT>
+template <typename ValueT, typename PolicyT>
 class MemQueue;
 } // namespace app
 
@@ -40,10 +45,21 @@ class MsgQueue;
 inline namespace lob {
 
 class Response;
-class Sess;
 
 using TradePair = std::pair<ConstExecPtr, ConstExecPtr>;
 
+/**
+ * Order-entry fields for a single order within a batch.
+ */
+struct NewOrder {
+    std::string_view ref;
+    Side side;
+    Lots lots;
+    Ticks ticks;
+    Lots min_lots;
+    TimeInForce tif{TimeInForce::Gtc};
+};
+
 class SWIRLY_API App {
   public:
     App(MsgQueue& mq, std::size_t max_execs);
@@ -58,7 +74,22 @@ class SWIRLY_API App {
     App(App&&);
     App& operator=(App&&);
 
-    void load(const Model& model, Time now);
+    /**
+     * Load the model. Orders, execs, trades and positions are read in parallel if the model
+     * supports concurrent reads, and are then merged into the application on the calling thread.
+     *
+     * @param model
+     *            The model.
+     * @param now
+     *            The current time.
+     * @param threads
+     *            The maximum number of threads used to read the model, including the calling
+     *            thread. Objects are allocated on each of these threads.
+     * @param lazy_execs
+     *            If true, each session's exec history is read from the model on first use, rather
+     *            than on load, so the model must outlive the application.
+     */
+    void load(const Model& model, Time now, std::size_t threads = 1, bool lazy_execs = false);
 
     const AssetSet& assets() const noexcept;
 
@@ -66,19 +97,116 @@ class SWIRLY_API App {
 
     const InstrSet& instrs() const noexcept;
 
+    /**
+     * Returns the dense id of the account's session, which is created if it does not exist. Callers
+     * that act for the same account repeatedly may resolve the account once, and then find the
+     * session by id.
+     */
+    Id32 sess_id(Symbol accnt) const;
+
+    const Sess& sess(Id32 id) const noexcept;
+
     const Sess& sess(Symbol accnt) const;
 
+    /**
+     * Returns the session, after reading its exec history from the model, if the model was loaded
+     * lazily and the history has not already been read. At most max_execs execs are read.
+     */
+    const Sess& sess_with_execs(Symbol accnt) const;
+
+    /**
+     * Returns false while the session's exec history has yet to be read from a lazily loaded model.
+     */
+    bool execs_loaded(Symbol accnt) const;
+
+    /**
+     * Read at most max_execs of the session's exec history from a lazily loaded model, without
+     * modifying the application. This function may be called from a thread other than the
+     * matching thread, provided that no other thread reads the model at the same time, and that
+     * the execs are not allocated from the matching thread's pool (see MemCtx::HeapScope).
+     */
+    void read_exec_history(Symbol accnt, std::vector<ConstExecPtr>& execs) const;
+
+    /**
+     * Set the session's exec history, as returned by read_exec_history(), unless it has already
+     * been loaded.
+     */
+    void set_exec_history(Symbol accnt, ArrayView<ConstExecPtr> execs);
+
     const Market& market(Id64 id) const;
 
     const MarketSet& markets() const noexcept;
 
+    const SessSet& sesss() const noexcept;
+
     const Market& create_market(const Instr& instr, JDay settl_day, MarketState state, Time now);
 
     void update_market(const Market& market, MarketState state, Time now);
 
+    /**
+     * Select the price-level layout for a market. A non-zero width indexes levels within a window
+     * of that many ticks around the touch, which suits markets that trade in a narrow band. Only
+     * level lookup is accelerated: levels are still linked into the tree, so creating and removing
+     * levels costs the same as before. The layout is not journalled.
+     *
+     * @param market
+     *            The market.
+     * @param width
+     *            The window width in ticks, or zero for tree-only levels.
+     */
+    void set_level_window(const Market& market, std::size_t width);
+
     void create_order(const Sess& sess, const Market& market, std::string_view ref, Side side,
                       Lots lots, Ticks ticks, Lots min_lots, Time now, Response& resp);
 
+    /**
+     * Create an order with the specified time in force. Immediate-or-cancel and fill-or-kill
+     * orders never rest on the book, so any unfilled quantity is cancelled by an additional exec
+     * in the same batch. A fill-or-kill order only trades if the opposite side has enough
+     * liquidity at crossing prices to fill it in full.
+     */
+    void create_order(const Sess& sess, const Market& market, std::string_view ref, Side side,
+                      Lots lots, Ticks ticks, Lots min_lots, TimeInForce tif, Time now,
+                      Response& resp);
+
+    /**
+     * Create a batch of orders in a single market. The market and queue capacity are checked once
+     * for the whole batch, and an exception is thrown if either check fails. Orders are then placed
+     * in sequence, so later orders may match against earlier ones. An order that fails does not
+     * affect the others: its error code is recorded at the same index in errs, while successful
+     * orders have an empty error code. The response accumulates the orders and execs of every
+     * successful order.
+     *
+     * @param new_orders
+     *            The orders to create.
+     * @param now
+     *            The current time.
+     * @param resp
+     *            The response.
+     * @param errs
+     *            Receives one error code per order.
+     */
+    void create_orders(const Sess& sess, const Market& market, ArrayView<NewOrder> new_orders,
+                       Time now, Response& resp, std::vector<std::error_code>& errs);
+
+    /**
+     * Replace the session's two-sided quote in a market. Each side of the quote is an ordinary
+     * order, which is reduced in place if only its size shrinks, so that it keeps its queue
+     * position, and is otherwise cancelled and replaced. A side with zero lots is withdrawn. All
+     * changes to both sides, including any resulting trades, are journalled as a single batch.
+     *
+     * @param bid_ticks
+     *            The bid price.
+     * @param bid_lots
+     *            The bid size, or zero to withdraw the bid.
+     * @param offer_ticks
+     *            The offer price.
+     * @param offer_lots
+     *            The offer size, or zero to withdraw the offer.
+     */
+    void quote(const Sess& sess, const Market& market, Ticks bid_ticks, Lots bid_lots,
+               Ticks offer_ticks, Lots offer_lots, Time now, Response& resp);
+
     void revise_order(const Sess& sess, const Market& market, const Order& order, Lots lots,
                       Time now, Response& resp);
 
@@ -124,15 +252,46 @@ class SWIRLY_API App {
     void archive_trade(const Sess& sess, Id64 market_id, ArrayView<Id64> ids, Time now);
 
     /**
-     * This method may partially fail.
+     * Cancel all orders in markets that have closed. This method may partially fail.
      *
      * @param now
      *            The current time.
      */
     void expire_end_of_day(Time now);
 
+    /**
+     * Perform a single slice of end-of-day expiry. Markets are processed in turn, and the slice
+     * stops once max_orders orders have been expired, so that the caller can bound the pause. This
+     * method may partially fail.
+     *
+     * @param now
+     *            The current time.
+     * @param max_orders
+     *            The maximum number of orders to expire in this slice.
+     * @return true if expiry is complete for the business-day.
+     */
+    bool expire_end_of_day(Time now, std::size_t max_orders);
+
+    /**
+     * Roll positions in markets that have closed into a single position per instrument.
+     *
+     * @param now
+     *            The current time.
+     */
     void settl_end_of_day(Time now);
 
+    /**
+     * Perform a single slice of end-of-day settlement. Markets are processed in turn, and the slice
+     * stops once max_sesss sessions have been visited.
+     *
+     * @param now
+     *            The current time.
+     * @param max_sesss
+     *            The maximum number of sessions to visit in this slice.
+     * @return true if settlement is complete for the business-day.
+     */
+    bool settl_end_of_day(Time now, std::size_t max_sesss);
+
   private:
     struct Impl;
     std::unique_ptr<Impl> impl_;
@@ -46,18 +46,126 @@ class SWIRLY_API TestModel : public swirly::TestModel {
     }
 };
 
+// Orders, execs and trades alternate between accounts, so that a load must group them by session.
+class ConcurrentModel : public TestModel {
+  protected:
+    bool do_concurrent() const noexcept override { return true; }
+    void do_read_order(const ModelCallback<OrderPtr>& cb) const override
+    {
+        for (int i{1}; i <= 6; ++i) {
+            cb(Order::make(i % 2 ? "MARAYL"sv : "GOSAYL"sv, MarketId, "EURUSD"sv, SettlDay,
+                           Id64{i}, ""sv, Side::Buy, 1_lts, 12345_tks, 0_lts, Now));
+        }
+    }
+    void do_read_exec(Time since, const ModelCallback<ExecPtr>& cb) const override
+    {
+        // Most recent first.
+        for (int i{6}; i >= 1; --i) {
+            cb(Exec::make(i % 2 ? "MARAYL"sv : "GOSAYL"sv, MarketId, "EURUSD"sv, SettlDay,
+                          Id64{i}, Id64{i}, ""sv, State::New, Side::Buy, 1_lts, 12345_tks, 1_lts,
+                          0_lts, 0_cst, 0_lts, 0_tks, 0_lts, 0_id64, 0_lts, 0_cst, LiqInd::None,
+                          Symbol{}, Now));
+        }
+    }
+    void do_read_posn(JDay bus_day, const ModelCallback<PosnPtr>& cb) const override
+    {
+        cb(Posn::make("MARAYL"sv, MarketId, "EURUSD"sv, SettlDay));
+        cb(Posn::make("GOSAYL"sv, MarketId, "EURUSD"sv, SettlDay));
+    }
+};
+
 struct AppFixture {
     AppFixture() { app.load(TestModel{}, Now); }
     MsgQueue mq{1 << 10};
     App app{mq, 1 << 4};
 };
 
+struct SmallQueueFixture {
+    SmallQueueFixture() { app.load(TestModel{}, Now); }
+    MsgQueue mq{4};
+    App app{mq, 1 << 4};
+};
+
 } // namespace
 
 namespace utf = boost::unit_test;
 
 BOOST_AUTO_TEST_SUITE(AppSuite)
 
+BOOST_AUTO_TEST_CASE(AppLoadConcurrent)
+{
+    MsgQueue mq{1 << 10};
+    App app{mq, 1 << 4};
+    app.load(ConcurrentModel{}, Now, 4);
+
+    BOOST_TEST(distance(app.sesss().begin(), app.sesss().end()) == 2);
+    const auto& sess = app.sess("MARAYL"sv);
+    BOOST_TEST(distance(sess.orders().begin(), sess.orders().end()) == 3);
+    BOOST_TEST(distance(sess.posns().begin(), sess.posns().end()) == 1);
+    // Execs keep the order in which they were read.
+    BOOST_TEST(sess.execs().size() == 3U);
+    BOOST_TEST(sess.execs()[0]->id() == 5_id64);
+    BOOST_TEST(sess.execs()[2]->id() == 1_id64);
+
+    // Orders keep their priority across sessions.
+    const auto& level = *app.market(MarketId).bid_side().levels().begin();
+    BOOST_TEST(level.lots() == 6_lts);
+    Id64 id{};
+    for (const auto& entry : level.entries()) {
+        BOOST_TEST(entry.order()->id() == ++id);
+    }
+    BOOST_TEST(id == 6_id64);
+}
+
+BOOST_AUTO_TEST_CASE(AppLazyExecs)
+{
+    const ConcurrentModel model;
+    MsgQueue mq{1 << 10};
+    App app{mq, 2};
+    app.load(model, Now, 1, true);
+
+    BOOST_TEST(app.sess("MARAYL"sv).execs().empty());
+    // Only the most recent history is read.
+    const auto& sess = app.sess_with_execs("MARAYL"sv);
+    BOOST_TEST(sess.execs().size() == 2U);
+    BOOST_TEST(sess.execs()[0]->id() == 5_id64);
+    BOOST_TEST(sess.execs()[1]->id() == 3_id64);
+    BOOST_TEST(app.sess("GOSAYL"sv).execs().empty());
+}
+
+BOOST_AUTO_TEST_CASE(AppExecHistory)
+{
+    const ConcurrentModel model;
+    MsgQueue mq{1 << 10};
+    App app{mq, 2};
+    app.load(model, Now, 1, true);
+
+    BOOST_TEST(!app.execs_loaded("MARAYL"sv));
+    // History read off the matching thread is applied afterwards.
+    vector<ConstExecPtr> execs;
+    app.read_exec_history("MARAYL"sv, execs);
+    BOOST_TEST(execs.size() == 2U);
+    app.set_exec_history("MARAYL"sv, execs);
+    BOOST_TEST(app.execs_loaded("MARAYL"sv));
+
+    const auto& sess = app.sess("MARAYL"sv);
+    BOOST_TEST(sess.execs().size() == 2U);
+    BOOST_TEST(sess.execs()[0]->id() == 5_id64);
+    BOOST_TEST(sess.execs()[1]->id() == 3_id64);
+
+    // Applying the history twice has no effect.
+    app.set_exec_history("MARAYL"sv, execs);
+    BOOST_TEST(sess.execs().size() == 2U);
+
+    // Execs pushed before the history is read are not duplicated.
+    Sess other{1_id32, "MARAYL"sv, 3};
+    other.push_exec_front(execs[1]);
+    other.push_exec_history(execs);
+    BOOST_TEST(other.execs().size() == 2U);
+    BOOST_TEST(other.execs()[0]->id() == 3_id64);
+    BOOST_TEST(other.execs()[1]->id() == 5_id64);
+}
+
 BOOST_FIXTURE_TEST_CASE(AppAssets, AppFixture)
 {
     BOOST_TEST(distance(app.assets().begin(), app.assets().end()) == 24);
@@ -195,4 +303,290 @@ BOOST_FIXTURE_TEST_CASE(AppCreateOrder, AppFixture)
     BOOST_TEST(order->modified() == Now);
 }
 
+BOOST_FIXTURE_TEST_CASE(AppOrderSess, AppFixture)
+{
+    auto& marayl = app.sess("MARAYL"sv);
+    auto& gosayl = app.sess("GOSAYL"sv);
+    BOOST_TEST(&app.sess("MARAYL"sv) == &marayl);
+    BOOST_TEST(app.sess_id("MARAYL"sv) == marayl.id());
+    BOOST_TEST(&app.sess(marayl.id()) == &marayl);
+    auto& market = app.market(MarketId);
+
+    Response resp;
+    app.create_order(marayl, market, ""sv, Side::Buy, 5_lts, 12345_tks, 1_lts, Now, resp);
+    ConstOrderPtr maker{resp.orders().front()};
+    // Resting orders refer to the session that holds them.
+    BOOST_TEST(marayl.id() != gosayl.id());
+    BOOST_TEST(maker->sess_id() == marayl.id());
+
+    resp.clear();
+    app.create_order(gosayl, market, ""sv, Side::Sell, 5_lts, 12345_tks, 1_lts, Now, resp);
+    BOOST_TEST(maker->done());
+    BOOST_TEST(maker->sess_id() == 0_id32);
+    BOOST_TEST(marayl.orders().begin() == marayl.orders().end());
+    BOOST_TEST(distance(marayl.trades().begin(), marayl.trades().end()) == 1);
+}
+
+BOOST_FIXTURE_TEST_CASE(AppCreateOrders, AppFixture)
+{
+    auto& sess = app.sess("MARAYL"sv);
+    const Instr& instr = app.instr("EURUSD"sv);
+    const auto market_id = to_market_id(instr.id(), SettlDay);
+    auto& market = app.market(market_id);
+
+    const NewOrder new_orders[] = {{"a"sv, Side::Buy, 5_lts, 12344_tks, 1_lts},
+                                   {"b"sv, Side::Buy, 0_lts, 12343_tks, 0_lts},
+                                   {"a"sv, Side::Buy, 5_lts, 12343_tks, 1_lts},
+                                   // Crosses with the first order.
+                                   {"c"sv, Side::Sell, 2_lts, 12344_tks, 1_lts}};
+    Response resp;
+    vector<error_code> errs;
+    app.create_orders(sess, market, new_orders, Now, resp, errs);
+
+    BOOST_TEST(errs.size() == 4U);
+    BOOST_TEST(!errs[0]);
+    BOOST_TEST(errs[1] == make_error_code(Error::InvalidLots));
+    BOOST_TEST(errs[2] == make_error_code(Error::RefAlreadyExists));
+    BOOST_TEST(!errs[3]);
+
+    BOOST_TEST(sess.exists("a"sv));
+    BOOST_TEST(resp.orders().front()->resd_lots() == 3_lts);
+    BOOST_TEST(!sess.exists("b"sv));
+    BOOST_TEST(!sess.exists("c"sv));
+    BOOST_TEST(market.bid_side().levels().begin()->lots() == 3_lts);
+    BOOST_TEST(resp.market() == &market);
+    BOOST_TEST(resp.posn());
+}
+
+BOOST_FIXTURE_TEST_CASE(AppCreateOrdersQueueFull, SmallQueueFixture)
+{
+    auto& sess = app.sess("MARAYL"sv);
+    auto& market = app.market(MarketId);
+
+    // The match requires more chunks than remain after the first two orders, but the batch passes
+    // the initial capacity check.
+    const NewOrder new_orders[] = {{"a"sv, Side::Buy, 1_lts, 12344_tks, 1_lts},
+                                   {"b"sv, Side::Buy, 1_lts, 12344_tks, 1_lts},
+                                   {"c"sv, Side::Sell, 2_lts, 12344_tks, 1_lts},
+                                   {"d"sv, Side::Buy, 5_lts, 12343_tks, 1_lts}};
+    Response resp;
+    vector<error_code> errs;
+    app.create_orders(sess, market, new_orders, Now, resp, errs);
+
+    BOOST_TEST(errs.size() == 4U);
+    BOOST_TEST(!errs[0]);
+    BOOST_TEST(!errs[1]);
+    BOOST_TEST(errs[2] == make_error_code(Error::ServiceUnavailable));
+    BOOST_TEST(!errs[3]);
+
+    // The failed order was rolled back without matching, and later orders are still placed.
+    BOOST_TEST(!sess.exists("c"sv));
+    BOOST_TEST(sess.exists("d"sv));
+    BOOST_TEST(market.bid_side().levels().begin()->lots() == 2_lts);
+    BOOST_TEST(market.offer_side().levels().empty());
+    BOOST_TEST(mq.reserve() == 1U);
+
+    // Nothing from the failed order, or its matches, appears in the response.
+    BOOST_TEST(resp.orders().size() == 3U);
+    BOOST_TEST(resp.orders()[2]->ref() == "d"sv);
+    BOOST_TEST(resp.execs().size() == 3U);
+    for (const auto& exec : resp.execs()) {
+        BOOST_TEST(exec->ref() != "c"sv);
+        BOOST_TEST(exec->state() == State::New);
+    }
+}
+
+BOOST_FIXTURE_TEST_CASE(AppQuote, AppFixture)
+{
+    auto& sess = app.sess("MARAYL"sv);
+    auto& market = app.market(MarketId);
+
+    // Crossed.
+    Response resp;
+    BOOST_CHECK_THROW(
+        app.quote(sess, market, 12345_tks, 5_lts, 12345_tks, 5_lts, Now, resp),
+        InvalidTicksException);
+
+    resp.clear();
+    app.quote(sess, market, 12344_tks, 5_lts, 12346_tks, 5_lts, Now, resp);
+    BOOST_TEST(resp.orders().size() == 2U);
+    BOOST_TEST(resp.execs().size() == 2U);
+    BOOST_TEST(market.bid_side().levels().begin()->lots() == 5_lts);
+    BOOST_TEST(market.offer_side().levels().begin()->lots() == 5_lts);
+    const auto bid_id = resp.orders()[0]->id();
+    const ConstOrderPtr offer{resp.orders()[1]};
+
+    // Smaller bid at the same price is revised in place, and the unchanged offer is left alone.
+    resp.clear();
+    app.quote(sess, market, 12344_tks, 3_lts, 12346_tks, 5_lts, Now, resp);
+    BOOST_TEST(resp.orders().size() == 1U);
+    BOOST_TEST(resp.orders()[0]->id() == bid_id);
+    BOOST_TEST(resp.execs()[0]->state() == State::Revise);
+    BOOST_TEST(market.bid_side().levels().begin()->lots() == 3_lts);
+
+    // New offer price replaces the offer.
+    resp.clear();
+    app.quote(sess, market, 12344_tks, 3_lts, 12345_tks, 5_lts, Now, resp);
+    BOOST_TEST(resp.execs().size() == 2U);
+    BOOST_TEST(offer->done());
+    BOOST_TEST(sess.orders().find(MarketId, offer->id()) == sess.orders().end());
+    BOOST_TEST(market.offer_side().levels().begin()->ticks() == 12345_tks);
+
+    // Withdraw both sides.
+    resp.clear();
+    app.quote(sess, market, 0_tks, 0_lts, 0_tks, 0_lts, Now, resp);
+    BOOST_TEST(resp.execs().size() == 2U);
+    BOOST_TEST(market.bid_side().levels().empty());
+    BOOST_TEST(market.offer_side().levels().empty());
+}
+
+BOOST_FIXTURE_TEST_CASE(AppCancelSess, AppFixture)
+{
+    auto& marayl = app.sess("MARAYL"sv);
+    auto& gosayl = app.sess("GOSAYL"sv);
+    auto& market = app.market(MarketId);
+
+    // More than a single batch.
+    Response resp;
+    for (int i{0}; i < 300; ++i) {
+        resp.clear();
+        app.create_order(marayl, market, ""sv, Side::Buy, 1_lts, 12340_tks - Ticks{i % 5}, 1_lts,
+                         Now, resp);
+    }
+    resp.clear();
+    app.create_order(gosayl, market, ""sv, Side::Sell, 1_lts, 12345_tks, 1_lts, Now, resp);
+
+    // Drain queue.
+    Msg msg;
+    while (mq.pop(msg)) {
+    }
+
+    app.cancel_order(marayl, Now);
+    BOOST_TEST(marayl.orders().begin() == marayl.orders().end());
+    BOOST_TEST(market.bid_side().levels().empty());
+    BOOST_TEST(!market.offer_side().levels().empty());
+
+    int n{0};
+    while (mq.pop(msg)) {
+        // Copy packed fields.
+        const auto type = msg.type;
+        const auto state = msg.create_exec.state;
+        BOOST_TEST((type == MsgType::CreateExec));
+        BOOST_TEST((state == State::Cancel));
+        ++n;
+    }
+    BOOST_TEST(n == 300);
+}
+
+BOOST_FIXTURE_TEST_CASE(AppCancelMarket, AppFixture)
+{
+    auto& marayl = app.sess("MARAYL"sv);
+    auto& gosayl = app.sess("GOSAYL"sv);
+    auto& market = app.market(MarketId);
+
+    Response resp;
+    app.create_order(marayl, market, ""sv, Side::Buy, 5_lts, 12344_tks, 1_lts, Now, resp);
+    resp.clear();
+    app.create_order(gosayl, market, ""sv, Side::Buy, 5_lts, 12344_tks, 1_lts, Now, resp);
+    resp.clear();
+    app.create_order(marayl, market, ""sv, Side::Sell, 5_lts, 12346_tks, 1_lts, Now, resp);
+
+    app.cancel_order(market, Now);
+    BOOST_TEST(market.bid_side().levels().empty());
+    BOOST_TEST(market.offer_side().levels().empty());
+    BOOST_TEST(marayl.orders().begin() == marayl.orders().end());
+    BOOST_TEST(gosayl.orders().begin() == gosayl.orders().end());
+    BOOST_TEST(marayl.execs().front()->state() == State::Cancel);
+    BOOST_TEST(gosayl.execs().front()->state() == State::Cancel);
+}
+
+BOOST_FIXTURE_TEST_CASE(AppEndOfDay, AppFixture)
+{
+    auto& marayl = app.sess("MARAYL"sv);
+    auto& gosayl = app.sess("GOSAYL"sv);
+    auto& market = app.market(MarketId);
+
+    Response resp;
+    app.create_order(marayl, market, ""sv, Side::Buy, 5_lts, 12344_tks, 1_lts, Now, resp);
+    resp.clear();
+    app.create_order(marayl, market, ""sv, Side::Buy, 5_lts, 12343_tks, 1_lts, Now, resp);
+    resp.clear();
+    app.create_order(marayl, market, ""sv, Side::Sell, 5_lts, 12346_tks, 1_lts, Now, resp);
+    resp.clear();
+    app.create_order(gosayl, market, ""sv, Side::Sell, 2_lts, 12344_tks, 1_lts, Now, resp);
+
+    // Market is still open.
+    BOOST_TEST(app.expire_end_of_day(Now, 1));
+    BOOST_TEST(!market.bid_side().levels().empty());
+
+    const auto later = jd_to_time(SettlDay + 1_jd);
+    int slices{0};
+    do {
+        ++slices;
+    } while (!app.expire_end_of_day(later, 1));
+    // One slice per resting order.
+    BOOST_TEST(slices == 3);
+    BOOST_TEST(market.bid_side().levels().empty());
+    BOOST_TEST(market.offer_side().levels().empty());
+    BOOST_TEST(marayl.orders().begin() == marayl.orders().end());
+    BOOST_TEST(marayl.execs().front()->state() == State::Cancel);
+
+    // Nothing left to do for the business-day.
+    BOOST_TEST(app.expire_end_of_day(later, 1));
+
+    BOOST_TEST(!app.settl_end_of_day(later, 1));
+    app.settl_end_of_day(later);
+
+    const auto rolled_id = to_market_id(1_id32, 0_jd) & Id64{~0xffff};
+    BOOST_TEST(marayl.posns().find(MarketId) == marayl.posns().end());
+    auto it = marayl.posns().find(rolled_id);
+    BOOST_TEST_REQUIRE(it != marayl.posns().end());
+    BOOST_TEST(it->settl_day() == 0_jd);
+    BOOST_TEST(it->net_lots() == 2_lts);
+    it = gosayl.posns().find(rolled_id);
+    BOOST_TEST_REQUIRE(it != gosayl.posns().end());
+    BOOST_TEST(it->net_lots() == -2_lts);
+}
+
+BOOST_FIXTURE_TEST_CASE(AppTimeInForce, AppFixture)
+{
+    auto& marayl = app.sess("MARAYL"sv);
+    auto& gosayl = app.sess("GOSAYL"sv);
+    auto& market = app.market(MarketId);
+
+    Response resp;
+    app.create_order(gosayl, market, ""sv, Side::Sell, 3_lts, 12345_tks, 1_lts, Now, resp);
+    resp.clear();
+    app.create_order(gosayl, market, ""sv, Side::Sell, 3_lts, 12346_tks, 1_lts, Now, resp);
+
+    // Not enough liquidity at or below the limit price.
+    resp.clear();
+    app.create_order(marayl, market, ""sv, Side::Buy, 4_lts, 12345_tks, 1_lts, TimeInForce::Fok,
+                     Now, resp);
+    BOOST_TEST(resp.execs().size() == 2U);
+    BOOST_TEST(resp.execs().back()->state() == State::Cancel);
+    BOOST_TEST(resp.orders().front()->exec_lots() == 0_lts);
+    BOOST_TEST(market.offer_side().levels().begin()->lots() == 3_lts);
+
+    // Unfilled quantity is cancelled, and the order never rests.
+    resp.clear();
+    app.create_order(marayl, market, ""sv, Side::Buy, 4_lts, 12345_tks, 1_lts, TimeInForce::Ioc,
+                     Now, resp);
+    BOOST_TEST(resp.orders().front()->exec_lots() == 3_lts);
+    BOOST_TEST(resp.orders().front()->state() == State::Cancel);
+    BOOST_TEST(resp.execs().back()->state() == State::Cancel);
+    BOOST_TEST(resp.execs().back()->resd_lots() == 0_lts);
+    BOOST_TEST(market.bid_side().levels().empty());
+    BOOST_TEST(marayl.orders().begin() == marayl.orders().end());
+    BOOST_TEST(marayl.execs().front()->state() == State::Cancel);
+
+    // Enough liquidity across levels.
+    resp.clear();
+    app.create_order(marayl, market, ""sv, Side::Buy, 3_lts, 12346_tks, 1_lts, TimeInForce::Fok,
+                     Now, resp);
+    BOOST_TEST(resp.orders().front()->exec_lots() == 3_lts);
+    BOOST_TEST(resp.orders().front()->done());
+    BOOST_TEST(market.offer_side().levels().empty());
+}
+
 BOOST_AUTO_TEST_SUITE_END()
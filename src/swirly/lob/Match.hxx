@@ -22,25 +22,17 @@
 namespace swirly {
 inline namespace lob {
 
+/**
+ * Match record. The record does not own the objects that it refers to, so it is trivially copyable
+ * and free of reference-count traffic. For the duration of a transaction, the maker order and
+ * position are owned by the maker's session, and both trades by the transaction's exec list.
+ */
 struct Match {
-    Match(Lots lots, const OrderPtr& maker_order, const ExecPtr& maker_trade,
-          const PosnPtr& maker_posn, const ExecPtr& taker_trade) noexcept;
-
-    ~Match();
-
-    // Copy.
-    Match(const Match&);
-    Match& operator=(const Match&) = delete;
-
-    // Move.
-    Match(Match&&);
-    Match& operator=(Match&&) = delete;
-
-    const Lots lots;
-    const OrderPtr maker_order;
-    const ExecPtr maker_trade;
-    const PosnPtr maker_posn;
-    const ExecPtr taker_trade;
+    Lots lots;
+    Order* maker_order;
+    Posn* maker_posn;
+    Exec* maker_trade;
+    Exec* taker_trade;
 };
 
 } // namespace lob
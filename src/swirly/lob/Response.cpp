@@ -113,5 +113,17 @@ void Response::set_posn(const ConstPosnPtr& posn) noexcept
     posn_ = posn;
 }
 
+void Response::merge(const Response& other)
+{
+    orders_.insert(orders_.end(), other.orders_.begin(), other.orders_.end());
+    execs_.insert(execs_.end(), other.execs_.begin(), other.execs_.end());
+    if (other.market_) {
+        market_ = other.market_;
+    }
+    if (other.posn_) {
+        posn_ = other.posn_;
+    }
+}
+
 } // namespace lob
 } // namespace swirly
@@ -59,6 +59,8 @@ class SWIRLY_API Response {
 
     void set_posn(const ConstPosnPtr& posn) noexcept;
 
+    void merge(const Response& other);
+
   private:
     ConstMarketPtr market_;
     Orders orders_;
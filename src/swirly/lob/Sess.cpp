@@ -16,6 +16,8 @@
  */
 #include "Sess.hpp"
 
+#include <algorithm>
+
 namespace swirly {
 inline namespace lob {
 using namespace std;
@@ -26,6 +28,27 @@ Sess::~Sess() = default;
 
 Sess::Sess(Sess&&) = default;
 
+void Sess::push_exec_history(ArrayView<ConstExecPtr> execs)
+{
+    // Execs pushed since the model was loaded may also appear in the history. Their keys are sorted
+    // once, so that each exec in the history is checked in logarithmic time.
+    vector<pair<Id64, Id64>> held;
+    held.reserve(execs_.size());
+    for (const auto& ptr : execs_) {
+        held.emplace_back(ptr->market_id(), ptr->id());
+    }
+    sort(held.begin(), held.end());
+    for (const auto& exec : execs) {
+        assert(exec->accnt() == accnt_);
+        if (execs_.full()) {
+            break;
+        }
+        if (!binary_search(held.begin(), held.end(), make_pair(exec->market_id(), exec->id()))) {
+            execs_.push_back(exec);
+        }
+    }
+}
+
 PosnPtr Sess::posn(Id64 market_id, Symbol instr, JDay settl_day)
 {
     PosnSet::Iterator it;
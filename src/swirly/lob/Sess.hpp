@@ -23,8 +23,11 @@
 #include <swirly/fin/Order.hpp>
 #include <swirly/fin/Posn.hpp>
 
+#include <swirly/util/Array.hpp>
 #include <swirly/util/Set.hpp>
 
+#include <boost/container/flat_map.hpp>
+
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wstrict-aliasing"
 #include <boost/circular_buffer.hpp>
@@ -38,10 +41,20 @@ class Sess;
 using SessPtr = std::unique_ptr<Sess>;
 using ConstSessPtr = std::unique_ptr<const Sess>;
 
+/**
+ * Two-sided quote in a single market. Each side refers to the order most recently quoted on that
+ * side, which may since have been filled or cancelled.
+ */
+struct Quote {
+    OrderPtr bid;
+    OrderPtr offer;
+};
+
 class SWIRLY_API Sess : public Comparable<Sess> {
   public:
-    Sess(Symbol accnt, std::size_t max_execs) noexcept
-    : accnt_{accnt}
+    Sess(Id32 id, Symbol accnt, std::size_t max_execs) noexcept
+    : id_{id}
+    , accnt_{accnt}
     , execs_{max_execs}
     {
     }
@@ -66,6 +79,10 @@ class SWIRLY_API Sess : public Comparable<Sess> {
     {
         return ref_idx_.find(ref) != ref_idx_.end();
     }
+    /**
+     * Dense id, which is assigned by the application when the session is created.
+     */
+    auto id() const noexcept { return id_; }
     auto accnt() const noexcept { return accnt_; }
     const auto& orders() const noexcept { return orders_; }
     const auto& execs() const noexcept { return execs_; }
@@ -81,6 +98,7 @@ class SWIRLY_API Sess : public Comparable<Sess> {
     const auto& posns() const noexcept { return posns_; }
 
     auto& orders() noexcept { return orders_; }
+    auto& posns() noexcept { return posns_; }
     Order& order(Id64 market_id, Id64 id)
     {
         auto it = orders_.find(market_id, id);
@@ -104,6 +122,7 @@ class SWIRLY_API Sess : public Comparable<Sess> {
         if (!order->ref().empty()) {
             ref_idx_.insert(order);
         }
+        order->set_sess_id(id_);
     }
     OrderPtr remove_order(const Order& order) noexcept
     {
@@ -111,6 +130,7 @@ class SWIRLY_API Sess : public Comparable<Sess> {
         if (!order.ref().empty()) {
             ref_idx_.remove(order);
         }
+        order.set_sess_id(0_id32);
         return orders_.remove(order);
     }
     void push_exec_back(const ConstExecPtr& exec) noexcept
@@ -123,6 +143,19 @@ class SWIRLY_API Sess : public Comparable<Sess> {
         assert(exec->accnt() == accnt_);
         execs_.push_front(exec);
     }
+    /**
+     * Returns false while the session's exec history has yet to be read from the model.
+     */
+    bool execs_loaded() const noexcept { return execs_loaded_; }
+    void set_execs_loaded(bool loaded) noexcept { execs_loaded_ = loaded; }
+    /**
+     * Append execs from the session's history behind those pushed since the model was loaded.
+     * Execs that are already held are skipped, and appending stops once the history is full.
+     *
+     * Throws std::bad_alloc.
+     */
+    void push_exec_history(ArrayView<ConstExecPtr> execs);
+
     void insert_trade(const ExecPtr& trade) noexcept
     {
         assert(trade->accnt() == accnt_);
@@ -144,16 +177,30 @@ class SWIRLY_API Sess : public Comparable<Sess> {
         assert(posn->accnt() == accnt_);
         posns_.insert(posn);
     }
+    PosnPtr remove_posn(const Posn& posn) noexcept
+    {
+        assert(posn.accnt() == accnt_);
+        return posns_.remove(posn);
+    }
+    /**
+     * Returns the quote for the market, which is created if it does not exist.
+     *
+     * Throws std::bad_alloc.
+     */
+    Quote& quote(Id64 market_id) { return quotes_[market_id]; }
     boost::intrusive::set_member_hook<> symbol_hook;
     using PosnSet = IdSet<Posn, MarketIdTraits<Posn>>;
 
   private:
+    const Id32 id_;
     const Symbol accnt_;
     OrderIdSet orders_;
     boost::circular_buffer<ConstExecPtr> execs_;
+    bool execs_loaded_{true};
     ExecIdSet trades_;
     PosnSet posns_;
     OrderRefSet ref_idx_;
+    boost::container::flat_map<Id64, Quote> quotes_;
 };
 
 namespace detail {
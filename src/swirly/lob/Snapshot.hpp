@@ -0,0 +1,78 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_LOB_SNAPSHOT_HPP
+#define SWIRLY_LOB_SNAPSHOT_HPP
+
+#include <swirly/lob/App.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace swirly {
+inline namespace lob {
+
+/**
+ * Add the application's state to a snapshot builder, such as FbsSnapshot. The application must not
+ * be modified while the snapshot is being taken.
+ *
+ * Orders are loaded into the book in the order that they are read, so they are added in priority
+ * order. Order-ids increase monotonically within each market, and revised orders keep their ids, so
+ * priority order is simply order-id order.
+ */
+template <typename SnapshotT>
+void take_snapshot(const App& app, SnapshotT& snap)
+{
+    for (const auto& asset : app.assets()) {
+        snap.add_asset(asset);
+    }
+    for (const auto& instr : app.instrs()) {
+        snap.add_instr(instr);
+    }
+    for (const auto& market : app.markets()) {
+        snap.add_market(market);
+    }
+    std::vector<const Order*> orders;
+    for (const auto& sess : app.sesss()) {
+        for (const auto& order : sess.orders()) {
+            orders.push_back(&order);
+        }
+    }
+    std::sort(orders.begin(), orders.end(), [](const Order* lhs, const Order* rhs) {
+        return std::make_pair(lhs->market_id(), lhs->id())
+            < std::make_pair(rhs->market_id(), rhs->id());
+    });
+    for (const auto* order : orders) {
+        snap.add_order(*order);
+    }
+    for (const auto& sess : app.sesss()) {
+        // Most recent first.
+        for (const auto& exec : sess.execs()) {
+            snap.add_exec(*exec);
+        }
+        for (const auto& trade : sess.trades()) {
+            snap.add_trade(trade);
+        }
+        for (const auto& posn : sess.posns()) {
+            snap.add_posn(posn);
+        }
+    }
+}
+
+} // namespace lob
+} // namespace swirly
+
+#endif // SWIRLY_LOB_SNAPSHOT_HPP
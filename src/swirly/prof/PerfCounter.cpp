@@ -0,0 +1,89 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "PerfCounter.hpp"
+
+#include <linux/perf_event.h>
+
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+
+#include <unistd.h>
+
+namespace swirly {
+inline namespace prof {
+using namespace std;
+namespace {
+
+uint64_t to_config(PerfEvent event) noexcept
+{
+    switch (event) {
+    case PerfEvent::CacheMisses:
+        return PERF_COUNT_HW_CACHE_MISSES;
+    case PerfEvent::CacheRefs:
+        return PERF_COUNT_HW_CACHE_REFERENCES;
+    case PerfEvent::BranchMisses:
+        return PERF_COUNT_HW_BRANCH_MISSES;
+    case PerfEvent::Instructions:
+        break;
+    }
+    return PERF_COUNT_HW_INSTRUCTIONS;
+}
+
+} // namespace
+
+PerfCounter::PerfCounter(PerfEvent event) noexcept
+{
+    perf_event_attr attr{};
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.size = sizeof(attr);
+    attr.config = to_config(event);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Calling thread on any cpu.
+    fd_ = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+PerfCounter::~PerfCounter()
+{
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+void PerfCounter::start() noexcept
+{
+    if (fd_ >= 0) {
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+}
+
+void PerfCounter::stop() noexcept
+{
+    if (fd_ >= 0) {
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t n;
+        if (read(fd_, &n, sizeof(n)) == sizeof(n)) {
+            value_ += n;
+            ++count_;
+        }
+    }
+}
+
+} // namespace prof
+} // namespace swirly
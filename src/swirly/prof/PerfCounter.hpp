@@ -0,0 +1,100 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLY_PROF_PERFCOUNTER_HPP
+#define SWIRLY_PROF_PERFCOUNTER_HPP
+
+#include <swirly/Config.h>
+
+#include <cstdint>
+
+namespace swirly {
+inline namespace prof {
+
+enum class PerfEvent { CacheMisses, CacheRefs, BranchMisses, Instructions };
+
+/**
+ * Hardware performance counter for the calling thread. The counter is backed by perf_event_open(2)
+ * and only counts user-space events. If the kernel does not permit access to performance events,
+ * then the counter is invalid and all operations are no-ops.
+ */
+class SWIRLY_API PerfCounter {
+  public:
+    explicit PerfCounter(PerfEvent event) noexcept;
+    ~PerfCounter();
+
+    // Copy.
+    PerfCounter(const PerfCounter& rhs) = delete;
+    PerfCounter& operator=(const PerfCounter& rhs) = delete;
+
+    // Move.
+    PerfCounter(PerfCounter&&) = delete;
+    PerfCounter& operator=(PerfCounter&&) = delete;
+
+    bool valid() const noexcept { return fd_ >= 0; }
+    /**
+     * Returns the sum of events counted between calls to start and stop.
+     */
+    std::uint64_t value() const noexcept { return value_; }
+    /**
+     * Returns the number of intervals counted.
+     */
+    std::uint64_t count() const noexcept { return count_; }
+    double mean() const noexcept { return count_ > 0 ? double(value_) / count_ : 0.0; }
+
+    void reset() noexcept
+    {
+        value_ = 0;
+        count_ = 0;
+    }
+    void start() noexcept;
+    void stop() noexcept;
+
+  private:
+    int fd_{-1};
+    std::uint64_t value_{0};
+    std::uint64_t count_{0};
+};
+
+/**
+ * Count events during object lifetime, i.e., between constructor and destructor calls. The events
+ * are added to the PerfCounter object during destruction.
+ */
+class SWIRLY_API PerfRecorder {
+  public:
+    explicit PerfRecorder(PerfCounter& counter) noexcept
+    : counter_(counter)
+    {
+        counter_.start();
+    }
+    ~PerfRecorder() { counter_.stop(); }
+
+    // Copy.
+    PerfRecorder(const PerfRecorder& rhs) = delete;
+    PerfRecorder& operator=(const PerfRecorder& rhs) = delete;
+
+    // Move.
+    PerfRecorder(PerfRecorder&&) = delete;
+    PerfRecorder& operator=(PerfRecorder&&) = delete;
+
+  private:
+    PerfCounter& counter_;
+};
+
+} // namespace prof
+} // namespace swirly
+
+#endif // SWIRLY_PROF_PERFCOUNTER_HPP
@@ -172,6 +172,52 @@ inline void ftruncate(int fd, off_t length)
     }
 }
 
+/**
+ * Synchronise a file's in-core state with the storage device.
+ */
+inline void fsync(int fd, std::error_code& ec) noexcept
+{
+    const auto ret = ::fsync(fd);
+    if (ret < 0) {
+        ec = make_error(errno);
+    }
+}
+
+/**
+ * Synchronise a file's in-core state with the storage device.
+ */
+inline void fsync(int fd)
+{
+    const auto ret = ::fsync(fd);
+    if (ret < 0) {
+        throw std::system_error{make_error(errno), "fsync"};
+    }
+}
+
+/**
+ * Synchronise a file's data with the storage device, but not metadata that is not required to
+ * read the data back, such as the modification time.
+ */
+inline void fdatasync(int fd, std::error_code& ec) noexcept
+{
+    const auto ret = ::fdatasync(fd);
+    if (ret < 0) {
+        ec = make_error(errno);
+    }
+}
+
+/**
+ * Synchronise a file's data with the storage device, but not metadata that is not required to
+ * read the data back, such as the modification time.
+ */
+inline void fdatasync(int fd)
+{
+    const auto ret = ::fdatasync(fd);
+    if (ret < 0) {
+        throw std::system_error{make_error(errno), "fdatasync"};
+    }
+}
+
 /**
  * Read from a file descriptor.
  */
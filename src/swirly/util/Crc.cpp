@@ -0,0 +1,56 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "Crc.hpp"
+
+#include <array>
+
+namespace swirly {
+inline namespace util {
+using namespace std;
+namespace {
+
+constexpr array<uint32_t, 256> make_crc_table() noexcept
+{
+    // Reflected Castagnoli polynomial.
+    constexpr uint32_t Poly{0x82f63b78};
+    array<uint32_t, 256> table{};
+    for (uint32_t i{0}; i < 256; ++i) {
+        uint32_t crc{i};
+        for (int j{0}; j < 8; ++j) {
+            crc = (crc >> 1) ^ (Poly & -(crc & 1));
+        }
+        table[i] = crc;
+    }
+    return table;
+}
+
+constexpr auto CrcTable = make_crc_table();
+
+} // namespace
+
+uint32_t crc32c(const char* data, size_t len) noexcept
+{
+    uint32_t crc{~0U};
+    const auto* p = reinterpret_cast<const unsigned char*>(data);
+    for (const auto* const end = p + len; p != end; ++p) {
+        crc = CrcTable[(crc ^ *p) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+} // namespace util
+} // namespace swirly
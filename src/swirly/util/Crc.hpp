@@ -14,30 +14,23 @@
  * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
  * 02110-1301, USA.
  */
-#include "Match.hxx"
+#ifndef SWIRLY_UTIL_CRC_HPP
+#define SWIRLY_UTIL_CRC_HPP
 
-#include <swirly/fin/Exec.hpp>
-#include <swirly/fin/Order.hpp>
-#include <swirly/fin/Posn.hpp>
+#include <swirly/Config.h>
 
-namespace swirly {
-inline namespace lob {
-
-Match::Match(Lots lots, const OrderPtr& maker_order, const ExecPtr& maker_trade,
-             const PosnPtr& maker_posn, const ExecPtr& taker_trade) noexcept
-: lots{lots}
-, maker_order{maker_order}
-, maker_trade{maker_trade}
-, maker_posn{maker_posn}
-, taker_trade{taker_trade}
-{
-}
-
-Match::~Match() = default;
+#include <cstddef>
+#include <cstdint>
 
-Match::Match(const Match&) = default;
+namespace swirly {
+inline namespace util {
 
-Match::Match(Match&&) = default;
+/**
+ * @return the CRC-32C (Castagnoli) checksum of the buffer.
+ */
+SWIRLY_API std::uint32_t crc32c(const char* data, std::size_t len) noexcept;
 
-} // namespace lob
+} // namespace util
 } // namespace swirly
+
+#endif // SWIRLY_UTIL_CRC_HPP
@@ -0,0 +1,37 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "Crc.hpp"
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace swirly;
+
+BOOST_AUTO_TEST_SUITE(CrcSuite)
+
+BOOST_AUTO_TEST_CASE(Crc32cCase)
+{
+    BOOST_TEST(crc32c("", 0) == 0U);
+    // Standard check value.
+    BOOST_TEST(crc32c("123456789", 9) == 0xe3069283U);
+
+    char buf[] = "123456789";
+    buf[4] ^= 0x01;
+    BOOST_TEST(crc32c(buf, 9) != 0xe3069283U);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
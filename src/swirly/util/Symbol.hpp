@@ -107,6 +107,15 @@ class Symbol {
         return u64_[0] == rhs.u64_[0] && u64_[1] == rhs.u64_[1];
     }
     std::size_t size() const noexcept { return strnlen(buf_, sizeof(buf_)); }
+    /**
+     * Returns a hash of the two words that hold the symbol, so that the characters are not scanned.
+     */
+    std::size_t hash() const noexcept
+    {
+        auto h = static_cast<std::uint64_t>(u64_[0]) * 0x9e3779b97f4a7c15;
+        h = (h ^ static_cast<std::uint64_t>(u64_[1])) * 0xc2b2ae3d27d4eb4f;
+        return h ^ (h >> 32);
+    }
     constexpr void clear() noexcept
     {
         u64_[0] = 0;
@@ -263,4 +272,11 @@ struct TypeTraits<Symbol> {
 } // namespace util
 } // namespace swirly
 
+namespace std {
+template <>
+struct hash<swirly::Symbol> {
+    std::size_t operator()(swirly::Symbol symbol) const noexcept { return symbol.hash(); }
+};
+} // namespace std
+
 #endif // SWIRLY_UTIL_SYMBOL_HPP
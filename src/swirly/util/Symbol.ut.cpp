@@ -64,6 +64,15 @@ BOOST_AUTO_TEST_CASE(SymbolIndexCase)
     BOOST_TEST(symbol.back() == 'r');
 }
 
+BOOST_AUTO_TEST_CASE(SymbolHashCase)
+{
+    const hash<Symbol> h;
+    BOOST_TEST(h(Symbol{"Foo"sv}) == h(Symbol{"Foo"sv}));
+    BOOST_TEST(h(Symbol{"Foo"sv}) != h(Symbol{"Bar"sv}));
+    // Characters in the second word contribute to the hash.
+    BOOST_TEST(h(Symbol{"0123456789ABCDEF"sv}) != h(Symbol{"0123456789ABCDEG"sv}));
+}
+
 BOOST_AUTO_TEST_CASE(SymbolClearCase)
 {
     Symbol symbol{"Foo"sv};
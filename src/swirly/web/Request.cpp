@@ -16,10 +16,95 @@
  */
 #include "Request.hpp"
 
+#include <swirly/fin/Exception.hpp>
+
+#include <cctype>
+
 namespace swirly {
 inline namespace web {
+using namespace std;
 
 HttpRequest::~HttpRequest() = default;
 
+void HttpRequest::append_body(string_view sv)
+{
+    if (!started_) {
+        // The first non-space character determines whether the body is a single object or an array
+        // of objects.
+        const auto pos = sv.find_first_not_of(" \t\r\n"sv);
+        if (pos == string_view::npos) {
+            partial_ = !body_.parse(sv);
+            return;
+        }
+        started_ = true;
+        if (sv[pos] == '[') {
+            bulk_ = true;
+            partial_ = true;
+            sv.remove_prefix(pos + 1);
+        }
+    }
+    if (bulk_) {
+        append_bulk(sv);
+    } else {
+        partial_ = !body_.parse(sv);
+    }
+}
+
+void HttpRequest::append_bulk(string_view sv)
+{
+    // Each element is delimited here and then passed to the body parser, which is reset between
+    // elements. Elements may span calls.
+    size_t begin{0};
+    for (size_t i{0}; i < sv.size(); ++i) {
+        const char c{sv[i]};
+        if (depth_ == 0) {
+            if (c == '{' && !closed_) {
+                if (orders_.size() == MaxOrders) {
+                    throw BadRequestException{"too many orders in request"sv};
+                }
+                begin = i;
+                depth_ = 1;
+            } else if (c == ']' && !closed_) {
+                closed_ = true;
+            } else if (!isspace(static_cast<unsigned char>(c)) && (c != ',' || closed_)) {
+                throw BadRequestException{"parse error"sv};
+            }
+            continue;
+        }
+        if (in_str_) {
+            if (escape_) {
+                escape_ = false;
+            } else if (c == '\\') {
+                escape_ = true;
+            } else if (c == '"') {
+                in_str_ = false;
+            }
+        } else if (c == '"') {
+            in_str_ = true;
+        } else if (c == '{') {
+            ++depth_;
+        } else if (c == '}' && --depth_ == 0) {
+            if (!body_.parse(sv.substr(begin, i + 1 - begin))) {
+                throw BadRequestException{"parse error"sv};
+            }
+            auto& order = orders_.emplace_back();
+            order.fields = body_.fields();
+            const auto ref = body_.ref();
+            order.ref.len = ref.copy(order.ref.buf, sizeof(order.ref.buf));
+            order.side = body_.side();
+            order.lots = body_.lots();
+            order.ticks = body_.ticks();
+            order.min_lots = body_.min_lots();
+            order.tif = body_.tif();
+            body_.reset();
+        }
+    }
+    if (depth_ > 0) {
+        // Partial element.
+        body_.parse(sv.substr(begin));
+    }
+    partial_ = !closed_;
+}
+
 } // namespace web
 } // namespace swirly
@@ -21,11 +21,18 @@
 #include <swirly/web/Types.hpp>
 #include <swirly/web/Url.hpp>
 
+#include <vector>
+
 namespace swirly {
 inline namespace web {
 
 class SWIRLY_API HttpRequest : public BasicUrl<HttpRequest> {
   public:
+    /**
+     * Maximum number of elements in a bulk request body.
+     */
+    static constexpr std::size_t MaxOrders{256};
+
     HttpRequest() noexcept = default;
     ~HttpRequest();
 
@@ -42,7 +49,18 @@ class SWIRLY_API HttpRequest : public BasicUrl<HttpRequest> {
     auto accnt() const noexcept { return +accnt_; }
     auto perm() const noexcept { return +perm_; }
     auto time() const noexcept { return +time_; }
+    /**
+     * Returns true if the client asked for the response to be held until the effects of the
+     * request are durable, by specifying "Swirly-Durable: yes".
+     */
+    bool durable() const noexcept { return +durable_ == "yes"sv; }
     const auto& body() const noexcept { return body_; }
+    /**
+     * Returns true if the body is a JSON array of objects. Each element is then available through
+     * orders(), and the fields of body() are unspecified.
+     */
+    auto bulk() const noexcept { return bulk_; }
+    const auto& orders() const noexcept { return orders_; }
     auto partial() const noexcept { return partial_; }
     void clear() noexcept
     {
@@ -55,8 +73,17 @@ class SWIRLY_API HttpRequest : public BasicUrl<HttpRequest> {
         accnt_.clear();
         perm_.clear();
         time_.clear();
+        durable_.clear();
         body_.reset();
         partial_ = false;
+
+        orders_.clear();
+        started_ = false;
+        bulk_ = false;
+        closed_ = false;
+        in_str_ = false;
+        escape_ = false;
+        depth_ = 0;
     }
     void flush() { BasicUrl<HttpRequest>::parse(); }
     void set_method(HttpMethod method) noexcept { method_ = method; }
@@ -78,6 +105,8 @@ class SWIRLY_API HttpRequest : public BasicUrl<HttpRequest> {
                 value_ = &perm_;
             } else if (field_ == "Swirly-Time"sv) {
                 value_ = &time_;
+            } else if (field_ == "Swirly-Durable"sv) {
+                value_ = &durable_;
             } else {
                 value_ = nullptr;
             }
@@ -86,7 +115,7 @@ class SWIRLY_API HttpRequest : public BasicUrl<HttpRequest> {
             value_->append(sv);
         }
     }
-    void append_body(std::string_view sv) { partial_ = !body_.parse(sv); }
+    void append_body(std::string_view sv);
 
   private:
     HttpMethod method_{HttpMethod::Get};
@@ -97,8 +126,20 @@ class SWIRLY_API HttpRequest : public BasicUrl<HttpRequest> {
     StringBuf<24> accnt_;
     StringBuf<24> perm_;
     StringBuf<24> time_;
+    StringBuf<24> durable_;
     RestBody body_;
     bool partial_{false};
+
+    void append_bulk(std::string_view sv);
+
+    // Bulk body.
+    std::vector<RestOrder> orders_;
+    bool started_{false};
+    bool bulk_{false};
+    bool closed_{false};
+    bool in_str_{false};
+    bool escape_{false};
+    int depth_{0};
 };
 
 } // namespace web
@@ -0,0 +1,101 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "Request.hpp"
+
+#include <swirly/fin/Exception.hpp>
+
+#include <boost/test/unit_test.hpp>
+
+using namespace std;
+using namespace swirly;
+
+BOOST_AUTO_TEST_SUITE(RequestSuite)
+
+BOOST_AUTO_TEST_CASE(RequestBodyCase)
+{
+    HttpRequest req;
+
+    req.append_body(R"( {"side":"Buy",)"sv);
+    BOOST_TEST(req.partial());
+    req.append_body(R"("lots":10})"sv);
+    BOOST_TEST(!req.partial());
+    BOOST_TEST(!req.bulk());
+    BOOST_TEST(req.body().fields() == (RestBody::Side | RestBody::Lots));
+    BOOST_TEST(req.body().lots() == 10_lts);
+}
+
+BOOST_AUTO_TEST_CASE(RequestBulkCase)
+{
+    HttpRequest req;
+
+    req.append_body(R"( [{"ref":"a","side":"Buy","lots":10,"ticks":12345},{"ref":"b}",)"sv);
+    BOOST_TEST(req.partial());
+    BOOST_TEST(req.bulk());
+    req.append_body(R"("side":"Sell","lots":5,"ticks":12346,"tif":"IOC"} ] )"sv);
+    BOOST_TEST(!req.partial());
+
+    BOOST_TEST(req.orders().size() == 2U);
+    const auto& a = req.orders()[0];
+    BOOST_TEST(a.fields
+               == (RestBody::Ref | RestBody::Side | RestBody::Lots | RestBody::Ticks));
+    BOOST_TEST(+a.ref == "a"sv);
+    BOOST_TEST(a.side == Side::Buy);
+    BOOST_TEST(a.lots == 10_lts);
+    BOOST_TEST(a.ticks == 12345_tks);
+    BOOST_TEST(a.tif == TimeInForce::Gtc);
+    const auto& b = req.orders()[1];
+    BOOST_TEST(+b.ref == "b}"sv);
+    BOOST_TEST(b.side == Side::Sell);
+    BOOST_TEST(b.lots == 5_lts);
+    BOOST_TEST(b.ticks == 12346_tks);
+    BOOST_TEST((b.fields & RestBody::Tif) != 0U);
+    BOOST_TEST(b.tif == TimeInForce::Ioc);
+
+    req.clear();
+    BOOST_TEST(!req.bulk());
+    BOOST_TEST(req.orders().empty());
+}
+
+BOOST_AUTO_TEST_CASE(RequestDurableCase)
+{
+    HttpRequest req;
+    BOOST_TEST(!req.durable());
+
+    req.append_header_field("Swirly-Dur"sv, true);
+    req.append_header_field("able"sv, false);
+    req.append_header_value("y"sv, true);
+    req.append_header_value("es"sv, false);
+    BOOST_TEST(req.durable());
+
+    req.clear();
+    BOOST_TEST(!req.durable());
+
+    req.append_header_field("Swirly-Durable"sv, true);
+    req.append_header_value("no"sv, true);
+    BOOST_TEST(!req.durable());
+}
+
+BOOST_AUTO_TEST_CASE(RequestBulkErrorCase)
+{
+    HttpRequest req;
+    BOOST_CHECK_THROW(req.append_body(R"([{"lots":1}] {})"sv), BadRequestException);
+
+    req.clear();
+    BOOST_CHECK_THROW(req.append_body(R"([{"lots":1} 1])"sv), BadRequestException);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -16,6 +16,8 @@
  */
 #include "RestApp.hpp"
 
+#include <swirly/web/Types.hpp>
+
 #include <swirly/lob/Response.hpp>
 #include <swirly/lob/Sess.hpp>
 
@@ -152,7 +154,7 @@ void RestApp::get_instr(Symbol symbol, Time now, ostream& out) const
 
 void RestApp::get_sess(Symbol accnt, EntitySet es, Page page, Time now, ostream& out) const
 {
-    const auto& sess = app_.sess(accnt);
+    const auto& sess = es.exec() ? app_.sess_with_execs(accnt) : app_.sess(accnt);
     int i{0};
     out << '{';
     if (es.market()) {
@@ -262,7 +264,7 @@ void RestApp::get_order(Symbol accnt, Symbol instr_symbol, IsoDate settl_date, I
 
 void RestApp::get_exec(Symbol accnt, Page page, Time now, ostream& out) const
 {
-    detail::get_exec(app_.sess(accnt), page, out);
+    detail::get_exec(app_.sess_with_execs(accnt), page, out);
 }
 
 void RestApp::get_trade(Symbol accnt, Time now, ostream& out) const
@@ -357,17 +359,44 @@ void RestApp::put_market(Symbol instr_symbol, IsoDate settl_date, MarketState st
 }
 
 void RestApp::post_order(Symbol accnt, Symbol instr_symbol, IsoDate settl_date, string_view ref,
-                         Side side, Lots lots, Ticks ticks, Lots min_lots, Time now, ostream& out)
+                         Side side, Lots lots, Ticks ticks, Lots min_lots, TimeInForce tif,
+                         Time now, ostream& out)
 {
     const auto& sess = app_.sess(accnt);
     const auto& instr = app_.instr(instr_symbol);
     const auto market_id = to_market_id(instr.id(), settl_date);
     const auto& market = app_.market(market_id);
     Response resp;
-    app_.create_order(sess, market, ref, side, lots, ticks, min_lots, now, resp);
+    app_.create_order(sess, market, ref, side, lots, ticks, min_lots, tif, now, resp);
     out << resp;
 }
 
+void RestApp::post_orders(Symbol accnt, Symbol instr_symbol, IsoDate settl_date,
+                          ArrayView<NewOrder> new_orders, Time now, ostream& out)
+{
+    const auto& sess = app_.sess(accnt);
+    const auto& instr = app_.instr(instr_symbol);
+    const auto market_id = to_market_id(instr.id(), settl_date);
+    const auto& market = app_.market(market_id);
+    Response resp;
+    vector<error_code> errs;
+    app_.create_orders(sess, market, new_orders, now, resp, errs);
+    out << "{\"response\":" << resp << ",\"errors\":[";
+    for (size_t i{0}; i < errs.size(); ++i) {
+        if (i > 0) {
+            out << ',';
+        }
+        if (errs[i]) {
+            const auto status = http_status(errs[i]);
+            Exception::to_json(out, static_cast<int>(status), http_reason(status),
+                               errs[i].message().c_str());
+        } else {
+            out << "null";
+        }
+    }
+    out << "]}";
+}
+
 void RestApp::put_order(Symbol accnt, Symbol instr_symbol, IsoDate settl_date, ArrayView<Id64> ids,
                         Lots lots, Time now, ostream& out)
 {
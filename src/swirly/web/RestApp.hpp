@@ -41,7 +41,12 @@ class SWIRLY_API RestApp {
     RestApp(RestApp&&);
     RestApp& operator=(RestApp&&);
 
-    void load(const Model& model, Time now) { app_.load(model, now); }
+    void load(const Model& model, Time now, std::size_t threads = 1, bool lazy_execs = false)
+    {
+        app_.load(model, now, threads, lazy_execs);
+    }
+
+    const App& app() const noexcept { return app_; }
 
     void get_ref_data(EntitySet es, Time now, std::ostream& out) const;
 
@@ -97,7 +102,15 @@ class SWIRLY_API RestApp {
                     std::ostream& out);
 
     void post_order(Symbol accnt, Symbol instr, IsoDate settl_date, std::string_view ref, Side side,
-                    Lots lots, Ticks ticks, Lots min_lots, Time now, std::ostream& out);
+                    Lots lots, Ticks ticks, Lots min_lots, TimeInForce tif, Time now,
+                    std::ostream& out);
+
+    /**
+     * Create a batch of orders. The response contains the aggregate result, followed by one error
+     * object per order, or null if the order was created.
+     */
+    void post_orders(Symbol accnt, Symbol instr, IsoDate settl_date, ArrayView<NewOrder> new_orders,
+                     Time now, std::ostream& out);
 
     void put_order(Symbol accnt, Symbol instr, IsoDate settl_date, ArrayView<Id64> ids, Lots lots,
                    Time now, std::ostream& out);
@@ -109,6 +122,28 @@ class SWIRLY_API RestApp {
     void delete_trade(Symbol accnt, Symbol instr, IsoDate settl_date, ArrayView<Id64> ids,
                       Time now);
 
+    /**
+     * Perform a single slice of end-of-day expiry. Returns true if expiry is complete.
+     */
+    bool expire_end_of_day(Time now, std::size_t max_orders)
+    {
+        return app_.expire_end_of_day(now, max_orders);
+    }
+    /**
+     * Perform a single slice of end-of-day settlement. Returns true if settlement is complete.
+     */
+    bool settl_end_of_day(Time now, std::size_t max_sesss)
+    {
+        return app_.settl_end_of_day(now, max_sesss);
+    }
+    /**
+     * Set a session's exec history, which was read off the matching thread.
+     */
+    void set_exec_history(Symbol accnt, ArrayView<ConstExecPtr> execs)
+    {
+        app_.set_exec_history(accnt, execs);
+    }
+
   private:
     App app_;
 };
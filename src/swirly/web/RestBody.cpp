@@ -27,7 +27,7 @@ using namespace std;
 namespace {
 
 
-#line 262 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
+#line 279 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
 
 
 
@@ -40,9 +40,10 @@ static const char _json_actions[] = {
 	21, 1, 22, 1, 23, 1, 24, 1, 
 	25, 1, 26, 1, 27, 1, 28, 1, 
 	29, 1, 30, 1, 31, 1, 32, 1, 
-	34, 2, 0, 1, 2, 0, 2, 2, 
-	6, 3, 2, 9, 3, 2, 12, 3, 
-	2, 17, 3, 2, 33, 3
+	34, 1, 35, 1, 36, 1, 37, 2, 
+	0, 1, 2, 0, 2, 2, 6, 3, 
+	2, 9, 3, 2, 12, 3, 2, 17, 
+	3, 2, 33, 3
 };
 
 static const short _json_key_offsets[] = {
@@ -67,9 +68,11 @@ static const short _json_key_offsets[] = {
 	387, 392, 394, 396, 398, 399, 403, 411, 
 	413, 420, 421, 422, 423, 428, 430, 432, 
 	434, 436, 437, 441, 446, 448, 453, 453, 
-	454, 455, 456, 461, 463, 465, 467, 469, 
-	470, 474, 482, 484, 491, 492, 493, 494, 
-	499
+	454, 455, 456, 461, 463, 467, 469, 471, 
+	472, 476, 484, 486, 493, 494, 495, 496, 
+	501, 502, 506, 510, 516, 518, 520, 521, 
+	526, 528, 530, 531, 536, 538, 540, 541, 
+	546
 };
 
 static const char _json_trans_keys[] = {
@@ -131,11 +134,17 @@ static const char _json_trans_keys[] = {
 	13, 32, 34, 110, 9, 13, 34, 92, 
 	32, 44, 125, 9, 13, 117, 108, 108, 
 	32, 44, 125, 9, 13, 73, 105, 67, 
-	99, 75, 107, 83, 115, 34, 32, 58, 
-	9, 13, 32, 43, 45, 110, 9, 13, 
-	48, 57, 48, 57, 32, 44, 125, 9, 
-	13, 48, 57, 117, 108, 108, 32, 44, 
-	125, 9, 13, 32, 9, 13, 0
+	70, 99, 102, 75, 107, 83, 115, 34, 
+	32, 58, 9, 13, 32, 43, 45, 110, 
+	9, 13, 48, 57, 48, 57, 32, 44, 
+	125, 9, 13, 48, 57, 117, 108, 108, 
+	32, 44, 125, 9, 13, 34, 32, 58, 
+	9, 13, 32, 34, 9, 13, 70, 71, 
+	73, 102, 103, 105, 79, 111, 75, 107, 
+	34, 32, 44, 125, 9, 13, 84, 116, 
+	67, 99, 34, 32, 44, 125, 9, 13, 
+	79, 111, 67, 99, 34, 32, 44, 125, 
+	9, 13, 32, 9, 13, 0
 };
 
 static const char _json_single_lengths[] = {
@@ -160,8 +169,10 @@ static const char _json_single_lengths[] = {
 	3, 2, 2, 2, 1, 2, 4, 0, 
 	3, 1, 1, 1, 3, 2, 2, 2, 
 	2, 1, 2, 3, 2, 3, 0, 1, 
-	1, 1, 3, 2, 2, 2, 2, 1, 
+	1, 1, 3, 2, 4, 2, 2, 1, 
 	2, 4, 0, 3, 1, 1, 1, 3, 
+	1, 2, 2, 6, 2, 2, 1, 3, 
+	2, 2, 1, 3, 2, 2, 1, 3, 
 	1
 };
 
@@ -189,6 +200,8 @@ static const char _json_range_lengths[] = {
 	0, 0, 1, 1, 0, 1, 0, 0, 
 	0, 0, 1, 0, 0, 0, 0, 0, 
 	1, 2, 1, 2, 0, 0, 0, 1, 
+	0, 1, 1, 0, 0, 0, 0, 1, 
+	0, 0, 0, 1, 0, 0, 0, 1, 
 	1
 };
 
@@ -214,90 +227,99 @@ static const short _json_index_offsets[] = {
 	481, 486, 489, 492, 495, 497, 501, 508, 
 	510, 516, 518, 520, 522, 527, 530, 533, 
 	536, 539, 541, 545, 550, 553, 558, 559, 
-	561, 563, 565, 570, 573, 576, 579, 582, 
-	584, 588, 595, 597, 603, 605, 607, 609, 
-	614
+	561, 563, 565, 570, 573, 578, 581, 584, 
+	586, 590, 597, 599, 605, 607, 609, 611, 
+	616, 618, 622, 626, 633, 636, 639, 641, 
+	646, 649, 652, 654, 659, 662, 665, 667, 
+	672
 };
 
 static const unsigned char _json_trans_targs[] = {
-	1, 2, 1, 0, 2, 3, 184, 2, 
+	1, 2, 1, 0, 2, 3, 200, 2, 
 	0, 4, 20, 33, 47, 84, 100, 112, 
 	171, 4, 20, 33, 47, 84, 100, 112, 
 	171, 0, 5, 5, 0, 6, 6, 0, 
 	7, 7, 0, 8, 8, 0, 9, 0, 
 	9, 10, 9, 0, 10, 11, 16, 10, 
-	0, 12, 15, 11, 13, 14, 184, 13, 
-	0, 13, 14, 184, 13, 0, 14, 3, 
+	0, 12, 15, 11, 13, 14, 200, 13, 
+	0, 13, 14, 200, 13, 0, 14, 3, 
 	14, 0, 11, 17, 0, 18, 0, 19, 
-	0, 13, 14, 184, 13, 0, 21, 21, 
+	0, 13, 14, 200, 13, 0, 21, 21, 
 	0, 22, 22, 0, 23, 23, 0, 24, 
 	0, 24, 25, 24, 0, 25, 26, 29, 
-	25, 0, 27, 28, 26, 13, 14, 184, 
+	25, 0, 27, 28, 26, 13, 14, 200, 
 	13, 0, 26, 30, 0, 31, 0, 32, 
-	0, 13, 14, 184, 13, 0, 34, 34, 
+	0, 13, 14, 200, 13, 0, 34, 34, 
 	0, 35, 35, 0, 36, 36, 0, 37, 
 	37, 0, 38, 0, 38, 39, 38, 0, 
 	39, 40, 43, 39, 0, 41, 42, 40, 
-	13, 14, 184, 13, 0, 40, 44, 0, 
-	45, 0, 46, 0, 13, 14, 184, 13, 
+	13, 14, 200, 13, 0, 40, 44, 0, 
+	45, 0, 46, 0, 13, 14, 200, 13, 
 	0, 48, 73, 48, 73, 0, 49, 49, 
 	0, 50, 0, 51, 51, 0, 52, 52, 
 	0, 53, 53, 0, 54, 0, 54, 55, 
 	54, 0, 55, 56, 69, 55, 0, 57, 
 	63, 57, 63, 0, 58, 58, 0, 59, 
 	59, 0, 60, 60, 0, 61, 61, 0, 
-	62, 0, 13, 14, 184, 13, 0, 64, 
+	62, 0, 13, 14, 200, 13, 0, 64, 
 	64, 0, 65, 65, 0, 66, 66, 0, 
-	67, 67, 0, 68, 0, 13, 14, 184, 
+	67, 67, 0, 68, 0, 13, 14, 200, 
 	13, 0, 70, 0, 71, 0, 72, 0, 
-	13, 14, 184, 13, 0, 74, 74, 0, 
+	13, 14, 200, 13, 0, 74, 74, 0, 
 	75, 75, 0, 76, 0, 76, 77, 76, 
 	0, 77, 78, 78, 80, 77, 79, 0, 
-	79, 0, 13, 14, 184, 13, 79, 0, 
+	79, 0, 13, 14, 200, 13, 79, 0, 
 	81, 0, 82, 0, 83, 0, 13, 14, 
-	184, 13, 0, 85, 85, 0, 86, 86, 
+	200, 13, 0, 85, 85, 0, 86, 86, 
 	0, 87, 0, 88, 88, 0, 89, 89, 
 	0, 90, 90, 0, 91, 91, 0, 92, 
 	0, 92, 93, 92, 0, 93, 94, 94, 
 	96, 93, 95, 0, 95, 0, 13, 14, 
-	184, 13, 95, 0, 97, 0, 98, 0, 
-	99, 0, 13, 14, 184, 13, 0, 101, 
+	200, 13, 95, 0, 97, 0, 98, 0, 
+	99, 0, 13, 14, 200, 13, 0, 101, 
 	101, 0, 102, 102, 0, 103, 0, 103, 
 	104, 103, 0, 104, 105, 108, 104, 0, 
-	106, 107, 105, 13, 14, 184, 13, 0, 
+	106, 107, 105, 13, 14, 200, 13, 0, 
 	105, 109, 0, 110, 0, 111, 0, 13, 
-	14, 184, 13, 0, 113, 130, 145, 157, 
+	14, 200, 13, 0, 113, 130, 145, 157, 
 	113, 130, 145, 157, 0, 114, 114, 0, 
 	115, 115, 0, 116, 116, 0, 117, 0, 
 	118, 118, 0, 119, 119, 0, 120, 120, 
 	0, 121, 121, 0, 122, 0, 122, 123, 
 	122, 0, 123, 124, 124, 126, 123, 125, 
-	0, 125, 0, 13, 14, 184, 13, 125, 
+	0, 125, 0, 13, 14, 200, 13, 125, 
 	0, 127, 0, 128, 0, 129, 0, 13, 
-	14, 184, 13, 0, 131, 131, 0, 132, 
+	14, 200, 13, 0, 131, 131, 0, 132, 
 	132, 0, 133, 0, 133, 134, 133, 0, 
 	134, 135, 134, 0, 136, 140, 136, 140, 
 	0, 137, 137, 0, 138, 138, 0, 139, 
-	0, 13, 14, 184, 13, 0, 141, 141, 
+	0, 13, 14, 200, 13, 0, 141, 141, 
 	0, 142, 142, 0, 143, 143, 0, 144, 
-	0, 13, 14, 184, 13, 0, 146, 146, 
+	0, 13, 14, 200, 13, 0, 146, 146, 
 	0, 147, 147, 0, 148, 148, 0, 149, 
 	0, 149, 150, 149, 0, 150, 151, 151, 
 	153, 150, 152, 0, 152, 0, 13, 14, 
-	184, 13, 152, 0, 154, 0, 155, 0, 
-	156, 0, 13, 14, 184, 13, 0, 158, 
+	200, 13, 152, 0, 154, 0, 155, 0, 
+	156, 0, 13, 14, 200, 13, 0, 158, 
 	158, 0, 159, 159, 0, 160, 160, 0, 
 	161, 161, 0, 162, 0, 162, 163, 162, 
 	0, 163, 164, 167, 163, 0, 165, 166, 
-	164, 13, 14, 184, 13, 0, 164, 168, 
-	0, 169, 0, 170, 0, 13, 14, 184, 
-	13, 0, 172, 172, 0, 173, 173, 0, 
-	174, 174, 0, 175, 175, 0, 176, 0, 
-	176, 177, 176, 0, 177, 178, 178, 180, 
-	177, 179, 0, 179, 0, 13, 14, 184, 
-	13, 179, 0, 181, 0, 182, 0, 183, 
-	0, 13, 14, 184, 13, 0, 184, 184, 
-	0, 0
+	164, 13, 14, 200, 13, 0, 164, 168, 
+	0, 169, 0, 170, 0, 13, 14, 200, 
+	13, 0, 172, 172, 0, 173, 184, 173, 
+	184, 0, 174, 174, 0, 175, 175, 0, 
+	176, 0, 176, 177, 176, 0, 177, 178, 
+	178, 180, 177, 179, 0, 179, 0, 13, 
+	14, 200, 13, 179, 0, 181, 0, 182, 
+	0, 183, 0, 13, 14, 200, 13, 0, 
+	185, 0, 185, 186, 185, 0, 186, 187, 
+	186, 0, 188, 192, 196, 188, 192, 196, 
+	0, 189, 189, 0, 190, 190, 0, 191, 
+	0, 13, 14, 200, 13, 0, 193, 193, 
+	0, 194, 194, 0, 195, 0, 13, 14, 
+	200, 13, 0, 197, 197, 0, 198, 198, 
+	0, 199, 0, 13, 14, 200, 13, 0, 
+	200, 200, 0, 0
 };
 
 static const char _json_trans_actions[] = {
@@ -306,19 +328,19 @@ static const char _json_trans_actions[] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 0, 0, 0, 66, 0, 0, 
+	0, 0, 0, 0, 0, 72, 0, 0, 
 	0, 0, 0, 5, 13, 13, 13, 13, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 5, 0, 0, 0, 0, 0, 
 	0, 11, 11, 11, 11, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 0, 0, 0, 0, 75, 0, 
+	0, 0, 0, 0, 0, 0, 81, 0, 
 	0, 0, 0, 0, 5, 55, 55, 55, 
 	55, 0, 5, 0, 0, 0, 0, 0, 
 	0, 53, 53, 53, 53, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 69, 0, 0, 0, 0, 0, 5, 
+	0, 75, 0, 0, 0, 0, 0, 5, 
 	17, 17, 17, 17, 0, 5, 0, 0, 
 	0, 0, 0, 0, 15, 15, 15, 15, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
@@ -333,18 +355,18 @@ static const char _json_trans_actions[] = {
 	51, 0, 0, 0, 0, 0, 0, 0, 
 	47, 47, 47, 47, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 1, 57, 0, 0, 60, 0, 
+	0, 0, 1, 63, 0, 0, 66, 0, 
 	3, 0, 41, 41, 41, 41, 3, 0, 
 	0, 0, 0, 0, 0, 0, 39, 39, 
 	39, 39, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 0, 0, 0, 0, 1, 57, 
-	0, 0, 60, 0, 3, 0, 45, 45, 
+	0, 0, 0, 0, 0, 0, 1, 63, 
+	0, 0, 66, 0, 3, 0, 45, 45, 
 	45, 45, 3, 0, 0, 0, 0, 0, 
 	0, 0, 43, 43, 43, 43, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 0, 0, 72, 0, 0, 0, 
+	0, 0, 0, 0, 78, 0, 0, 0, 
 	0, 0, 5, 25, 25, 25, 25, 0, 
 	5, 0, 0, 0, 0, 0, 0, 23, 
 	23, 23, 23, 0, 0, 0, 0, 0, 
@@ -352,7 +374,7 @@ static const char _json_trans_actions[] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 0, 1, 57, 0, 0, 60, 
+	0, 0, 0, 1, 63, 0, 0, 66, 
 	0, 3, 0, 21, 21, 21, 21, 3, 
 	0, 0, 0, 0, 0, 0, 0, 19, 
 	19, 19, 19, 0, 0, 0, 0, 0, 
@@ -363,32 +385,39 @@ static const char _json_trans_actions[] = {
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 37, 37, 37, 37, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 0, 0, 0, 0, 1, 57, 
-	0, 0, 60, 0, 3, 0, 29, 29, 
+	0, 0, 0, 0, 0, 0, 1, 63, 
+	0, 0, 66, 0, 3, 0, 29, 29, 
 	29, 29, 3, 0, 0, 0, 0, 0, 
 	0, 0, 27, 27, 27, 27, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 63, 0, 0, 0, 0, 0, 
+	0, 0, 69, 0, 0, 0, 0, 0, 
 	5, 9, 9, 9, 9, 0, 5, 0, 
 	0, 0, 0, 0, 0, 7, 7, 7, 
 	7, 0, 0, 0, 0, 0, 0, 0, 
 	0, 0, 0, 0, 0, 0, 0, 0, 
-	0, 0, 0, 0, 0, 1, 57, 0, 
-	0, 60, 0, 3, 0, 33, 33, 33, 
-	33, 3, 0, 0, 0, 0, 0, 0, 
-	0, 31, 31, 31, 31, 0, 0, 0, 
-	0, 0
+	0, 0, 0, 0, 0, 0, 0, 1, 
+	63, 0, 0, 66, 0, 3, 0, 33, 
+	33, 33, 33, 3, 0, 0, 0, 0, 
+	0, 0, 0, 31, 31, 31, 31, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 0, 0, 
+	0, 61, 61, 61, 61, 0, 0, 0, 
+	0, 0, 0, 0, 0, 0, 57, 57, 
+	57, 57, 0, 0, 0, 0, 0, 0, 
+	0, 0, 0, 59, 59, 59, 59, 0, 
+	0, 0, 0, 0
 };
 
 static const int json_start = 1;
-static const int json_first_final = 184;
+static const int json_first_final = 200;
 static const int json_error = 0;
 
 static const int json_en_main = 1;
 
 
-#line 265 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
+#line 282 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
 
 } // anonymous
 
@@ -398,12 +427,12 @@ void RestBody::reset(bool clear) noexcept
 {
   decltype(cs_) cs;
   
-#line 402 "/home/marayl/repo/swirly/src/swirly/web/RestBody.cpp"
+#line 431 "/home/marayl/repo/swirly/src/swirly/web/RestBody.cpp"
 	{
 	cs = json_start;
 	}
 
-#line 274 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
+#line 291 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
   cs_ = cs;
 
   if (!clear) {
@@ -423,6 +452,7 @@ void RestBody::reset(bool clear) noexcept
   min_lots_ = 0_lts;
   liq_ind_ = swirly::LiqInd::None;
   cpty_.len = 0;
+  tif_ = swirly::TimeInForce::Gtc;
 }
 
 bool RestBody::parse(string_view buf)
@@ -433,7 +463,7 @@ bool RestBody::parse(string_view buf)
 
   auto cs = cs_;
   
-#line 437 "/home/marayl/repo/swirly/src/swirly/web/RestBody.cpp"
+#line 467 "/home/marayl/repo/swirly/src/swirly/web/RestBody.cpp"
 	{
 	int _klen;
 	unsigned int _trans;
@@ -757,7 +787,28 @@ _match:
     fields_ |= Cpty;
   }
 	break;
-#line 761 "/home/marayl/repo/swirly/src/swirly/web/RestBody.cpp"
+	case 35:
+#line 240 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
+	{
+    fields_ |= Tif;
+    tif_ = swirly::TimeInForce::Gtc;
+  }
+	break;
+	case 36:
+#line 244 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
+	{
+    fields_ |= Tif;
+    tif_ = swirly::TimeInForce::Ioc;
+  }
+	break;
+	case 37:
+#line 248 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
+	{
+    fields_ |= Tif;
+    tif_ = swirly::TimeInForce::Fok;
+  }
+	break;
+#line 812 "/home/marayl/repo/swirly/src/swirly/web/RestBody.cpp"
 		}
 	}
 
@@ -770,7 +821,7 @@ _again:
 	_out: {}
 	}
 
-#line 303 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
+#line 321 "/home/marayl/repo/swirly/src/swirly/web/RestBody.rl"
   cs_ = cs;
 
   if (cs == json_error) {
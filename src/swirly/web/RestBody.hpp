@@ -54,7 +54,8 @@ class SWIRLY_API RestBody {
         Ticks = 1 << 8,
         MinLots = 1 << 9,
         LiqInd = 1 << 10,
-        Cpty = 1 << 11
+        Cpty = 1 << 11,
+        Tif = 1 << 12
     };
 
     RestBody() noexcept { reset(); }
@@ -81,6 +82,7 @@ class SWIRLY_API RestBody {
     swirly::Lots min_lots() const noexcept { return min_lots_; }
     swirly::LiqInd liq_ind() const noexcept { return liq_ind_; }
     swirly::Symbol cpty() const noexcept { return +cpty_; }
+    swirly::TimeInForce tif() const noexcept { return tif_; }
     /**
      * Validate fields.
      *
@@ -125,10 +127,24 @@ class SWIRLY_API RestBody {
     swirly::Lots min_lots_;
     swirly::LiqInd liq_ind_;
     StringData<MaxSymbol> cpty_;
+    swirly::TimeInForce tif_;
 
     long num() const noexcept { return num_.sign * num_.digits; }
 };
 
+/**
+ * Order fields copied from a single element of a bulk request body.
+ */
+struct RestOrder {
+    unsigned fields;
+    StringData<MaxRef> ref;
+    swirly::Side side;
+    swirly::Lots lots;
+    swirly::Ticks ticks;
+    swirly::Lots min_lots;
+    swirly::TimeInForce tif;
+};
+
 } // namespace web
 } // namespace swirly
 
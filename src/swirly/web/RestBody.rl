@@ -237,6 +237,22 @@ namespace {
   cpty = 'null' %nullCpty
     | str >beginCpty %endCpty;
 
+  action gtcTif {
+    fields_ |= Tif;
+    tif_ = swirly::TimeInForce::Gtc;
+  }
+  action iocTif {
+    fields_ |= Tif;
+    tif_ = swirly::TimeInForce::Ioc;
+  }
+  action fokTif {
+    fields_ |= Tif;
+    tif_ = swirly::TimeInForce::Fok;
+  }
+  tif = '"GTC"'i %gtcTif
+    | '"IOC"'i %iocTif
+    | '"FOK"'i %fokTif;
+
   colon = space* ':' space*;
   comma = space* ',' space*;
 
@@ -251,7 +267,8 @@ namespace {
     | '"ticks"'i colon ticks
     | '"min_lots"'i colon minLots
     | '"liq_ind"'i colon liqInd
-    | '"cpty"'i colon cpty;
+    | '"cpty"'i colon cpty
+    | '"tif"'i colon tif;
 
   members = pair (comma pair)*;
 
@@ -290,6 +307,7 @@ void RestBody::reset(bool clear) noexcept
   min_lots_ = 0_lts;
   liq_ind_ = swirly::LiqInd::None;
   cpty_.len = 0;
+  tif_ = swirly::TimeInForce::Gtc;
 }
 
 bool RestBody::parse(string_view buf)
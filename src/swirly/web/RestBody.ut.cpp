@@ -198,6 +198,32 @@ BOOST_AUTO_TEST_CASE(RestBodyCptyCase)
     BOOST_TEST(rb.cpty().empty());
 }
 
+BOOST_AUTO_TEST_CASE(RestBodyTifCase)
+{
+    RestBody rb;
+
+    BOOST_TEST(rb.parse(R"({"tif":"IOC"})"sv));
+    BOOST_TEST(rb.fields() == RestBody::Tif);
+    BOOST_TEST(rb.tif() == TimeInForce::Ioc);
+
+    rb.reset(false);
+    BOOST_TEST(rb.parse(R"({"tif":"fok"})"sv));
+    BOOST_TEST(rb.fields() == RestBody::Tif);
+    BOOST_TEST(rb.tif() == TimeInForce::Fok);
+
+    rb.reset(false);
+    BOOST_TEST(rb.parse(R"({"tif":"GTC"})"sv));
+    BOOST_TEST(rb.fields() == RestBody::Tif);
+    BOOST_TEST(rb.tif() == TimeInForce::Gtc);
+
+    rb.reset(false);
+    BOOST_TEST(rb.parse(R"({"lots":1})"sv));
+    BOOST_TEST(rb.tif() == TimeInForce::Gtc);
+
+    rb.reset(false);
+    BOOST_CHECK_THROW(rb.parse(R"({"tif":"DAY"})"sv), BadRequestException);
+}
+
 BOOST_AUTO_TEST_CASE(RestBodyMultiCase)
 {
     RestBody rb;
@@ -262,8 +288,8 @@ BOOST_AUTO_TEST_CASE(RestBodyAllCase)
     RestBody rb;
 
     BOOST_TEST(rb.parse(
-        R"({"accnt":"MARAYL","symbol":"EURUSD","instr":"EURUSD","settl_date":20140315,"ref":"EURUSD","state":3,"side":"Buy","lots":101,"ticks":12345,"min_lots":101,"liq_ind":"Maker","cpty":"MARAYL"})"sv));
-    BOOST_TEST(rb.fields() == ((RestBody::Cpty - 1) | RestBody::Cpty));
+        R"({"accnt":"MARAYL","symbol":"EURUSD","instr":"EURUSD","settl_date":20140315,"ref":"EURUSD","state":3,"side":"Buy","lots":101,"ticks":12345,"min_lots":101,"liq_ind":"Maker","cpty":"MARAYL","tif":"IOC"})"sv));
+    BOOST_TEST(rb.fields() == ((RestBody::Tif - 1) | RestBody::Tif));
     BOOST_TEST(rb.symbol() == "EURUSD"sv);
     BOOST_TEST(rb.accnt() == "MARAYL"sv);
     BOOST_TEST(rb.instr() == "EURUSD"sv);
@@ -276,6 +302,7 @@ BOOST_AUTO_TEST_CASE(RestBodyAllCase)
     BOOST_TEST(rb.min_lots() == 101_lts);
     BOOST_TEST(rb.liq_ind() == LiqInd::Maker);
     BOOST_TEST(rb.cpty() == "MARAYL"sv);
+    BOOST_TEST(rb.tif() == TimeInForce::Ioc);
 }
 
 BOOST_AUTO_TEST_CASE(RestBodyPartialCase)
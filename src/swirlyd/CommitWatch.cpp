@@ -0,0 +1,84 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "CommitWatch.hpp"
+
+#include <swirly/fin/MsgQueue.hpp>
+
+namespace swirly {
+using namespace std;
+
+CommitWatch::CommitWatch(Reactor& r, const MsgQueue& mq)
+: mq_(mq)
+, efd_{0, EFD_NONBLOCK}
+, committed_{mq.wpos()}
+{
+    sub_ = r.subscribe(efd_.fd(), EventIn, bind<&CommitWatch::on_io_event>(this));
+}
+
+CommitWatch::~CommitWatch()
+{
+    // Held sessions are owned by the server.
+    list_.clear();
+}
+
+int64_t CommitWatch::wpos() const noexcept
+{
+    return mq_.wpos();
+}
+
+void CommitWatch::hold(HttpSess& sess)
+{
+    if (sess.commit_hook.is_linked()) {
+        sess.commit_hook.unlink();
+    }
+    list_.push_back(sess);
+    // The store is sequentially consistent with the load in notify(), so either the journal thread
+    // sees the flag and wakes the reactor, or this thread sees the new position below.
+    __atomic_store_n(&waiting_, true, __ATOMIC_SEQ_CST);
+    release();
+}
+
+void CommitWatch::notify(int64_t pos)
+{
+    __atomic_store_n(&committed_, pos, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&waiting_, __ATOMIC_SEQ_CST)) {
+        // Best effort.
+        error_code ec;
+        efd_.write(1, ec);
+    }
+}
+
+void CommitWatch::release() noexcept
+{
+    const auto pos = __atomic_load_n(&committed_, __ATOMIC_SEQ_CST);
+    while (!list_.empty() && list_.front().held_pos() <= pos) {
+        auto& sess = list_.front();
+        list_.pop_front();
+        sess.release();
+    }
+    if (list_.empty()) {
+        __atomic_store_n(&waiting_, false, __ATOMIC_SEQ_CST);
+    }
+}
+
+void CommitWatch::on_io_event(int fd, unsigned events, Time now)
+{
+    efd_.read();
+    release();
+}
+
+} // namespace swirly
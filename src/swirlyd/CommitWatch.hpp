@@ -0,0 +1,93 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLYD_COMMITWATCH_HPP
+#define SWIRLYD_COMMITWATCH_HPP
+
+#include "HttpSess.hpp"
+
+#include <swirly/sys/Event.hpp>
+#include <swirly/sys/Memory.hpp>
+#include <swirly/sys/Reactor.hpp>
+
+#include <boost/intrusive/list.hpp>
+
+namespace swirly {
+inline namespace fin {
+class MsgQueue;
+} // namespace fin
+
+/**
+ * Holds responses until the journal has committed the messages posted by their requests, so that
+ * durable acknowledgements never block the matching thread. The journal thread publishes each new
+ * committed position, and wakes the reactor through an eventfd only while a session is waiting.
+ */
+class CommitWatch {
+    using ConstantTimeSizeOption = boost::intrusive::constant_time_size<false>;
+    using MemberHookOption
+        = boost::intrusive::member_hook<HttpSess, decltype(HttpSess::commit_hook),
+                                        &HttpSess::commit_hook>;
+    using List = boost::intrusive::list<HttpSess, ConstantTimeSizeOption, MemberHookOption>;
+
+  public:
+    CommitWatch(Reactor& r, const MsgQueue& mq);
+    ~CommitWatch();
+
+    // Copy.
+    CommitWatch(const CommitWatch&) = delete;
+    CommitWatch& operator=(const CommitWatch&) = delete;
+
+    // Move.
+    CommitWatch(CommitWatch&&) = delete;
+    CommitWatch& operator=(CommitWatch&&) = delete;
+
+    /**
+     * Returns the queue position following the last message that was posted.
+     */
+    std::int64_t wpos() const noexcept;
+    /**
+     * Returns the queue position up to which messages have been committed to the journal.
+     */
+    std::int64_t committed() const noexcept
+    {
+        return __atomic_load_n(&committed_, __ATOMIC_ACQUIRE);
+    }
+    /**
+     * Hold the session until its held position has been committed. A session that is already held
+     * is moved to the back of the queue, which keeps the queue in position order, because positions
+     * increase monotonically.
+     */
+    void hold(HttpSess& sess);
+    /**
+     * Publish the committed position. This function is called from the journal thread.
+     */
+    void notify(std::int64_t pos);
+
+  private:
+    void release() noexcept;
+    void on_io_event(int fd, unsigned events, Time now);
+
+    const MsgQueue& mq_;
+    EventFd efd_;
+    Reactor::Handle sub_;
+    List list_;
+    alignas(CacheLineSize) std::int64_t committed_{0};
+    bool waiting_{false};
+};
+
+} // namespace swirly
+
+#endif // SWIRLYD_COMMITWATCH_HPP
@@ -0,0 +1,82 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "EodTimer.hpp"
+
+#include <swirly/web/RestApp.hpp>
+
+#include <swirly/util/Log.hpp>
+
+namespace swirly {
+using namespace std;
+namespace {
+// Check for a new business-day once per second.
+constexpr auto IdleInterval = 1s;
+// Yield to the reactor between slices.
+constexpr auto SliceInterval = 1ms;
+// Orders expired or sessions settled per slice.
+constexpr size_t SliceSize{256};
+} // namespace
+
+EodTimer::EodTimer(Reactor& r, RestApp& app, Time now)
+: app_(app)
+{
+    tmr_ = r.timer(now, IdleInterval, Priority::Low, bind<&EodTimer::on_timer>(this));
+}
+
+EodTimer::~EodTimer() = default;
+
+void EodTimer::on_timer(Timer& tmr, Time now)
+{
+    const auto bus_day = bus_day_(now);
+    if (bus_day == done_day_) {
+        return;
+    }
+    if (slices_ == 0) {
+        SWIRLY_NOTICE << "starting end of day for " << jd_to_iso(bus_day);
+        start_ = now;
+        max_pause_ = {};
+    }
+    ++slices_;
+
+    // Any slice that throws is retried on the next tick.
+    const auto start = chrono::steady_clock::now();
+    bool done;
+    if (!expired_) {
+        expired_ = app_.expire_end_of_day(now, SliceSize);
+        done = false;
+    } else {
+        done = app_.settl_end_of_day(now, SliceSize);
+    }
+    const auto pause = chrono::steady_clock::now() - start;
+    max_pause_ = max(max_pause_, chrono::duration_cast<Duration>(pause));
+
+    if (done) {
+        SWIRLY_NOTICE << "completed end of day for " << jd_to_iso(bus_day) << " in " << slices_
+                      << " slices: elapsed="
+                      << chrono::duration_cast<Millis>(now - start_).count()
+                      << "ms, max_pause=" << chrono::duration_cast<Micros>(max_pause_).count()
+                      << "us";
+        done_day_ = bus_day;
+        expired_ = false;
+        slices_ = 0;
+        tmr.set_interval(IdleInterval);
+    } else {
+        tmr.set_interval(SliceInterval);
+    }
+}
+
+} // namespace swirly
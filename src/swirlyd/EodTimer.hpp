@@ -0,0 +1,64 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLYD_EODTIMER_HPP
+#define SWIRLYD_EODTIMER_HPP
+
+#include <swirly/fin/Date.hpp>
+
+#include <swirly/sys/Reactor.hpp>
+
+namespace swirly {
+inline namespace web {
+class RestApp;
+} // namespace web
+
+/**
+ * Drives end-of-day expiry and settlement from a low-priority timer. The reactor only dispatches
+ * low-priority timers during otherwise idle cycles, and each slice of work is bounded, so order
+ * flow is never paused for longer than a single slice.
+ */
+class EodTimer {
+  public:
+    EodTimer(Reactor& r, RestApp& app, Time now);
+    ~EodTimer();
+
+    // Copy.
+    EodTimer(const EodTimer&) = delete;
+    EodTimer& operator=(const EodTimer&) = delete;
+
+    // Move.
+    EodTimer(EodTimer&&) = delete;
+    EodTimer& operator=(EodTimer&&) = delete;
+
+  private:
+    void on_timer(Timer& tmr, Time now);
+
+    RestApp& app_;
+    const BusinessDay bus_day_{MarketZone};
+    Timer tmr_;
+    // The business-day for which end-of-day processing last completed.
+    JDay done_day_{0_jd};
+    bool expired_{false};
+    // Statistics for the job in progress.
+    Time start_{};
+    Duration max_pause_{};
+    int slices_{0};
+};
+
+} // namespace swirly
+
+#endif // SWIRLYD_EODTIMER_HPP
@@ -0,0 +1,122 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "ExecLoader.hpp"
+
+#include <swirly/web/RestApp.hpp>
+
+#include <swirly/app/MemCtx.hpp>
+
+#include <swirly/util/Log.hpp>
+
+namespace swirly {
+using namespace std;
+
+ExecLoader::ExecLoader(Reactor& r, RestApp& app)
+: app_(app)
+, efd_{0, EFD_NONBLOCK}
+{
+    sub_ = r.subscribe(efd_.fd(), EventIn, bind<&ExecLoader::on_io_event>(this));
+}
+
+ExecLoader::~ExecLoader()
+{
+    // Held sessions are owned by the server.
+    list_.clear();
+}
+
+void ExecLoader::hold(HttpSess& sess)
+{
+    const auto accnt = sess.deferred_accnt();
+    list_.push_back(sess);
+    if (pending_.count(accnt) > 0) {
+        return;
+    }
+    pending_.insert(accnt);
+    {
+        lock_guard<mutex> lock{mutex_};
+        requests_.push_back(accnt);
+    }
+    event_.notify();
+}
+
+int ExecLoader::operator()()
+{
+    Result result;
+    {
+        lock_guard<mutex> lock{mutex_};
+        if (requests_.empty()) {
+            return 0;
+        }
+        result.accnt = requests_.front();
+        requests_.pop_front();
+    }
+    try {
+        // Execs are allocated from the heap, so that the matching thread's pool is never locked.
+        MemCtx::HeapScope scope;
+        app_.app().read_exec_history(result.accnt, result.execs);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    {
+        lock_guard<mutex> lock{mutex_};
+        results_.push_back(std::move(result));
+    }
+    // Best effort.
+    error_code ec;
+    efd_.write(1, ec);
+    return 1;
+}
+
+void ExecLoader::on_io_event(int fd, unsigned events, Time now)
+{
+    efd_.read();
+    vector<Result> results;
+    {
+        lock_guard<mutex> lock{mutex_};
+        results.swap(results_);
+    }
+    set<Symbol> failed;
+    for (auto& result : results) {
+        if (result.error.empty()) {
+            app_.set_exec_history(result.accnt, result.execs);
+        } else {
+            SWIRLY_ERROR << "failed to read exec history for '" << result.accnt
+                         << "': " << result.error;
+            failed.insert(result.accnt);
+        }
+        pending_.erase(result.accnt);
+    }
+    // The ready sessions are split from the list before they are resumed, because a resumed session
+    // may defer a later request, and be held again.
+    List ready;
+    for (auto it = list_.begin(); it != list_.end();) {
+        auto& sess = *it;
+        if (pending_.count(sess.deferred_accnt()) == 0) {
+            it = list_.erase(it);
+            ready.push_back(sess);
+        } else {
+            ++it;
+        }
+    }
+    while (!ready.empty()) {
+        auto& sess = ready.front();
+        ready.pop_front();
+        sess.resume(failed.count(sess.deferred_accnt()) == 0);
+    }
+}
+
+} // namespace swirly
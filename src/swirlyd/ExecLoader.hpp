@@ -0,0 +1,108 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLYD_EXECLOADER_HPP
+#define SWIRLYD_EXECLOADER_HPP
+
+#include "HttpSess.hpp"
+
+#include <swirly/fin/Types.hpp>
+
+#include <swirly/app/EventCount.hpp>
+
+#include <swirly/sys/Event.hpp>
+#include <swirly/sys/Reactor.hpp>
+
+#include <swirly/util/Symbol.hpp>
+
+#include <boost/intrusive/list.hpp>
+
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace swirly {
+inline namespace web {
+class RestApp;
+} // namespace web
+
+/**
+ * Reads each session's exec history from the model on its own thread, so that the first request
+ * for a session's execs never blocks the matching thread. The request is deferred until the history
+ * has been read. The history is then posted back to the reactor through an eventfd, and the
+ * deferred requests are handled again.
+ */
+class ExecLoader {
+    using ConstantTimeSizeOption = boost::intrusive::constant_time_size<false>;
+    using MemberHookOption
+        = boost::intrusive::member_hook<HttpSess, decltype(HttpSess::exec_hook),
+                                        &HttpSess::exec_hook>;
+    using List = boost::intrusive::list<HttpSess, ConstantTimeSizeOption, MemberHookOption>;
+
+  public:
+    ExecLoader(Reactor& r, RestApp& app);
+    ~ExecLoader();
+
+    // Copy.
+    ExecLoader(const ExecLoader&) = delete;
+    ExecLoader& operator=(const ExecLoader&) = delete;
+
+    // Move.
+    ExecLoader(ExecLoader&&) = delete;
+    ExecLoader& operator=(ExecLoader&&) = delete;
+
+    /**
+     * Event notified when a read is requested.
+     */
+    EventCount& event() noexcept { return event_; }
+    /**
+     * Hold the session until the exec history for its deferred account has been loaded. The read
+     * is requested unless it is already pending. This function is called from the reactor thread.
+     */
+    void hold(HttpSess& sess);
+    /**
+     * Read the exec history for the next pending account, if any. Returns the number of accounts
+     * read.
+     */
+    int operator()();
+
+  private:
+    struct Result {
+        Symbol accnt;
+        std::vector<ConstExecPtr> execs;
+        // Empty unless the read failed.
+        std::string error;
+    };
+
+    void on_io_event(int fd, unsigned events, Time now);
+
+    RestApp& app_;
+    EventFd efd_;
+    Reactor::Handle sub_;
+    EventCount event_;
+    List list_;
+    // Accounts whose history has been requested, but not yet loaded.
+    std::set<Symbol> pending_;
+    std::mutex mutex_;
+    std::deque<Symbol> requests_;
+    std::vector<Result> results_;
+};
+
+} // namespace swirly
+
+#endif // SWIRLYD_EXECLOADER_HPP
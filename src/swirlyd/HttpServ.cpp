@@ -21,10 +21,12 @@
 namespace swirly {
 using namespace std;
 
-HttpServ::HttpServ(Reactor& r, const Endpoint& ep, RestServ& rs)
+HttpServ::HttpServ(Reactor& r, const Endpoint& ep, RestServ& rs, CommitWatch& cw, ExecLoader& el)
 : TcpAcceptor{r, ep}
 , reactor_(r)
 , rest_serv_(rs)
+, commit_watch_(cw)
+, exec_loader_(el)
 {
 }
 
@@ -35,7 +37,8 @@ HttpServ::~HttpServ()
 
 void HttpServ::do_accept(IoSocket&& sock, const Endpoint& ep, Time now)
 {
-    auto* const sess = new HttpSess{reactor_, move(sock), ep, rest_serv_, now};
+    auto* const sess
+        = new HttpSess{reactor_, move(sock), ep, rest_serv_, commit_watch_, exec_loader_, now};
     list_.push_back(*sess);
 }
 
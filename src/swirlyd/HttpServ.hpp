@@ -23,6 +23,8 @@
 
 namespace swirly {
 
+class CommitWatch;
+class ExecLoader;
 class RestServ;
 
 class SWIRLY_API HttpServ : public TcpAcceptor<HttpServ> {
@@ -32,7 +34,7 @@ class SWIRLY_API HttpServ : public TcpAcceptor<HttpServ> {
     using List = boost::intrusive::list<HttpSess, ConstantTimeSizeOption, MemberHookOption>;
 
   public:
-    HttpServ(Reactor& r, const Endpoint& ep, RestServ& rs);
+    HttpServ(Reactor& r, const Endpoint& ep, RestServ& rs, CommitWatch& cw, ExecLoader& el);
     ~HttpServ();
 
     // Copy.
@@ -48,6 +50,8 @@ class SWIRLY_API HttpServ : public TcpAcceptor<HttpServ> {
   private:
     Reactor& reactor_;
     RestServ& rest_serv_;
+    CommitWatch& commit_watch_;
+    ExecLoader& exec_loader_;
     List list_;
 };
 
@@ -16,8 +16,12 @@
  */
 #include "HttpSess.hpp"
 
+#include "CommitWatch.hpp"
+#include "ExecLoader.hpp"
 #include "RestServ.hpp"
 
+#include <swirly/fin/Exception.hpp>
+
 namespace swirly {
 using namespace std;
 
@@ -28,12 +32,15 @@ enum { MaxData = 2048 };
 
 } // namespace
 
-HttpSess::HttpSess(Reactor& r, IoSocket&& sock, const TcpEndpoint& ep, RestServ& rs, Time now)
+HttpSess::HttpSess(Reactor& r, IoSocket&& sock, const TcpEndpoint& ep, RestServ& rs,
+                   CommitWatch& cw, ExecLoader& el, Time now)
 : BasicHttpParser<HttpSess>{HttpType::Request}
 , reactor_(r)
 , sock_{move(sock)}
 , ep_{ep}
 , rest_serv_(rs)
+, commit_watch_(cw)
+, exec_loader_(el)
 {
     SWIRLY_DEBUG << "accept session";
 
@@ -43,6 +50,46 @@ HttpSess::HttpSess(Reactor& r, IoSocket&& sock, const TcpEndpoint& ep, RestServ&
 
 HttpSess::~HttpSess() = default;
 
+void HttpSess::release() noexcept
+{
+    held_ = false;
+    try {
+        if (!buf_.empty()) {
+            // May throw.
+            update_events();
+        }
+    } catch (const std::exception& e) {
+        SWIRLY_ERROR << "error releasing session: " << e.what();
+        close();
+    }
+}
+
+void HttpSess::resume(bool loaded) noexcept
+{
+    try {
+        deferred_accnt_.clear();
+        if (loaded) {
+            // May throw.
+            handle_request(false);
+        } else {
+            rest_serv_.handle_error(ServiceUnavailableException{"exec history is unavailable"sv},
+                                    os_);
+        }
+        req_.clear();
+        if (!in_.empty()) {
+            const auto in = std::move(in_);
+            in_.clear();
+            // May throw.
+            parse_input(in.data(), in.size());
+        }
+        // May throw.
+        update_events();
+    } catch (const std::exception& e) {
+        SWIRLY_ERROR << "error resuming session: " << e.what();
+        close();
+    }
+}
+
 void HttpSess::close() noexcept
 {
     SWIRLY_DEBUG << "close session";
@@ -51,6 +98,53 @@ void HttpSess::close() noexcept
     delete this;
 }
 
+void HttpSess::update_events()
+{
+    unsigned events{0};
+    if (deferred_accnt_.empty()) {
+        events |= EventIn;
+    }
+    if (!held_ && !buf_.empty()) {
+        events |= EventOut;
+    }
+    sub_.set_events(events);
+}
+
+void HttpSess::parse_input(const char* data, size_t size)
+{
+    const auto n = parse({data, size});
+    if (!deferred_accnt_.empty()) {
+        // Parsing was paused after the deferred request.
+        in_.assign(data + n, size - n);
+    }
+}
+
+bool HttpSess::handle_request(bool defer)
+{
+    const auto was_empty = buf_.empty();
+    const auto wpos = commit_watch_.wpos();
+    if (!rest_serv_.handle_request(req_, os_, defer)) {
+        deferred_accnt_ = rest_serv_.deferred_accnt();
+        // May throw.
+        update_events();
+        exec_loader_.hold(*this);
+        return false;
+    }
+    if (req_.durable() && commit_watch_.wpos() != wpos) {
+        // Hold this and any earlier responses until the messages posted by the request have been
+        // committed. Requests that posted nothing are answered as soon as possible.
+        held_ = true;
+        held_pos_ = commit_watch_.wpos();
+        // May throw.
+        update_events();
+        commit_watch_.hold(*this);
+    } else if (was_empty && !held_) {
+        // May throw.
+        update_events();
+    }
+    return true;
+}
+
 bool HttpSess::on_url(string_view sv) noexcept
 {
     bool ret{false};
@@ -112,12 +206,11 @@ bool HttpSess::on_message_end() noexcept
         --pending_;
         req_.flush(); // May throw.
 
-        const auto was_empty = buf_.empty();
-        rest_serv_.handle_request(req_, os_);
-
-        if (was_empty) {
-            // May throw.
-            sub_.set_events(EventIn | EventOut);
+        // Exec history that has yet to be loaded is read off the matching thread.
+        if (!handle_request(true)) {
+            // The request is kept, and handled again once the history has been loaded.
+            pause();
+            return true;
         }
         ret = true;
     } catch (const std::exception& e) {
@@ -133,9 +226,9 @@ void HttpSess::on_io_event(int fd, unsigned events, Time now)
         if (events & EventOut) {
             buf_.consume(os::write(fd, buf_.data()));
             if (buf_.empty()) {
-                if (should_keep_alive()) {
+                if (!deferred_accnt_.empty() || should_keep_alive()) {
                     // May throw.
-                    sub_.set_events(EventIn);
+                    update_events();
                 } else {
                     close();
                 }
@@ -145,7 +238,7 @@ void HttpSess::on_io_event(int fd, unsigned events, Time now)
             char in[MaxData];
             const auto size = os::read(fd, in, sizeof(in));
             if (size > 0) {
-                parse({in, size});
+                parse_input(in, size);
                 tmr_.cancel();
                 tmr_ = reactor_.timer(now + IdleTimeout, Priority::Low,
                                       bind<&HttpSess::on_timer>(this));
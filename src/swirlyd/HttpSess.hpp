@@ -26,11 +26,16 @@
 #include <swirly/sys/TcpAcceptor.hpp>
 
 #include <swirly/util/Log.hpp>
+#include <swirly/util/Symbol.hpp>
 
 #include <boost/intrusive/list.hpp>
 
+#include <string>
+
 namespace swirly {
 
+class CommitWatch;
+class ExecLoader;
 class RestServ;
 
 class SWIRLY_API HttpSess
@@ -40,7 +45,8 @@ class SWIRLY_API HttpSess
     using AutoUnlinkOption = boost::intrusive::link_mode<boost::intrusive::auto_unlink>;
 
   public:
-    HttpSess(Reactor& r, IoSocket&& sock, const TcpEndpoint& ep, RestServ& rs, Time now);
+    HttpSess(Reactor& r, IoSocket&& sock, const TcpEndpoint& ep, RestServ& rs, CommitWatch& cw,
+             ExecLoader& el, Time now);
     ~HttpSess();
 
     // Copy.
@@ -51,10 +57,42 @@ class SWIRLY_API HttpSess
     HttpSess(HttpSess&&) = delete;
     HttpSess& operator=(HttpSess&&) = delete;
 
+    /**
+     * Returns the queue position that must be committed before the held responses are sent.
+     */
+    std::int64_t held_pos() const noexcept { return held_pos_; }
+    /**
+     * Send the held responses, once their messages have been committed.
+     */
+    void release() noexcept;
+    /**
+     * Returns the account whose exec history must be loaded before the deferred request can be
+     * handled, or an empty symbol if no request is deferred.
+     */
+    Symbol deferred_accnt() const noexcept { return deferred_accnt_; }
+    /**
+     * Handle the deferred request, once the exec history for its account has been loaded, and then
+     * resume parsing. An error is sent in response to the request if the history could not be
+     * loaded.
+     */
+    void resume(bool loaded) noexcept;
+
     boost::intrusive::list_member_hook<AutoUnlinkOption> list_hook;
+    boost::intrusive::list_member_hook<AutoUnlinkOption> commit_hook;
+    boost::intrusive::list_member_hook<AutoUnlinkOption> exec_hook;
 
   private:
     void close() noexcept;
+    /**
+     * Set the events that the session is interested in. Input is not read while a request is
+     * deferred, and output is not written while responses are held.
+     */
+    void update_events();
+    void parse_input(const char* data, std::size_t size);
+    /**
+     * Returns false if the request was deferred.
+     */
+    bool handle_request(bool defer);
 
     bool on_message_begin() noexcept
     {
@@ -89,9 +127,18 @@ class SWIRLY_API HttpSess
     IoSocket sock_;
     TcpEndpoint ep_;
     RestServ& rest_serv_;
+    CommitWatch& commit_watch_;
+    ExecLoader& exec_loader_;
     Reactor::Handle sub_;
     Timer tmr_;
     int pending_{0};
+    // Responses are held while the journal commits the messages posted by a durable request.
+    bool held_{false};
+    std::int64_t held_pos_{0};
+    // Parsing is paused while a request is deferred, so that responses are sent in order. The input
+    // that follows the request is kept until it has been handled.
+    Symbol deferred_accnt_;
+    std::string in_;
     HttpRequest req_;
     Buffer buf_;
     HttpStream os_{buf_};
@@ -14,14 +14,23 @@
  * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
  * 02110-1301, USA.
  */
+#include "CommitWatch.hpp"
+#include "EodTimer.hpp"
+#include "ExecLoader.hpp"
 #include "HttpServ.hpp"
 #include "RestServ.hpp"
+#include "SnapAgent.hpp"
+#include "SnapTimer.hpp"
 
 #include <swirly/db/DbCtx.hpp>
+#include <swirly/db/FbsModel.hpp>
+#include <swirly/db/FbsSnapshot.hpp>
 
 #include <swirly/web/RestApp.hpp>
 
+#include <swirly/fin/Exception.hpp>
 #include <swirly/fin/Journ.hpp>
+#include <swirly/fin/JournAgent.hpp>
 #include <swirly/fin/Model.hpp>
 #include <swirly/fin/MsgQueue.hpp>
 
@@ -45,6 +54,8 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <optional>
+#include <thread>
 
 #include <fcntl.h> // open()
 #include <syslog.h>
@@ -249,8 +260,22 @@ int main(int argc, char* argv[])
         }
 
         const fs::path mq_file{config.get("mq_file", "")};
+        const auto mq_capacity = config.get<size_t>("mq_capacity", 1 << 14);
+        const auto mq_readers = config.get<size_t>("mq_readers", 1);
+        if (mq_readers < 1 || mq_readers > MemRing<MsgChunk>::MaxReaders) {
+            throw Exception{make_error_code(errc::invalid_argument),
+                            err_msg() << "invalid mq_readers: " << mq_readers};
+        }
         const char* const http_port{config.get("http_port", "8080")};
+        const auto load_threads
+            = config.get<size_t>("load_threads", max(thread::hardware_concurrency(), 1U));
         const auto max_execs = config.get<size_t>("max_execs", 1 << 4);
+        const auto journ_max_msgs = config.get<size_t>("journ_max_msgs", 1 << 10);
+        const Micros journ_max_wait{config.get<int64_t>("journ_max_wait", 1000)};
+        const fs::path snap_file{config.get("snap_file", "")};
+        const Seconds snap_interval{config.get<int64_t>("snap_interval", 60)};
+        // Snapshots record exec history from memory, so history is only loaded lazily without them.
+        const auto lazy_execs = config.get("lazy_execs", true) && snap_file.empty();
 
         SWIRLY_NOTICE << "initialising daemon";
         SWIRLY_INFO << "conf_file:  " << opts.conf_file;
@@ -260,68 +285,158 @@ int main(int argc, char* argv[])
         SWIRLY_INFO << "file_mode:  " << setfill('0') << setw(3) << oct << swirly::file_mode();
         SWIRLY_INFO << "http_port:  " << http_port;
         SWIRLY_INFO << "log_file:   " << log_file;
+        SWIRLY_INFO << "journ_max_msgs: " << journ_max_msgs;
+        SWIRLY_INFO << "journ_max_wait: " << journ_max_wait.count() << "us";
         SWIRLY_INFO << "log_level:  " << get_log_level();
+        SWIRLY_INFO << "load_threads: " << load_threads;
         SWIRLY_INFO << "max_execs:  " << max_execs;
+        SWIRLY_INFO << "lazy_execs: " << (lazy_execs ? "yes" : "no");
         SWIRLY_INFO << "mem_size:   " << (mem_ctx.max_size() >> 20) << "MiB";
+        SWIRLY_INFO << "mq_capacity: " << mq_capacity;
         SWIRLY_INFO << "mq_file:    " << mq_file;
+        SWIRLY_INFO << "mq_readers: " << mq_readers;
         SWIRLY_INFO << "pid_file:   " << pid_file;
         SWIRLY_INFO << "run_dir:    " << run_dir;
+        SWIRLY_INFO << "snap_file:  " << snap_file;
+        SWIRLY_INFO << "snap_interval: " << snap_interval.count() << "s";
 
         DbCtx db_ctx{config};
+        Journ& journ = db_ctx.journ();
         MsgQueue mq;
+        size_t pending{0};
         if (!mq_file.empty()) {
+            if (open_mem_ring<MsgChunk>(mq_file.c_str(), mq_capacity, mq_readers, 0644)) {
+                SWIRLY_NOTICE << "created message queue: " << mq_file;
+            }
             mq = MsgQueue{mq_file.c_str()};
+            if (mq.readers() != mq_readers) {
+                // The number of readers is fixed when the file is created.
+                SWIRLY_WARNING << "message queue has " << mq.readers() << " readers, not "
+                               << mq_readers;
+            }
+            // Messages that were posted before a crash, but never committed, are journalled before
+            // the model is loaded.
+            pending = mq.recover();
+            if (pending > 0) {
+                SWIRLY_NOTICE << "recovering " << pending << " messages from message queue";
+                JournAgent journ_agent{mq, journ, journ_max_msgs, journ_max_wait};
+                // The journal may already hold the last group committed before the crash.
+                journ_agent.skip_journalled();
+                while (journ_agent() > 0) {
+                }
+            }
         } else {
-            mq = MsgQueue{1 << 10};
+            mq = MsgQueue{mq_capacity};
         }
         RestApp rest_app{mq, max_execs};
         {
-            Model& model = db_ctx.model();
-            rest_app.load(model, opts.start_time);
+            const Model* model{&db_ctx.model()};
+            unique_ptr<FbsModel> snap_model;
+            unique_ptr<Model> replay_model;
+            if (!snap_file.empty() && fs::exists(snap_file)) {
+                try {
+                    snap_model = make_unique<FbsModel>(snap_file.c_str());
+                } catch (const DatabaseException& e) {
+                    SWIRLY_WARNING << "ignoring snapshot: " << e.what();
+                }
+            }
+            if (snap_model) {
+                replay_model = db_ctx.replay_model(*snap_model);
+                if (replay_model) {
+                    SWIRLY_NOTICE << "loading snapshot and replaying journal: " << snap_file;
+                    model = replay_model.get();
+                } else if (snap_model->clean() && pending == 0) {
+                    // Without replay, a snapshot only matches the journal if it was taken on clean
+                    // shutdown, and no messages have since been recovered.
+                    SWIRLY_NOTICE << "loading snapshot: " << snap_file;
+                    model = snap_model.get();
+                }
+            }
+            const auto start = chrono::steady_clock::now();
+            // The model may be read on several threads, so allocations are serialised until the
+            // load is complete.
+            mem_ctx.set_concurrent(load_threads > 1);
+            // The database model outlives the application, which may read exec history from it.
+            rest_app.load(*model, opts.start_time, load_threads, lazy_execs);
+            mem_ctx.set_concurrent(false);
+            const auto elapsed = chrono::steady_clock::now() - start;
+            SWIRLY_NOTICE << "loaded model in " << chrono::duration_cast<Millis>(elapsed).count()
+                          << "ms";
+            // A snapshot that cannot be replayed is stale as soon as the first request is
+            // processed, so it is removed to prevent it from being loaded after a crash.
+            if (!replay_model && !snap_file.empty()) {
+                fs::remove(snap_file);
+            }
         }
         RestServ rest_serv{rest_app};
-        Journ& journ = db_ctx.journ();
 
         EpollReactor reactor{1024};
         const TcpEndpoint ep{Tcp::v4(), stou16(http_port)};
-        HttpServ http_serv{reactor, ep, rest_serv};
-
-        ReactorThread reactor_thread{reactor, ThreadConfig{"reactor"s}};
-        auto journ_agent = [&mq, &journ]() {
-            int n{0};
-            Msg msg;
-            while (mq.pop(msg)) {
-                journ.write(msg);
-                ++n;
+        CommitWatch commit_watch{reactor, mq};
+        ExecLoader exec_loader{reactor, rest_app};
+        HttpServ http_serv{reactor, ep, rest_serv, commit_watch, exec_loader};
+        EodTimer eod_timer{reactor, rest_app, opts.start_time};
+
+        SnapAgent snap_agent{snap_file.string()};
+        optional<SnapTimer> snap_timer;
+        if (!snap_file.empty() && snap_interval > 0s) {
+            snap_timer.emplace(reactor, rest_app.app(), snap_agent, snap_interval,
+                               opts.start_time);
+        }
+        {
+            ReactorThread reactor_thread{reactor, ThreadConfig{"reactor"s}};
+            JournAgent journ_agent{mq, journ, journ_max_msgs, journ_max_wait,
+                                   bind<&CommitWatch::notify>(&commit_watch)};
+            AgentThread journ_thread{journ_agent,
+                                     ThreadConfig{"journ"s, WaitStrategy::Park, &mq.event()}};
+            // Exec history is only read on demand if the model was loaded lazily.
+            optional<AgentThread> exec_thread;
+            if (lazy_execs) {
+                exec_thread.emplace(exec_loader, ThreadConfig{"exec"s, WaitStrategy::Park,
+                                                              &exec_loader.event()});
             }
-            return n;
-        };
-        AgentThread journ_thread{journ_agent, PhasedBackoff{}, ThreadConfig{"journ"s}};
-
-        SWIRLY_NOTICE << "started http server on port " << http_port;
-
-        // Wait for termination.
-        SigWait sig_wait;
-        while (const auto sig = sig_wait()) {
-            switch (sig) {
-            case SIGHUP:
-                SWIRLY_INFO << "received SIGHUP";
-                if (!log_file.empty()) {
-                    SWIRLY_NOTICE << "reopening log file: " << log_file;
-                    open_log_file(log_file.c_str());
+            optional<AgentThread> snap_thread;
+            if (snap_timer) {
+                snap_thread.emplace(snap_agent,
+                                    ThreadConfig{"snap"s, WaitStrategy::Park, &snap_agent.event()});
+            }
+
+            SWIRLY_NOTICE << "started http server on port " << http_port;
+
+            // Wait for termination.
+            SigWait sig_wait;
+            while (const auto sig = sig_wait()) {
+                switch (sig) {
+                case SIGHUP:
+                    SWIRLY_INFO << "received SIGHUP";
+                    if (!log_file.empty()) {
+                        SWIRLY_NOTICE << "reopening log file: " << log_file;
+                        open_log_file(log_file.c_str());
+                    }
+                    continue;
+                case SIGINT:
+                    SWIRLY_INFO << "received SIGINT";
+                    break;
+                case SIGTERM:
+                    SWIRLY_INFO << "received SIGTERM";
+                    break;
+                default:
+                    SWIRLY_INFO << "received signal: " << sig;
+                    continue;
                 }
-                continue;
-            case SIGINT:
-                SWIRLY_INFO << "received SIGINT";
-                break;
-            case SIGTERM:
-                SWIRLY_INFO << "received SIGTERM";
                 break;
-            default:
-                SWIRLY_INFO << "received signal: " << sig;
-                continue;
             }
-            break;
+        }
+        // The threads have stopped, so any messages that remain in the queue are journalled, and
+        // the final snapshot is then consistent with the journal.
+        {
+            JournAgent journ_agent{mq, journ, journ_max_msgs, journ_max_wait};
+            while (journ_agent() > 0) {
+            }
+        }
+        if (!snap_file.empty()) {
+            SWIRLY_NOTICE << "writing snapshot: " << snap_file;
+            make_snapshot(rest_app.app(), UnixClock::now(), true).write(snap_file.c_str());
         }
         ret = 0;
     } catch (const exception& e) {
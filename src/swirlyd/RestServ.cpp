@@ -88,12 +88,24 @@ string_view get_trader(const HttpRequest& req)
     return accnt;
 }
 
+void write_error(const Exception& e, HttpStream& os) noexcept
+{
+    const auto status = http_status(e.code());
+    const char* const reason = http_reason(status);
+    SWIRLY_ERROR << "exception: status=" << status << ", reason=" << reason
+                 << ", detail=" << e.what();
+    os.reset(status, reason);
+    Exception::to_json(os, static_cast<int>(status), reason, e.what());
+}
+
 } // namespace
 
 RestServ::~RestServ() = default;
 
-void RestServ::handle_request(const HttpRequest& req, HttpStream& os) noexcept
+bool RestServ::handle_request(const HttpRequest& req, HttpStream& os, bool defer) noexcept
 {
+    defer_ = defer;
+    deferred_accnt_.clear();
     const auto cache = reset(req);  // noexcept
     const auto now = get_time(req); // noexcept
 
@@ -108,6 +120,10 @@ void RestServ::handle_request(const HttpRequest& req, HttpStream& os) noexcept
             throw BadRequestException{"request body is incomplete"sv};
         }
         rest_request(req, now, os);
+        if (!deferred_accnt_.empty()) {
+            // The response is discarded by the next reset.
+            return false;
+        }
         if (!match_path_) {
             throw NotFoundException{err_msg() << "resource '" << req.path() << "' does not exist"};
         }
@@ -116,12 +132,7 @@ void RestServ::handle_request(const HttpRequest& req, HttpStream& os) noexcept
                                             << "method '" << req.method() << "' is not allowed"};
         }
     } catch (const Exception& e) {
-        const auto status = http_status(e.code());
-        const char* const reason = http_reason(status);
-        SWIRLY_ERROR << "exception: status=" << status << ", reason=" << reason
-                     << ", detail=" << e.what();
-        os.reset(status, reason);
-        Exception::to_json(os, static_cast<int>(status), reason, e.what());
+        write_error(e, os);
     } catch (const exception& e) {
         const auto status = HttpStatus::InternalServerError;
         const char* const reason = http_reason(status);
@@ -131,6 +142,13 @@ void RestServ::handle_request(const HttpRequest& req, HttpStream& os) noexcept
         Exception::to_json(os, static_cast<int>(status), reason, e.what());
     }
     os.commit(); // noexcept
+    return true;
+}
+
+void RestServ::handle_error(const Exception& e, HttpStream& os) noexcept
+{
+    write_error(e, os);
+    os.commit(); // noexcept
 }
 
 bool RestServ::reset(const HttpRequest& req) noexcept
@@ -153,6 +171,15 @@ bool RestServ::reset(const HttpRequest& req) noexcept
     return !path.empty() && path_.top() == "refdata"sv;
 }
 
+bool RestServ::defer_execs(Symbol accnt)
+{
+    if (defer_ && !app_.app().execs_loaded(accnt)) {
+        deferred_accnt_ = accnt;
+        return true;
+    }
+    return false;
+}
+
 void RestServ::rest_request(const HttpRequest& req, Time now, HttpStream& os)
 {
     if (path_.empty()) {
@@ -307,7 +334,10 @@ void RestServ::sess_request(const HttpRequest& req, Time now, HttpStream& os)
             match_method_ = true;
             const auto es = EntitySet::Market | EntitySet::Order | EntitySet::Exec
                 | EntitySet::Trade | EntitySet::Posn;
-            app_.get_sess(get_trader(req), es, parse_query(req.query()), now, os);
+            const Symbol accnt{get_trader(req)};
+            if (!defer_execs(accnt)) {
+                app_.get_sess(accnt, es, parse_query(req.query()), now, os);
+            }
         }
         return;
     }
@@ -326,7 +356,10 @@ void RestServ::sess_request(const HttpRequest& req, Time now, HttpStream& os)
             if (req.method() == HttpMethod::Get) {
                 // GET /api/sess/entity,entity...
                 match_method_ = true;
-                app_.get_sess(get_trader(req), es, parse_query(req.query()), now, os);
+                const Symbol accnt{get_trader(req)};
+                if (!es.exec() || !defer_execs(accnt)) {
+                    app_.get_sess(accnt, es, parse_query(req.query()), now, os);
+                }
             }
         }
         return;
@@ -484,13 +517,14 @@ void RestServ::order_request(const HttpRequest& req, Time now, HttpStream& os)
                 const auto accnt = get_trader(req);
                 constexpr auto ReqFields = RestBody::Instr | RestBody::SettlDate | RestBody::Side
                     | RestBody::Lots | RestBody::Ticks;
-                constexpr auto OptFields = RestBody::Ref | RestBody::MinLots;
+                constexpr auto OptFields = RestBody::Ref | RestBody::MinLots | RestBody::Tif;
                 if (!req.body().valid(ReqFields, OptFields)) {
                     throw InvalidException{"request fields are invalid"sv};
                 }
                 app_.post_order(accnt, req.body().instr(), req.body().settl_date(),
                                 req.body().ref(), req.body().side(), req.body().lots(),
-                                req.body().ticks(), req.body().min_lots(), now, os);
+                                req.body().ticks(), req.body().min_lots(), req.body().tif(),
+                                now, os);
             }
             break;
         default:
@@ -521,13 +555,13 @@ void RestServ::order_request(const HttpRequest& req, Time now, HttpStream& os)
                 const auto accnt = get_trader(req);
                 constexpr auto ReqFields
                     = RestBody::SettlDate | RestBody::Side | RestBody::Lots | RestBody::Ticks;
-                constexpr auto OptFields = RestBody::Ref | RestBody::MinLots;
+                constexpr auto OptFields = RestBody::Ref | RestBody::MinLots | RestBody::Tif;
                 if (!req.body().valid(ReqFields, OptFields)) {
                     throw InvalidException{"request fields are invalid"sv};
                 }
                 app_.post_order(accnt, instr, req.body().settl_date(), req.body().ref(),
                                 req.body().side(), req.body().lots(), req.body().ticks(),
-                                req.body().min_lots(), now, os);
+                                req.body().min_lots(), req.body().tif(), now, os);
             }
             break;
         default:
@@ -557,13 +591,31 @@ void RestServ::order_request(const HttpRequest& req, Time now, HttpStream& os)
                 // Validate account before request.
                 const auto accnt = get_trader(req);
                 constexpr auto ReqFields = RestBody::Side | RestBody::Lots | RestBody::Ticks;
-                constexpr auto OptFields = RestBody::Ref | RestBody::MinLots;
+                constexpr auto OptFields = RestBody::Ref | RestBody::MinLots | RestBody::Tif;
+                if (req.bulk()) {
+                    // Bulk order entry: an array of orders in a single round trip.
+                    new_orders_.clear();
+                    for (const auto& order : req.orders()) {
+                        const auto fields = order.fields;
+                        if ((fields & ReqFields) != ReqFields
+                            || (fields & ~(ReqFields | OptFields)) != 0) {
+                            throw InvalidException{err_msg() << "fields of order "
+                                                             << new_orders_.size()
+                                                             << " are invalid"};
+                        }
+                        new_orders_.push_back(
+                            {+order.ref, order.side, order.lots, order.ticks, order.min_lots,
+                             order.tif});
+                    }
+                    app_.post_orders(accnt, instr, settl_date, new_orders_, now, os);
+                    break;
+                }
                 if (!req.body().valid(ReqFields, OptFields)) {
                     throw InvalidException{"request fields are invalid"sv};
                 }
                 app_.post_order(accnt, instr, settl_date, req.body().ref(), req.body().side(),
-                                req.body().lots(), req.body().ticks(), req.body().min_lots(), now,
-                                os);
+                                req.body().lots(), req.body().ticks(), req.body().min_lots(),
+                                req.body().tif(), now, os);
             }
             break;
         default:
@@ -616,7 +668,10 @@ void RestServ::exec_request(const HttpRequest& req, Time now, HttpStream& os)
         if (req.method() == HttpMethod::Get) {
             // GET /api/sess/exec
             match_method_ = true;
-            app_.get_exec(get_trader(req), parse_query(req.query()), now, os);
+            const Symbol accnt{get_trader(req)};
+            if (!defer_execs(accnt)) {
+                app_.get_exec(accnt, parse_query(req.query()), now, os);
+            }
         }
         return;
     }
@@ -17,6 +17,8 @@
 #ifndef SWIRLYD_RESTSERV_HPP
 #define SWIRLYD_RESTSERV_HPP
 
+#include <swirly/lob/App.hpp>
+
 #include <swirly/util/BasicTypes.hpp>
 #include <swirly/util/Symbol.hpp>
 #include <swirly/util/Tokeniser.hpp>
@@ -26,6 +28,9 @@
 #include <vector>
 
 namespace swirly {
+inline namespace util {
+class Exception;
+} // namespace util
 inline namespace web {
 class HttpRequest;
 class HttpStream;
@@ -48,11 +53,27 @@ class RestServ {
     RestServ(RestServ&&) = delete;
     RestServ& operator=(RestServ&&) = delete;
 
-    void handle_request(const HttpRequest& req, HttpStream& os) noexcept;
+    /**
+     * Handle the request. If defer is set, and the request reads exec history that has yet to be
+     * loaded for its account, then nothing is written, and false is returned, so that the history
+     * can be read off the matching thread. The request should then be handled again once the
+     * history for deferred_accnt() has been loaded.
+     */
+    bool handle_request(const HttpRequest& req, HttpStream& os, bool defer = false) noexcept;
+    /**
+     * Returns the account of the last request that was deferred.
+     */
+    Symbol deferred_accnt() const noexcept { return deferred_accnt_; }
+    /**
+     * Send the exception in response to a request that cannot be handled.
+     */
+    void handle_error(const Exception& e, HttpStream& os) noexcept;
 
   private:
     bool reset(const HttpRequest& req) noexcept;
 
+    bool defer_execs(Symbol accnt);
+
     void rest_request(const HttpRequest& req, Time now, HttpStream& os);
 
     void ref_data_request(const HttpRequest& req, Time now, HttpStream& os);
@@ -70,8 +91,11 @@ class RestServ {
     RestApp& app_;
     bool match_method_{false};
     bool match_path_{false};
+    bool defer_{false};
+    Symbol deferred_accnt_;
     Tokeniser path_;
     std::vector<Id64> ids_;
+    std::vector<NewOrder> new_orders_;
     std::vector<Symbol> symbols_;
 };
 
@@ -0,0 +1,64 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "SnapAgent.hpp"
+
+#include <swirly/db/FbsSnapshot.hpp>
+
+#include <swirly/util/Log.hpp>
+
+namespace swirly {
+using namespace std;
+
+SnapAgent::SnapAgent(string path)
+: path_{std::move(path)}
+{
+}
+
+SnapAgent::~SnapAgent() = default;
+
+void SnapAgent::post(FbsSnapshot&& snap)
+{
+    auto ptr = make_unique<FbsSnapshot>(std::move(snap));
+    {
+        lock_guard<mutex> lock{mutex_};
+        pending_.swap(ptr);
+    }
+    if (ptr) {
+        SWIRLY_WARNING << "discarded snapshot that was not written in time";
+    }
+    event_.notify();
+}
+
+int SnapAgent::operator()()
+{
+    unique_ptr<FbsSnapshot> snap;
+    {
+        lock_guard<mutex> lock{mutex_};
+        snap.swap(pending_);
+    }
+    if (!snap) {
+        return 0;
+    }
+    const auto start = chrono::steady_clock::now();
+    snap->write(path_.c_str());
+    const auto elapsed = chrono::steady_clock::now() - start;
+    SWIRLY_INFO << "wrote snapshot of " << snap->size() << " bytes in "
+                << chrono::duration_cast<Micros>(elapsed).count() << "us";
+    return 1;
+}
+
+} // namespace swirly
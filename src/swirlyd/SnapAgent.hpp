@@ -0,0 +1,72 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLYD_SNAPAGENT_HPP
+#define SWIRLYD_SNAPAGENT_HPP
+
+#include <swirly/app/EventCount.hpp>
+
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace swirly {
+inline namespace db {
+class FbsSnapshot;
+} // namespace db
+
+/**
+ * Agent that writes snapshots to file, so that the matching thread never waits for the file to be
+ * written or synced. Only the most recent snapshot is kept: a snapshot that is posted while another
+ * is pending replaces it.
+ */
+class SnapAgent {
+  public:
+    explicit SnapAgent(std::string path);
+    ~SnapAgent();
+
+    // Copy.
+    SnapAgent(const SnapAgent&) = delete;
+    SnapAgent& operator=(const SnapAgent&) = delete;
+
+    // Move.
+    SnapAgent(SnapAgent&&) = delete;
+    SnapAgent& operator=(SnapAgent&&) = delete;
+
+    const std::string& path() const noexcept { return path_; }
+    /**
+     * Event notified when a snapshot is posted.
+     */
+    EventCount& event() noexcept { return event_; }
+    /**
+     * Post a finished snapshot to the agent. This function is called from the reactor thread.
+     */
+    void post(FbsSnapshot&& snap);
+    /**
+     * Write the pending snapshot, if any. Returns the number of snapshots written.
+     */
+    int operator()();
+
+  private:
+    const std::string path_;
+    EventCount event_;
+    std::mutex mutex_;
+    std::unique_ptr<FbsSnapshot> pending_;
+};
+
+} // namespace swirly
+
+#endif // SWIRLYD_SNAPAGENT_HPP
@@ -0,0 +1,56 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include "SnapTimer.hpp"
+
+#include "SnapAgent.hpp"
+
+#include <swirly/lob/Snapshot.hpp>
+
+#include <swirly/db/FbsSnapshot.hpp>
+
+#include <swirly/util/Log.hpp>
+
+namespace swirly {
+using namespace std;
+
+FbsSnapshot make_snapshot(const App& app, Time now, bool clean)
+{
+    FbsSnapshot snap;
+    take_snapshot(app, snap);
+    snap.finish(now, clean);
+    return snap;
+}
+
+SnapTimer::SnapTimer(Reactor& r, const App& app, SnapAgent& agent, Duration interval, Time now)
+: app_(app)
+, agent_(agent)
+{
+    tmr_ = r.timer(now + interval, interval, Priority::Low, bind<&SnapTimer::on_timer>(this));
+}
+
+SnapTimer::~SnapTimer() = default;
+
+void SnapTimer::on_timer(Timer& tmr, Time now)
+{
+    const auto start = chrono::steady_clock::now();
+    auto snap = make_snapshot(app_, now);
+    const auto pause = chrono::steady_clock::now() - start;
+    SWIRLY_INFO << "took snapshot in " << chrono::duration_cast<Micros>(pause).count() << "us";
+    agent_.post(std::move(snap));
+}
+
+} // namespace swirly
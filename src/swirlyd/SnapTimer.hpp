@@ -0,0 +1,65 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#ifndef SWIRLYD_SNAPTIMER_HPP
+#define SWIRLYD_SNAPTIMER_HPP
+
+#include <swirly/sys/Reactor.hpp>
+
+namespace swirly {
+inline namespace db {
+class FbsSnapshot;
+} // namespace db
+inline namespace lob {
+class App;
+} // namespace lob
+
+class SnapAgent;
+
+/**
+ * Take a snapshot of the application's state. The application must not be modified while the
+ * snapshot is being taken.
+ */
+FbsSnapshot make_snapshot(const App& app, Time now, bool clean = false);
+
+/**
+ * Takes periodic snapshots from a low-priority timer. Each snapshot is taken on the reactor
+ * thread, so that it is consistent, and then posted to the SnapAgent to be written.
+ */
+class SnapTimer {
+  public:
+    SnapTimer(Reactor& r, const App& app, SnapAgent& agent, Duration interval, Time now);
+    ~SnapTimer();
+
+    // Copy.
+    SnapTimer(const SnapTimer&) = delete;
+    SnapTimer& operator=(const SnapTimer&) = delete;
+
+    // Move.
+    SnapTimer(SnapTimer&&) = delete;
+    SnapTimer& operator=(SnapTimer&&) = delete;
+
+  private:
+    void on_timer(Timer& tmr, Time now);
+
+    const App& app_;
+    SnapAgent& agent_;
+    Timer tmr_;
+};
+
+} // namespace swirly
+
+#endif // SWIRLYD_SNAPTIMER_HPP
@@ -16,6 +16,7 @@
  */
 #include <swirly/prof/HdrHistogram.hpp>
 #include <swirly/prof/HdrRecorder.hpp>
+#include <swirly/prof/PerfCounter.hpp>
 
 #include <swirly/db/SqliteJourn.hpp>
 #include <swirly/db/SqliteModel.hpp>
@@ -26,6 +27,7 @@
 #include <swirly/lob/Test.hpp>
 
 #include <swirly/fin/Date.hpp>
+#include <swirly/fin/JournAgent.hpp>
 #include <swirly/fin/MsgQueue.hpp>
 
 #include <swirly/app/MemCtx.hpp>
@@ -79,6 +81,235 @@ class Archiver {
     vector<Id64> ids_;
 };
 
+struct Sesss {
+    const Sess& eddayl;
+    const Sess& gosayl;
+    const Sess& marayl;
+    const Sess& pipayl;
+};
+
+struct Profile {
+    HdrHistogram maker{1, 1'000'000, 5};
+    HdrHistogram taker{1, 1'000'000, 5};
+    PerfCounter taker_misses{PerfEvent::CacheMisses};
+};
+
+/**
+ * Place resting orders behind the touch that are never matched by the benchmark scenario.
+ */
+void fill_book(App& app, const Market& market, const Sess& sess, int depth, Time now)
+{
+    Response resp;
+    for (int i{1}; i <= depth; ++i) {
+        resp.clear();
+        app.create_order(sess, market, ""sv, Side::Sell, 1_lts, 12348_tks + Ticks{i}, 1_lts, now,
+                         resp);
+        resp.clear();
+        app.create_order(sess, market, ""sv, Side::Buy, 1_lts, 12342_tks - Ticks{i}, 1_lts, now,
+                         resp);
+    }
+}
+
+void run_bench(App& app, const Market& market, const Sesss& s, Time now, Profile& prof)
+{
+    auto& maker = prof.maker;
+    auto& taker = prof.taker;
+
+    Archiver arch{app};
+    Response resp;
+    for (int i = 0; i < 1'001'000; ++i) {
+
+        // Reset profiles after warmup period.
+        if (i == 1000) {
+            maker.reset();
+            taker.reset();
+            prof.taker_misses.reset();
+        }
+
+        // Maker sell-side.
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.gosayl, market, ""sv, Side::Sell, 10_lts, 12348_tks, 1_lts, now,
+                             resp);
+        }
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.marayl, market, ""sv, Side::Sell, 10_lts, 12348_tks, 1_lts, now,
+                             resp);
+        }
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.gosayl, market, ""sv, Side::Sell, 10_lts, 12347_tks, 1_lts, now,
+                             resp);
+        }
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.marayl, market, ""sv, Side::Sell, 5_lts, 12347_tks, 1_lts, now,
+                             resp);
+        }
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.gosayl, market, ""sv, Side::Sell, 5_lts, 12346_tks, 1_lts, now,
+                             resp);
+        }
+
+        // Maker buy-side.
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.marayl, market, ""sv, Side::Buy, 5_lts, 12344_tks, 1_lts, now,
+                             resp);
+        }
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.gosayl, market, ""sv, Side::Buy, 5_lts, 12343_tks, 1_lts, now,
+                             resp);
+        }
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.marayl, market, ""sv, Side::Buy, 10_lts, 12343_tks, 1_lts, now,
+                             resp);
+        }
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.gosayl, market, ""sv, Side::Buy, 10_lts, 12342_tks, 1_lts, now,
+                             resp);
+        }
+        {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order(s.marayl, market, ""sv, Side::Buy, 10_lts, 12342_tks, 1_lts, now,
+                             resp);
+        }
+
+        // Taker sell-side.
+        {
+            PerfRecorder pr{prof.taker_misses};
+            HdrRecorder tr{taker};
+            resp.clear();
+            app.create_order(s.eddayl, market, ""sv, Side::Sell, 40_lts, 12342_tks, 1_lts, now,
+                             resp);
+        }
+
+        // Taker buy-side.
+        {
+            PerfRecorder pr{prof.taker_misses};
+            HdrRecorder tr{taker};
+            resp.clear();
+            app.create_order(s.pipayl, market, ""sv, Side::Buy, 40_lts, 12348_tks, 1_lts, now,
+                             resp);
+        }
+
+        arch(s.eddayl, market.id(), now);
+        arch(s.gosayl, market.id(), now);
+        arch(s.marayl, market.id(), now);
+        arch(s.pipayl, market.id(), now);
+    }
+}
+
+/**
+ * Queue many small makers at a single price, and then sweep the whole queue with one taker. This
+ * scenario stresses the matching loop over a deep level.
+ */
+void run_sweep(App& app, const Market& market, const Sesss& s, Time now, Profile& prof)
+{
+    constexpr int Makers{64};
+
+    auto& maker = prof.maker;
+    auto& taker = prof.taker;
+
+    Archiver arch{app};
+    Response resp;
+    for (int i = 0; i < 10'100; ++i) {
+
+        // Reset profiles after warmup period.
+        if (i == 100) {
+            maker.reset();
+            taker.reset();
+            prof.taker_misses.reset();
+        }
+
+        for (int j{0}; j < Makers; ++j) {
+            HdrRecorder tr{maker};
+            resp.clear();
+            app.create_order((j % 2) == 0 ? s.gosayl : s.marayl, market, ""sv, Side::Sell, 1_lts,
+                             12348_tks, 1_lts, now, resp);
+        }
+        {
+            PerfRecorder pr{prof.taker_misses};
+            HdrRecorder tr{taker};
+            resp.clear();
+            app.create_order(s.pipayl, market, ""sv, Side::Buy, Lots{Makers}, 12348_tks, 1_lts,
+                             now, resp);
+        }
+
+        arch(s.gosayl, market.id(), now);
+        arch(s.marayl, market.id(), now);
+        arch(s.pipayl, market.id(), now);
+    }
+}
+
+/**
+ * Rest a large number of orders for a single session, and then pull them all at once, alternately
+ * by session and by market. This scenario measures the latency of a kill-switch.
+ */
+void run_cancel(App& app, const Market& market, const Sess& sess, Time now, HdrHistogram& by_sess,
+                HdrHistogram& by_market)
+{
+    constexpr int Orders{10'000};
+
+    Response resp;
+    for (int i = 0; i < 220; ++i) {
+
+        // Reset profiles after warmup period.
+        if (i == 20) {
+            by_sess.reset();
+            by_market.reset();
+        }
+
+        for (int j{0}; j < Orders / 2; ++j) {
+            resp.clear();
+            app.create_order(sess, market, ""sv, Side::Sell, 1_lts, 12348_tks + Ticks{j % 100},
+                             1_lts, now, resp);
+            resp.clear();
+            app.create_order(sess, market, ""sv, Side::Buy, 1_lts, 12342_tks - Ticks{j % 100},
+                             1_lts, now, resp);
+        }
+        if (i % 2 == 0) {
+            HdrRecorder tr{by_sess};
+            app.cancel_order(sess, now);
+        } else {
+            HdrRecorder tr{by_market};
+            app.cancel_order(market, now);
+        }
+    }
+}
+
+void print_report(const char* name, Profile& prof)
+{
+    fprintf(stderr, "%s Maker Percentile Report\n", name);
+    fprintf(stderr, "-----------------------\n");
+    prof.maker.print(stderr, 5, 1000);
+
+    fprintf(stderr, "%s Taker Percentile Report\n", name);
+    fprintf(stderr, "-----------------------\n");
+    prof.taker.print(stderr, 5, 1000);
+
+    if (prof.taker_misses.valid()) {
+        fprintf(stderr, "%s Taker Cache Misses: %.1f per order\n", name, prof.taker_misses.mean());
+    } else {
+        fprintf(stderr, "%s Taker Cache Misses: unavailable\n", name);
+    }
+}
+
 class NullJourn : public Journ {
   public:
     NullJourn() noexcept = default;
@@ -89,6 +320,7 @@ class NullJourn : public Journ {
     void do_commit() override {}
     void do_rollback() noexcept override {}
     void do_write(const Msg& msg) override {}
+    void do_read_max_id(const function<void(Id64, Id64)>& cb) const override {}
 };
 
 MemCtx mem_ctx;
@@ -134,137 +366,71 @@ int main(int argc, char* argv[])
         const BusinessDay bus_day{MarketZone};
         const auto start_time = UnixClock::now();
 
-        MsgQueue mq{1 << 10};
+        // Large enough to hold a cancel-all of the deepest book.
+        MsgQueue mq{1 << 16};
         App app{mq, 1 << 4};
         app.load(*model, start_time);
         model = nullptr;
 
         NullJourn journ;
-        auto journ_agent = [&mq, &journ]() {
-            int n{0};
-            Msg msg;
-            while (mq.pop(msg)) {
-                journ.write(msg);
-                ++n;
-            }
-            return n;
-        };
+        JournAgent journ_agent{mq, journ, 1 << 10, 1ms};
         AgentThread journ_thread{journ_agent, ThreadConfig{"journ"s}};
 
-        auto& market = create_market(app, "EURUSD"sv, bus_day(start_time), 0, start_time);
-
-        auto& eddayl = app.sess("EDDAYL"sv);
-        auto& gosayl = app.sess("GOSAYL"sv);
-        auto& marayl = app.sess("MARAYL"sv);
-        auto& pipayl = app.sess("PIPAYL"sv);
-
-        HdrHistogram maker{1, 1'000'000, 5};
-        HdrHistogram taker{1, 1'000'000, 5};
-
-        Archiver arch{app};
-        Response resp;
-        for (int i = 0; i < 1'001'000; ++i) {
+        const Sesss sesss{app.sess("EDDAYL"sv), app.sess("GOSAYL"sv), app.sess("MARAYL"sv),
+                          app.sess("PIPAYL"sv)};
+        const Sess& depth = app.sess("TOBAYL"sv);
+
+        // Shallow and deep books, each with tree-only and windowed price levels.
+        struct {
+            const char* name;
+            int depth;
+            size_t window;
+        } const runs[] = {{"Shallow/Tree", 0, 0},
+                          {"Shallow/Window", 0, 256},
+                          {"Deep/Tree", 200, 0},
+                          {"Deep/Window", 200, 256}};
+
+        auto settl_day = bus_day(start_time);
+        for (const auto& run : runs) {
+            auto& market = create_market(app, "EURUSD"sv, settl_day, 0, start_time);
+            settl_day += 1_jd;
+            app.set_level_window(market, run.window);
+            fill_book(app, market, depth, run.depth, start_time);
+
+            Profile prof;
+            run_bench(app, market, sesss, start_time, prof);
+            print_report(run.name, prof);
+        }
 
-            // Reset profiles after warmup period.
-            if (i == 1000) {
-                maker.reset();
-                taker.reset();
-            }
+        // Sweep a deep queue at a single price.
+        {
+            auto& market = create_market(app, "EURUSD"sv, settl_day, 0, start_time);
+            settl_day += 1_jd;
+            fill_book(app, market, depth, 200, start_time);
 
-            // Maker sell-side.
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(gosayl, market, ""sv, Side::Sell, 10_lts, 12348_tks, 1_lts,
-                                 start_time, resp);
-            }
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(marayl, market, ""sv, Side::Sell, 10_lts, 12348_tks, 1_lts,
-                                 start_time, resp);
-            }
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(gosayl, market, ""sv, Side::Sell, 10_lts, 12347_tks, 1_lts,
-                                 start_time, resp);
-            }
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(marayl, market, ""sv, Side::Sell, 5_lts, 12347_tks, 1_lts,
-                                 start_time, resp);
-            }
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(gosayl, market, ""sv, Side::Sell, 5_lts, 12346_tks, 1_lts,
-                                 start_time, resp);
-            }
+            Profile prof;
+            run_sweep(app, market, sesss, start_time, prof);
+            print_report("Deep/Sweep", prof);
+        }
 
-            // Maker buy-side.
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(marayl, market, ""sv, Side::Buy, 5_lts, 12344_tks, 1_lts,
-                                 start_time, resp);
-            }
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(gosayl, market, ""sv, Side::Buy, 5_lts, 12343_tks, 1_lts,
-                                 start_time, resp);
-            }
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(marayl, market, ""sv, Side::Buy, 10_lts, 12343_tks, 1_lts,
-                                 start_time, resp);
-            }
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(gosayl, market, ""sv, Side::Buy, 10_lts, 12342_tks, 1_lts,
-                                 start_time, resp);
-            }
-            {
-                HdrRecorder tr{maker};
-                resp.clear();
-                app.create_order(marayl, market, ""sv, Side::Buy, 10_lts, 12342_tks, 1_lts,
-                                 start_time, resp);
-            }
+        // Cancel all resting orders.
+        {
+            auto& market = create_market(app, "EURUSD"sv, settl_day, 0, start_time);
+            settl_day += 1_jd;
 
-            // Taker sell-side.
-            {
-                HdrRecorder tr{taker};
-                resp.clear();
-                app.create_order(eddayl, market, ""sv, Side::Sell, 40_lts, 12342_tks, 1_lts,
-                                 start_time, resp);
-            }
+            HdrHistogram by_sess{1, 1'000'000'000, 5};
+            HdrHistogram by_market{1, 1'000'000'000, 5};
+            run_cancel(app, market, sesss.marayl, start_time, by_sess, by_market);
 
-            // Taker buy-side.
-            {
-                HdrRecorder tr{taker};
-                resp.clear();
-                app.create_order(pipayl, market, ""sv, Side::Buy, 40_lts, 12348_tks, 1_lts,
-                                 start_time, resp);
-            }
+            fprintf(stderr, "Cancel/Sess Percentile Report\n");
+            fprintf(stderr, "-----------------------\n");
+            by_sess.print(stderr, 5, 1000);
 
-            arch(eddayl, market.id(), start_time);
-            arch(gosayl, market.id(), start_time);
-            arch(marayl, market.id(), start_time);
-            arch(pipayl, market.id(), start_time);
+            fprintf(stderr, "Cancel/Market Percentile Report\n");
+            fprintf(stderr, "-----------------------\n");
+            by_market.print(stderr, 5, 1000);
         }
 
-        fprintf(stderr, "Maker Percentile Report\n");
-        fprintf(stderr, "-----------------------\n");
-        maker.print(stderr, 5, 1000);
-
-        fprintf(stderr, "Taker Percentile Report\n");
-        fprintf(stderr, "-----------------------\n");
-        taker.print(stderr, 5, 1000);
-
         fflush(stderr);
         ret = 0;
     } catch (const exception& e) {
@@ -0,0 +1,152 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include <swirly/fin/MsgHandler.hpp>
+#include <swirly/fin/MsgQueue.hpp>
+
+#include <swirly/app/Thread.hpp>
+
+#include <swirly/sys/Signal.hpp>
+
+#include <swirly/util/Log.hpp>
+#include <swirly/util/String.hpp>
+
+#include <iostream>
+
+using namespace std;
+using namespace swirly;
+
+namespace {
+
+/**
+ * Reader that prints each message posted to a file-based message queue as a tab-separated line.
+ * The reader attaches to its own cursor in the queue, so it runs alongside the engine and its
+ * journal, and resumes from where it left off when restarted.
+ */
+class MqTail : public BasicMsgHandler<MqTail> {
+  public:
+    MqTail(MsgQueue& mq, size_t reader, ostream& os)
+    : mq_(mq)
+    , reader_{reader}
+    , os_(os)
+    {
+    }
+    /**
+     * Print the messages posted since the last call. Returns the number of messages printed.
+     */
+    int operator()()
+    {
+        int n{0};
+        Msg msg;
+        bool end;
+        while (mq_.pop(msg, end, reader_)) {
+            dispatch(msg);
+            ++n;
+        }
+        if (n > 0) {
+            os_.flush();
+        }
+        return n;
+    }
+    void on_create_market(const CreateMarket& body)
+    {
+        os_ << "create_market\t" << body.id << '\t' << to_string_view(body.instr) << '\t'
+            << body.settl_day << '\t' << body.state << '\n';
+    }
+    void on_update_market(const UpdateMarket& body)
+    {
+        os_ << "update_market\t" << body.id << '\t' << body.state << '\n';
+    }
+    void on_create_exec(const CreateExec& body)
+    {
+        os_ << "create_exec\t" << to_string_view(body.accnt) << '\t' << body.market_id << '\t'
+            << to_string_view(body.instr) << '\t' << body.id << '\t' << body.order_id << '\t'
+            << to_string_view(body.ref) << '\t' << body.state << '\t' << body.side << '\t'
+            << body.lots << '\t' << body.ticks << '\t' << body.resd_lots << '\t' << body.exec_lots
+            << '\t' << body.last_lots << '\t' << body.last_ticks << '\t' << body.match_id << '\t'
+            << body.liq_ind << '\t' << to_string_view(body.cpty) << '\n';
+    }
+    void on_archive_trade(const ArchiveTrade& body)
+    {
+        for (size_t i{0}; i < MaxIds; ++i) {
+            const auto id = body.ids[i];
+            if (id == 0_id64) {
+                break;
+            }
+            os_ << "archive_trade\t" << body.market_id << '\t' << id << '\n';
+        }
+    }
+
+  private:
+    MsgQueue& mq_;
+    const size_t reader_;
+    ostream& os_;
+};
+
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    int ret = 1;
+    try {
+
+        if (argc < 2) {
+            cerr << "usage: swirly-mq-tail MQ_FILE [READER]" << endl;
+            return ret;
+        }
+        MsgQueue mq{argv[1]};
+        // Reader zero is the journal.
+        const size_t reader{argc > 2 ? stou64(argv[2]) : 1};
+        if (mq.readers() < 2) {
+            cerr << "message queue has no readers besides the journal" << endl;
+            return ret;
+        }
+        if (reader < 1 || reader >= mq.readers()) {
+            cerr << "reader must be between 1 and " << mq.readers() - 1 << endl;
+            return ret;
+        }
+        SWIRLY_NOTICE << "attached to reader " << reader << " at position " << mq.rpos(reader);
+
+        // Readers in other processes cannot wait on the engine's event, so the reader backs off.
+        MqTail mq_tail{mq, reader, cout};
+        AgentThread mq_thread{mq_tail, ThreadConfig{"mq"s, WaitStrategy::Phased}};
+
+        // Wait for termination.
+        SigWait sig_wait;
+        while (const auto sig = sig_wait()) {
+            switch (sig) {
+            case SIGHUP:
+                SWIRLY_INFO << "received SIGHUP";
+                continue;
+            case SIGINT:
+                SWIRLY_INFO << "received SIGINT";
+                break;
+            case SIGTERM:
+                SWIRLY_INFO << "received SIGTERM";
+                break;
+            default:
+                SWIRLY_INFO << "received signal: " << sig;
+                continue;
+            }
+            break;
+        }
+        ret = 0;
+
+    } catch (const std::exception& e) {
+        SWIRLY_ERROR << "exception: " << e.what();
+    }
+    return ret;
+}
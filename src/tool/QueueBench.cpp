@@ -18,68 +18,137 @@
 
 #include <swirly/app/Backoff.hpp>
 #include <swirly/app/MemQueue.hpp>
+#include <swirly/app/Thread.hpp>
 
 #include <swirly/util/Log.hpp>
 
 #include <iostream>
 #include <thread>
 
+#include <time.h>
+
 using namespace std;
 using namespace swirly;
 
-int main(int argc, char* argv[])
+namespace {
+
+using Clock = chrono::high_resolution_clock;
+
+enum { Iters = 10000000, Warmup = 1000 };
+
+template <typename PolicyT>
+void run(const char* name)
 {
-    using Clock = chrono::high_resolution_clock;
+    HdrHistogram hist{1, 1'000'000, 5};
+    MemQueue<Clock::duration, PolicyT> q{1 << 14};
 
-    int ret = 1;
-    try {
-        HdrHistogram hist{1, 1'000'000, 5};
-        MemQueue<Clock::duration> q{1 << 14};
-
-        enum { Iters = 50000000 };
-        auto t1 = thread([&q]() {
-            for (int i{}; i < Iters;) {
-                if (q.push(Clock::now().time_since_epoch())) {
-                    ++i;
-                } else {
-                    sched_yield();
-                }
+    const auto started = Clock::now();
+    auto t = thread([&q]() {
+        for (int i{}; i < Iters;) {
+            if (q.push(Clock::now().time_since_epoch())) {
+                ++i;
+            } else {
+                sched_yield();
             }
-        });
-
-        auto t2 = thread([&q]() {
-            for (int i{}; i < Iters;) {
-                if (q.push(Clock::now().time_since_epoch())) {
-                    ++i;
-                } else {
-                    sched_yield();
-                }
+        }
+    });
+
+    for (int i{}; i < Iters;) {
+        Clock::duration start;
+        if (q.pop(start)) {
+            if (++i <= Warmup) {
+                continue;
             }
-        });
-
-        for (int i{}; i < Iters * 2;) {
-
-            Clock::duration start;
-            if (q.pop(start)) {
-                if (++i <= 1000) {
-                    // Warmup.
-                    continue;
-                }
-                const auto end = Clock::now().time_since_epoch();
-                const chrono::duration<double, micro> diff{end - start};
-                const auto usec = diff.count();
-                hist.record(usec);
-            } else {
-                cpu_relax();
+            const auto end = Clock::now().time_since_epoch();
+            const chrono::duration<double, micro> diff{end - start};
+            const auto usec = diff.count();
+            hist.record(usec);
+        } else {
+            cpu_relax();
+        }
+    }
+    t.join();
+
+    const chrono::duration<double> elapsed{Clock::now() - started};
+    fprintf(stderr, "%s Percentile Report\n", name);
+    fprintf(stderr, "----------------------\n");
+    hist.print(stderr, 5, 1000);
+    fprintf(stderr, "%.0f msgs/sec\n\n", Iters / elapsed.count());
+}
+
+double thread_cpu_secs() noexcept
+{
+    timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// Messages are sparse, so that the consumer is idle between them.
+void run_wait(const char* name, WaitStrategy wait)
+{
+    using namespace std::literals::chrono_literals;
+    enum { Msgs = 20000 };
+
+    HdrHistogram hist{1, 1'000'000, 5};
+    MemQueue<Clock::duration, SpscPolicy> q{1 << 14};
+    EventCount event;
+
+    int n{0};
+    double cpu_start{-1}, cpu_end{0};
+    atomic<bool> done{false};
+    auto agent = [&]() {
+        if (cpu_start < 0) {
+            cpu_start = thread_cpu_secs();
+        }
+        int i{0};
+        Clock::duration start;
+        while (q.pop(start)) {
+            const auto end = Clock::now().time_since_epoch();
+            const chrono::duration<double, micro> diff{end - start};
+            hist.record(diff.count());
+            ++i;
+        }
+        if (i > 0 && (n += i) == Msgs) {
+            cpu_end = thread_cpu_secs();
+            done.store(true, memory_order_release);
+        }
+        return i;
+    };
+    const auto started = Clock::now();
+    {
+        AgentThread t{agent, ThreadConfig{name, wait, &event}};
+        for (int i{}; i < Msgs; ++i) {
+            this_thread::sleep_for(50us);
+            while (!q.push(Clock::now().time_since_epoch())) {
+                sched_yield();
             }
+            event.notify();
         }
+        while (!done.load(memory_order_acquire)) {
+            this_thread::sleep_for(1ms);
+        }
+    }
+    const chrono::duration<double> elapsed{Clock::now() - started};
+    fprintf(stderr, "%s Percentile Report\n", name);
+    fprintf(stderr, "----------------------\n");
+    hist.print(stderr, 5, 1000);
+    fprintf(stderr, "consumer cpu: %.1f%%\n\n", 100 * (cpu_end - cpu_start) / elapsed.count());
+}
+
+} // namespace
 
-        t1.join();
-        t2.join();
+int main(int argc, char* argv[])
+{
+    int ret = 1;
+    try {
+        // One producer and one consumer, as on the engine-to-journal path.
+        run<MpmcPolicy>("Mpmc");
+        run<SpscPolicy>("Spsc");
 
-        fprintf(stderr, "Percentile Report\n");
-        fprintf(stderr, "-----------------\n");
-        hist.print(stderr, 5, 1000);
+        // Idle latency against consumer CPU for each wait strategy.
+        run_wait("Spin", WaitStrategy::Spin);
+        run_wait("Phased", WaitStrategy::Phased);
+        run_wait("Park", WaitStrategy::Park);
 
         fflush(stderr);
         ret = 0;
@@ -0,0 +1,204 @@
+/*
+ * The Restful Matching-Engine.
+ * Copyright (C) 2013, 2018 Swirly Cloud Limited.
+ *
+ * This program is free software; you can redistribute it and/or modify it under the terms of the
+ * GNU General Public License as published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without
+ * even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with this program; if
+ * not, write to the Free Software Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA
+ * 02110-1301, USA.
+ */
+#include <swirly/db/BinJourn.hpp>
+#include <swirly/db/BinModel.hpp>
+#include <swirly/db/FbsModel.hpp>
+#include <swirly/db/FbsSnapshot.hpp>
+#include <swirly/db/ReplayModel.hpp>
+
+#include <swirly/lob/App.hpp>
+#include <swirly/lob/Response.hpp>
+#include <swirly/lob/Sess.hpp>
+#include <swirly/lob/Snapshot.hpp>
+#include <swirly/lob/Test.hpp>
+
+#include <swirly/fin/Date.hpp>
+#include <swirly/fin/JournAgent.hpp>
+#include <swirly/fin/MsgQueue.hpp>
+
+#include <swirly/app/MemCtx.hpp>
+
+#include <swirly/sys/Error.hpp>
+
+#include <swirly/util/Log.hpp>
+#include <swirly/util/Time.hpp>
+
+#include <experimental/filesystem>
+
+namespace fs = std::experimental::filesystem;
+
+using namespace std;
+using namespace swirly;
+
+namespace {
+
+using Clock = chrono::steady_clock;
+
+/**
+ * Generate order flow that leaves the book unchanged: each round crosses a maker with a taker,
+ * and then archives the resulting trades. Each round journals four execs.
+ */
+void run_rounds(App& app, const Market& market, const Sess& maker, const Sess& taker, int rounds,
+                Time now, JournAgent& journ_agent)
+{
+    Response resp;
+    vector<Id64> ids;
+    for (int i{0}; i < rounds; ++i) {
+        resp.clear();
+        app.create_order(maker, market, ""sv, Side::Sell, 10_lts, 12345_tks, 1_lts, now, resp);
+        resp.clear();
+        app.create_order(taker, market, ""sv, Side::Buy, 10_lts, 12345_tks, 1_lts, now, resp);
+        for (const auto* sess : {&maker, &taker}) {
+            ids.clear();
+            for (const auto& trade : sess->trades()) {
+                ids.push_back(trade.id());
+            }
+            app.archive_trade(*sess, market.id(), ids, now);
+        }
+        // Drain the queue into the journal before it fills.
+        if (i % 256 == 255) {
+            while (journ_agent() > 0) {
+            }
+        }
+    }
+    while (journ_agent() > 0) {
+    }
+}
+
+void load_app(const Model& model, Time now)
+{
+    MsgQueue mq{1 << 10};
+    App app{mq, 1 << 4};
+    app.load(model, now);
+}
+
+template <typename FnT>
+double time_ms(FnT fn)
+{
+    const auto start = Clock::now();
+    fn();
+    return chrono::duration<double, milli>(Clock::now() - start).count();
+}
+
+void write_snapshot(const App& app, Time now, const string& path)
+{
+    FbsSnapshot snap;
+    take_snapshot(app, snap);
+    snap.finish(now);
+    snap.write(path.c_str());
+}
+
+MemCtx mem_ctx;
+
+} // namespace
+
+namespace swirly {
+
+void* alloc(size_t size)
+{
+    return mem_ctx.alloc(size);
+}
+
+void* alloc(size_t size, align_val_t al)
+{
+    return mem_ctx.alloc(size, al);
+}
+
+void dealloc(void* ptr, size_t size) noexcept
+{
+    return mem_ctx.dealloc(ptr, size);
+}
+
+} // namespace swirly
+
+int main(int argc, char* argv[])
+{
+    int ret = 1;
+    try {
+
+        // Number of steps, rounds of order flow per step, and journal segment size. Replay starts
+        // at a segment boundary, so the segment size bounds the number of messages that are
+        // scanned, but skipped, during replay.
+        const int steps{argc > 1 ? stoi(argv[1]) : 8};
+        const int rounds{argc > 2 ? stoi(argv[2]) : 25'000};
+        const size_t seg_size{argc > 3 ? stoul(argv[3]) : 4 << 20};
+
+        mem_ctx = MemCtx{1 << 24};
+        // Silence the per-load replay statistics.
+        set_log_level(Log::Notice);
+
+        char tmpl[] = "/tmp/swirly-recovery.XXXXXX";
+        if (!mkdtemp(tmpl)) {
+            throw system_error{os::make_error(errno), "mkdtemp"};
+        }
+        const fs::path dir{tmpl};
+        const auto journ_dir = (dir / "journ").string();
+        const auto first_path = (dir / "first.dat").string();
+        const auto last_path = (dir / "last.dat").string();
+        fs::create_directory(journ_dir);
+
+        const BusinessDay bus_day{MarketZone};
+        const auto now = UnixClock::now();
+        const TestModel ref_model;
+
+        MsgQueue mq{1 << 14};
+        App app{mq, 1 << 4};
+        app.load(ref_model, now);
+
+        BinJourn journ{journ_dir.c_str(), seg_size};
+        JournAgent journ_agent{mq, journ, 1 << 10, 1ms};
+
+        const auto& market = app.create_market(app.instr("EURUSD"sv), bus_day(now) + 2_jd, 0, now);
+        const auto& maker = app.sess("GOSAYL"sv);
+        const auto& taker = app.sess("MARAYL"sv);
+
+        // A snapshot of the empty market, and a snapshot of the previous step.
+        write_snapshot(app, now, first_path);
+        write_snapshot(app, now, last_path);
+
+        printf("%10s %12s %12s %12s %12s %12s\n", "execs", "full_ms", "tail_execs", "tail_ms",
+               "first_execs", "first_ms");
+        for (int step{1}; step <= steps; ++step) {
+            run_rounds(app, market, maker, taker, rounds, now, journ_agent);
+            const auto execs = market.max_id().count();
+
+            const auto full_ms = time_ms([&]() {
+                const BinModel model{journ_dir.c_str(), ref_model, 1 << 4};
+                load_app(model, now);
+            });
+            const auto tail_ms = time_ms([&]() {
+                const FbsModel snap_model{last_path.c_str()};
+                const ReplayModel model{journ_dir.c_str(), ref_model, snap_model};
+                load_app(model, now);
+            });
+            const auto first_ms = time_ms([&]() {
+                const FbsModel snap_model{first_path.c_str()};
+                const ReplayModel model{journ_dir.c_str(), ref_model, snap_model};
+                load_app(model, now);
+            });
+            printf("%10ld %12.1f %12d %12.1f %12ld %12.1f\n", execs, full_ms, rounds * 4, tail_ms,
+                   execs, first_ms);
+            write_snapshot(app, now, last_path);
+        }
+        fs::remove_all(dir);
+        ret = 0;
+
+    } catch (const exception& e) {
+        SWIRLY_ERROR << "exception: " << e.what();
+    }
+    return ret;
+}